@@ -2,6 +2,22 @@
 namespace lighting
 {
 	class LightLayer;
+
+	/// <summary>
+	/// The global endpoints of an <see cref="AboveLightBlocker"/> copied when a frame is detached.
+	/// </summary>
+	struct AboveBlockerLine
+	{
+		/// <summary>
+		/// The horizontal position of the first endpoint.
+		/// </summary>
+		float x1;
+
+		/// <summary>
+		/// The horizontal position of the second endpoint.
+		/// </summary>
+		float x2;
+	};
 	
 	/// <summary>
 	/// Only used by <see cref="AboveLightSource"/>s to block out light from above.
@@ -1,10 +1,57 @@
 #pragma once
 #include "LightSource.h"
-#include "AboveShadePoint.h"
-#include <unordered_set>
+#include "CastSegmentSet.h"
+#include <vector>
 
 namespace lighting
 {	
+	/// <summary>
+	/// A vertical strip of an <see cref="AboveLightSource"/>, a range of its sorted <see cref="AboveLightSource::shadePoints"/> that is swept on its own.
+	/// </summary>
+	struct AboveSweepChunk
+	{
+		/// <summary>
+		/// The index of the first point of the strip.
+		/// </summary>
+		size_t beginI;
+
+		/// <summary>
+		/// One past the index of the last point of the strip.
+		/// </summary>
+		size_t endI;
+
+		/// <summary>
+		/// The x the strip starts at.  Half way between the last point of the previous strip and the first point of this one, so no point lies on it.
+		/// </summary>
+		float beginX;
+
+		/// <summary>
+		/// The x the strip ends at, the <see cref="beginX"/> of the next strip.
+		/// </summary>
+		float endX;
+
+		/// <summary>
+		/// Keeps track of the points that can be shadow casted to.  Seeded with every line crossing <see cref="beginX"/>.
+		/// </summary>
+		CastSegmentSet castPoints;
+
+		/// <summary>
+		/// The drawing coordinates of the strip, appended to <see cref="AboveLightSource::drawPoints"/> by <see cref="AboveLightSource::stitchSweepChunks()"/>.
+		/// </summary>
+		std::vector <float> drawPoints;
+	};
+
+	/// <summary>
+	/// The results of an <see cref="AboveLightSource"/> for one frame.  There is one for each frame that may be processed or drawn at once.
+	/// </summary>
+	struct AboveFrameSlot
+	{
+		/// <summary>
+		/// The coordinates of the points to draw.  Even is x, odd is y.
+		/// </summary>
+		std::vector <float> drawPoints;
+	};
+
 	/// <summary>
 	/// Represents the sun or any planetary source of light.  Can be blocked by <see cref="AboveLightBlocker"/>s or <see cref="LightBlocker"/>s.
 	/// </summary>
@@ -26,12 +73,12 @@ namespace lighting
 		/// <summary>
 		/// The amount of bits in the radix base
 		/// </summary>
-		static const uint8_t RADIX_BASE_BITS = 4;
+		static const uint8_t RADIX_BASE_BITS = 8;
 		
 		/// <summary>
 		/// The max value of the radix base
 		/// </summary>
-		static const unsigned int RADIX_BASE_NUM = 16;
+		static const unsigned int RADIX_BASE_NUM = 256;
 		
 		/// <summary>
 		/// The maximum radix value in bits.
@@ -75,7 +122,7 @@ namespace lighting
 
 	protected:		
 		/// <summary>
-		/// Amount of bound <see cref="AboveShadePoint"/>s.
+		/// Amount of bound points.
 		/// </summary>
 		static const int BOUND_POINTS_SIZE = 2;
 		
@@ -85,31 +132,53 @@ namespace lighting
 		static const int LINE_CHECK_OFF = 2000;
 				
 		/// <summary>
-		/// Countings the sort shade points.
-		/// </summary>
-		/// <param name="bI">The bits to shift by.</param>
-		void countingSortShadePoints(int bI);
-		
-		/// <summary>
-		/// Radixes the sort shade points based on their x-values.
+		/// Checks if <paramref name="checkPoint"/> is in front of the line created by <see cref="alphaPoint"/>.
 		/// </summary>
-		void radixSortShadePoints();
+		/// <param name="alphaPoint">The index of one of the endpoints of the alpha line.</param>
+		/// <param name="checkPoint">The index of the point to check if in front of alpha line.</param>
+		/// <returns>If <paramref name="checkPoint"/> is in front of the line made by <see cref="alphaPoint"/>.</returns>
+		bool checkPointFront(uint32_t alphaPoint, uint32_t checkPoint) const;
 
 		/// <summary>
-		/// Checks if <paramref name="checkPoint"/> is in front of the line created by <see cref="alphaPoint"/>.
+		/// Finds the sort key of a point from its x, so points are sorted from <paramref name="minX"/> to <paramref name="maxX"/>.
 		/// </summary>
-		/// <param name="alphaPoint">One of the endpoints of the alpha line.</param>
-		/// <param name="checkPoint">The point to check if in front of alpha line.</param>
-		/// <returns>If <paramref name="checkPoint"/> is in front of the line made by <see cref="alphaPoint"/>.</returns>
-		static bool CheckPointFront(AboveShadePoint* alphaPoint, AboveShadePoint* checkPoint);
+		/// <param name="x">The horizontal position of the point.</param>
+		/// <param name="minX">The minimum value for <paramref name="x"/>.</param>
+		/// <param name="maxX">The maximum value for <paramref name="x"/>.</param>
+		/// <returns>The <see cref="ShadePointBuffer::radixVal"/> of the point.</returns>
+		static unsigned int GetRadixVal(float x, int minX, int maxX);
 		
 		/// <summary>
 		/// Transfers the held vars.  No implementation.
 		/// </summary>
-		virtual void transferHeldVars() override
+		/// <param name="slot">The frame slot that will be processed next.</param>
+		virtual void transferHeldVars(size_t) override
 		{
 
 		}
+
+		/// <summary>
+		/// Resizes <see cref="frameSlots"/>.
+		/// </summary>
+		/// <param name="slots">The number of frame slots.</param>
+		virtual void setPipelineSlots(size_t slots) override
+		{
+			LightSource::setPipelineSlots(slots);
+			frameSlots.clear();
+			frameSlots.resize(slots);
+		}
+
+		/// <summary>
+		/// Copies the <see cref="AboveFrameSlot::drawPoints"/> of the frame slot at <paramref name="previousSlot"/> to the frame slot at <see cref="computeSlot"/>.
+		/// </summary>
+		/// <param name="previousSlot">The frame slot of the last frame <c>this</c> has shadows for.</param>
+		virtual void reuseResults(size_t previousSlot) override
+		{
+			if (previousSlot != computeSlot)
+			{
+				frameSlots.at(computeSlot).drawPoints = frameSlots.at(previousSlot).drawPoints;
+			}
+		}
 		
 		/// <summary>
 		/// Populates <see cref="shadePoints"/> by using <see cref="owner"/>'s aboveLightBlockers and lightBlockers.
@@ -120,6 +189,31 @@ namespace lighting
 		/// Processes the <see cref="shadePoints"/> and converts them to <see cref="drawPoints"/>.
 		/// </summary>
 		virtual void mapShadePoints() override;
+
+		/// <summary>
+		/// Splits <see cref="shadePoints"/> into vertical strips stored in <see cref="sweepChunks"/>.  Strips only start between two different x values.
+		/// </summary>
+		/// <param name="maxChunks">The maximum number of strips to create.</param>
+		/// <returns>The number of strips created.</returns>
+		virtual size_t createSweepChunks(size_t maxChunks) override;
+
+		/// <summary>
+		/// Sweeps the strip at <paramref name="chunkI"/> of <see cref="sweepChunks"/>.  The first strip is started like <see cref="mapShadePoints()"/>,
+		/// the others are seeded by a <see cref="shadowCast"/> at their <see cref="AboveSweepChunk::beginX"/>.
+		/// </summary>
+		/// <param name="chunkI">The index of the strip.</param>
+		virtual void mapSweepChunk(size_t chunkI) override;
+
+		/// <summary>
+		/// Appends the <see cref="AboveSweepChunk::drawPoints"/> of every strip to <see cref="drawPoints"/>.
+		/// </summary>
+		virtual void stitchSweepChunks() override;
+
+		/// <summary>
+		/// Adds every line that starts at or crosses the <see cref="AboveSweepChunk::beginX"/> of <paramref name="chunk"/> to its <see cref="AboveSweepChunk::castPoints"/>.
+		/// </summary>
+		/// <param name="chunk">The strip to seed.</param>
+		void seedCastPoints(AboveSweepChunk& chunk);
 		
 		/// <summary>
 		/// No body, there is no local drawing needed.
@@ -135,48 +229,52 @@ namespace lighting
 		virtual void drawToLightMap() override;
 		
 		/// <summary>
-		/// Populates <see cref="shadePoints"/> with the boundary <see cref="AboveShadePoint"/>s.
+		/// Populates <see cref="shadePoints"/> with the boundary points.
 		/// </summary>
 		virtual void createBoundShadePoints();
 		
 		/// <summary>
-		/// Clears and deletes elements in all point containers.
+		/// Empties <see cref="shadePoints"/>, keeping its memory, and adds the bound points back.
 		/// </summary>
 		virtual void resetPoints();
 		
 		/// <summary>
 		/// Updates the cast points.
 		/// </summary>
-		/// <param name="updatePoint">The <see cref="AboveShadePoint"/> to check if needing adding or removing from <see cref="castPoints"/>.</param>
-		virtual void updateCastPoints(AboveShadePoint* updatePoint);
+		/// <param name="chunk">The strip being swept.</param>
+		/// <param name="updatePoint">The index of the point to check if needing adding or removing from <see cref="AboveSweepChunk::castPoints"/>.</param>
+		virtual void updateCastPoints(AboveSweepChunk& chunk, uint32_t updatePoint);
 		
 		/// <summary>
-		/// Will iterate through all of the <see cref="ShadePoint"/>s with the same x as the element in <see cref="shadePoints"/> at index <paramref name="i"/> and set the <paramref name="alphaPoint"/>, <paramref name="alphaContactX"/>, and <paramref name="alphaContactY"/> to the point that has the minimum distance 
+		/// Will iterate through all of the points with the same x as the element in <see cref="shadePoints"/> at index <paramref name="i"/> and set the <paramref name="alphaPoint"/>, <paramref name="alphaContactX"/>, and <paramref name="alphaContactY"/> to the point that has the minimum distance 
 		/// from the origin, and the highest angle between it and its connecting point.  If a valid point is not found, return false and leave alphaPoint, prevX, prevY as they were.
 		/// </summary>
-		/// <param name="alphaPoint"><see cref="ShadePoint"/> represneting of the end points of the alphaLine.</param>
+		/// <param name="chunk">The strip being swept.</param>
+		/// <param name="alphaPoint">The index of one of the end points of the alphaLine.</param>
 		/// <param name="i">The index of <see cref="shadePoints"/> with the x-value to check.</param>
 		/// <param name="alphaContactX">The last place an alphaContact occured.</param>
 		/// <param name="alphaContactY">The last place an alphaContact occureed.</param>
 		/// <returns></returns>
-		virtual bool getAlphaLineAtX(AboveShadePoint*& alphaPoint, int& i, float& alphaContactX, float& alphaContactY);
+		virtual bool getAlphaLineAtX(AboveSweepChunk& chunk, uint32_t& alphaPoint, int& i, float& alphaContactX, float& alphaContactY);
 				
 		/// <summary>
 		/// Handles the first shade points.
 		/// </summary>
+		/// <param name="chunk">The first strip.</param>
 		/// <param name="alphaPoint">The alpha point.</param>
 		/// <param name="firstX">The first x.</param>
 		/// <param name="firstY">The first y.</param>
 		/// <param name="i">The i.</param>
-		virtual void handleFirstShadePoints(AboveShadePoint*& alphaPoint, float& firstX, float& firstY, int& i);
+		virtual void handleFirstShadePoints(AboveSweepChunk& chunk, uint32_t& alphaPoint, float& firstX, float& firstY, int& i);
 		
 		/// <summary>
 		/// Handles the last shade points. Currently no body.
 		/// </summary>
+		/// <param name="chunk">The last strip.</param>
 		/// <param name="alphaPoint">The alpha point.</param>
 		/// <param name="alphaContactX">The alpha contact x.</param>
 		/// <param name="alphaContactY">The alpha contact y.</param>
-		virtual void handleLastShadePoints(AboveShadePoint* alphaPoint, float alphaContactX, float alphaContactY);
+		virtual void handleLastShadePoints(AboveSweepChunk& chunk, uint32_t alphaPoint, float alphaContactX, float alphaContactY);
 		
 		/// <summary>
 		/// Value added to the y-component of <see cref="drawPoints"/>.
@@ -199,37 +297,39 @@ namespace lighting
 		int getMaxX();
 		
 		/// <summary>
-		/// Converts parameter coordinates to screen coordinates and pushes them to <see cref="drawPoints"/>.
+		/// Converts parameter coordinates to screen coordinates and pushes them to the <see cref="AboveSweepChunk::drawPoints"/> of <paramref name="chunk"/>.
 		/// </summary>
+		/// <param name="chunk">The strip being swept.</param>
 		/// <param name="x1">The horizotnal position of the first endpoint.</param>
 		/// <param name="y1">The vertical position of the first endpoint.</param>
 		/// <param name="x2">The horizontal position of the second endpoint.</param>
 		/// <param name="y2">The vertical position of the second endpoint.</param>
-		void addDrawPoints(float x1, float y1, float x2, float y2);
+		void addDrawPoints(AboveSweepChunk& chunk, float x1, float y1, float x2, float y2);
 
 		/// <summary>
 		/// Returns the line closest to the top of the screen at the given <paramref name="x"/>
 		/// </summary>
+		/// <param name="chunk">The strip whose <see cref="AboveSweepChunk::castPoints"/> are checked.</param>
 		/// <param name="x">The x.</param>
 		/// <param name="cY">The contactY, output parameter.</param>
 		/// <param name="exceptionPoint">The exception point, will not be returned.</param>
 		/// <returns></returns>
-		AboveShadePoint* shadowCast(float x, float& cY, AboveShadePoint* exceptionPoint = nullptr);
+		uint32_t shadowCast(AboveSweepChunk& chunk, float x, float& cY, uint32_t exceptionPoint = ShadePointBuffer::NO_POINT);
 
 		/// <summary>
-		/// The coordinates of the points to draw.  Even is x, odd is y.
+		/// The drawing coordinates for each frame slot.  The slot at <see cref="computeSlot"/> is written by <see cref="stitchSweepChunks()"/> while the slot at <see cref="drawSlot"/> is drawn.
 		/// </summary>
-		std::vector <float> drawPoints;
+		std::vector <AboveFrameSlot> frameSlots;
 		
 		/// <summary>
-		/// Keeps track of the <see cref="AboveShadePoint"/>s that can be shadow casted to.
+		/// The strips <see cref="shadePoints"/> are split into by <see cref="createSweepChunks(size_t)"/>.
 		/// </summary>
-		std::unordered_set <AboveShadePoint*> castPoints;
+		std::vector <AboveSweepChunk> sweepChunks;
 		
 		/// <summary>
-		/// The <see cref="ShadePoint"/>s created by <see cref="::createShadePoints"/>.
+		/// The points created by <see cref="::createShadePoints"/>.  Reused every frame, in sweep order once sorted.
 		/// </summary>
-		std::vector <AboveShadePoint*> shadePoints;
+		ShadePointBuffer shadePoints;
 		
 		/// <summary>
 		/// The color of the light.
@@ -0,0 +1,153 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "LightBlocker.h"
+
+namespace lighting
+{
+	/// <summary>
+	/// A uniform grid over the <see cref="BlockerLine"/>s of a frame, so a <see cref="LightSource"/> only visits the lines near it.
+	/// </summary>
+	/// <para>
+	/// Every line is listed in each cell its bounding box overlaps.  The lists are stored back to back in <see cref="cellLines"/> with <see cref="cellStarts"/>
+	/// marking where each begins, so rebuilding the grid every frame reuses the same memory.
+	/// </para>
+	class BlockerGrid
+	{
+	public:
+		/// <summary>
+		/// The default width and height of a cell.  About the radius of a small light.
+		/// </summary>
+		static const float DEFAULT_CELL_SIZE;
+
+		/// <summary>
+		/// Initializes a new empty instance of the <see cref="BlockerGrid"/> class.
+		/// </summary>
+		BlockerGrid();
+
+		/// <summary>
+		/// Rebuilds the grid to cover <paramref name="blockerLines"/>.  The cells are made larger if there would be many more cells than lines.
+		/// </summary>
+		/// <param name="blockerLines">The lines to index.  Queries return indices into this vector.</param>
+		/// <param name="cellSize">The width and height of a cell.</param>
+		void build(const std::vector<BlockerLine>& blockerLines, float cellSize);
+
+		/// <summary>
+		/// Calls <paramref name="visit"/> once with the index of every line whose cells overlap the rectangle.  May visit lines that are near but outside of the rectangle.
+		/// </summary>
+		/// <param name="minX">The left of the rectangle.</param>
+		/// <param name="minY">The top of the rectangle.</param>
+		/// <param name="maxX">The right of the rectangle.</param>
+		/// <param name="maxY">The bottom of the rectangle.</param>
+		/// <param name="visit">Called with the index of each line in the vector passed to <see cref="build"/>.</param>
+		template <typename Visitor>
+		void query(float minX, float minY, float maxX, float maxY, Visitor visit) const
+		{
+			if (lineCells.empty() || maxX < originX || maxY < originY || minX > originX + columns * cellSize || minY > originY + rows * cellSize)
+			{
+				return;
+			}
+			int minColumn = getColumn(minX);
+			int minRow = getRow(minY);
+			int maxColumn = getColumn(maxX);
+			int maxRow = getRow(maxY);
+			for (int row = minRow; row <= maxRow; row++)
+			{
+				for (int column = minColumn; column <= maxColumn; column++)
+				{
+					size_t cellI = (size_t)row * columns + column;
+					for (uint32_t i = cellStarts[cellI]; i < cellStarts[cellI + 1]; i++)
+					{
+						uint32_t lineI = cellLines[i];
+						const LineCell& lineCell = lineCells[lineI];
+						//A line spanning several cells is only visited from the first of them inside the rectangle
+						if (std::max(lineCell.column, minColumn) == column && std::max(lineCell.row, minRow) == row)
+						{
+							visit(lineI);
+						}
+					}
+				}
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of cells of the grid.
+		/// </summary>
+		/// <returns>Columns times rows.</returns>
+		size_t getNumCells() const
+		{
+			return (size_t)columns * rows;
+		}
+
+	private:
+		/// <summary>
+		/// The top left cell a line overlaps.
+		/// </summary>
+		struct LineCell
+		{
+			int column;
+			int row;
+		};
+
+		/// <summary>
+		/// Gets the column of <paramref name="x"/>, clamped to the grid.
+		/// </summary>
+		/// <param name="x">The horizontal position.</param>
+		/// <returns>The column.</returns>
+		int getColumn(float x) const
+		{
+			return std::min(std::max((int)((x - originX) / cellSize), 0), columns - 1);
+		}
+
+		/// <summary>
+		/// Gets the row of <paramref name="y"/>, clamped to the grid.
+		/// </summary>
+		/// <param name="y">The vertical position.</param>
+		/// <returns>The row.</returns>
+		int getRow(float y) const
+		{
+			return std::min(std::max((int)((y - originY) / cellSize), 0), rows - 1);
+		}
+
+		/// <summary>
+		/// The horizontal position of the left of the grid.
+		/// </summary>
+		float originX;
+
+		/// <summary>
+		/// The vertical position of the top of the grid.
+		/// </summary>
+		float originY;
+
+		/// <summary>
+		/// The width and height of a cell.
+		/// </summary>
+		float cellSize;
+
+		/// <summary>
+		/// The number of cells across.
+		/// </summary>
+		int columns;
+
+		/// <summary>
+		/// The number of cells down.
+		/// </summary>
+		int rows;
+
+		/// <summary>
+		/// Index in <see cref="cellLines"/> of the first line of each cell, with one extra element marking the end of the last cell.
+		/// </summary>
+		std::vector <uint32_t> cellStarts;
+
+		/// <summary>
+		/// The indices of the lines in each cell, one cell after another.
+		/// </summary>
+		std::vector <uint32_t> cellLines;
+
+		/// <summary>
+		/// The top left cell of each line, used to visit lines only once.
+		/// </summary>
+		std::vector <LineCell> lineCells;
+	};
+}
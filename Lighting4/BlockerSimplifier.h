@@ -0,0 +1,205 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "BlockerSlotMap.h"
+
+namespace lighting
+{
+	/// <summary>
+	/// Derives a smaller set of lines that blocks the same light as the lines of a <see cref="BlockerSlotMap"/>.  Lines on the same supporting line that touch or overlap
+	/// are merged into one, which also drops exact duplicates, like the shared wall of two boxes, and lines covered by another.
+	/// </summary>
+	/// <para>
+	/// Lines are grouped by their supporting line, quantized so a group can be found by hashing.  Each group keeps its original lines and its merged ones,
+	/// so when lines change only the groups they left or joined are merged again.  One sided lines are only merged with one sided lines facing the same way.
+	/// </para>
+	class BlockerSimplifier
+	{
+	public:
+		/// <summary>
+		/// The largest gap between two lines on the same supporting line that are still merged.
+		/// </summary>
+		static const float MERGE_TOLERANCE;
+
+		/// <summary>
+		/// Initializes a new empty instance of the <see cref="BlockerSimplifier"/> class.
+		/// </summary>
+		BlockerSimplifier();
+
+		/// <summary>
+		/// Replaces every group with the lines of <paramref name="blockers"/> and merges them.
+		/// </summary>
+		/// <param name="blockers">The lines to simplify.</param>
+		void reset(const BlockerSlotMap& blockers);
+
+		/// <summary>
+		/// Applies the changes logged by <paramref name="blockers"/> since the last call and merges the groups they touched.  Change logging must have been on since <see cref="reset"/>.
+		/// </summary>
+		/// <param name="blockers">The lines passed to <see cref="reset"/>.</param>
+		void update(BlockerSlotMap& blockers);
+
+		/// <summary>
+		/// Copies the merged lines of every group.
+		/// </summary>
+		/// <param name="lines">Receives the endpoints of the merged lines.</param>
+		/// <param name="versions">Receives, for each of <paramref name="lines"/>, the epoch of <see cref="BlockerSlotMap"/> its group was last merged at.</param>
+		/// <param name="oneSided">Receives if each of <paramref name="lines"/> is one sided.</param>
+		void copyTo(std::vector<BlockerLine>& lines, std::vector<uint64_t>& versions, std::vector<uint8_t>& oneSided) const;
+
+		/// <summary>
+		/// Removes every group.
+		/// </summary>
+		void clear();
+
+		/// <summary>
+		/// Accessor for <see cref="numMergedLines"/>.
+		/// </summary>
+		/// <returns>The number of lines <see cref="copyTo"/> gives.</returns>
+		size_t size() const
+		{
+			return numMergedLines;
+		}
+
+	private:
+		/// <summary>
+		/// The size of the steps the angle of a line is rounded to for its <see cref="GroupKey"/>.
+		/// </summary>
+		static const float ANGLE_STEP;
+
+		/// <summary>
+		/// The size of the steps the distance of a supporting line from the origin is rounded to for its <see cref="GroupKey"/>.
+		/// </summary>
+		static const float OFFSET_STEP;
+
+		/// <summary>
+		/// Identifies the supporting line, and for one sided lines the side, shared by the lines of a <see cref="BlockerGroup"/>.
+		/// </summary>
+		struct GroupKey
+		{
+			/// <summary>
+			/// The quantized angle of the line, in (-pi/2, pi/2].
+			/// </summary>
+			int64_t angle;
+
+			/// <summary>
+			/// The quantized signed distance of the supporting line from the origin.
+			/// </summary>
+			int64_t offset;
+
+			/// <summary>
+			/// 0 for two sided lines, 1 for one sided lines pointing along the angle and 2 for one sided lines pointing against it.
+			/// </summary>
+			uint8_t side;
+
+			bool operator==(const GroupKey& other) const
+			{
+				return angle == other.angle && offset == other.offset && side == other.side;
+			}
+		};
+
+		/// <summary>
+		/// Hashes a <see cref="GroupKey"/> for <see cref="groups"/>.
+		/// </summary>
+		struct GroupKeyHash
+		{
+			size_t operator()(const GroupKey& key) const
+			{
+				return (size_t)(key.angle * 73856093) ^ (size_t)(key.offset * 19349663) ^ (size_t)key.side;
+			}
+		};
+
+		/// <summary>
+		/// The lines on one supporting line.
+		/// </summary>
+		struct BlockerGroup
+		{
+			/// <summary>
+			/// The lines as they are in the <see cref="BlockerSlotMap"/>.
+			/// </summary>
+			std::vector<BlockerLine> lines;
+
+			/// <summary>
+			/// The result of merging <see cref="lines"/>.
+			/// </summary>
+			std::vector<BlockerLine> mergedLines;
+
+			/// <summary>
+			/// The epoch <see cref="mergedLines"/> were last merged at.
+			/// </summary>
+			uint64_t version;
+
+			/// <summary>
+			/// If the group is in <see cref="dirtyGroups"/>.
+			/// </summary>
+			bool dirty;
+		};
+
+		/// <summary>
+		/// Finds the group of a line.
+		/// </summary>
+		/// <param name="line">The endpoints of the line.</param>
+		/// <param name="oneSided">If the line is one sided.</param>
+		/// <returns>The key of the group.</returns>
+		static GroupKey GetGroupKey(const BlockerLine& line, bool oneSided);
+
+		/// <summary>
+		/// Adds a line to its group and marks the group dirty.
+		/// </summary>
+		/// <param name="line">The endpoints of the line.</param>
+		/// <param name="oneSided">If the line is one sided.</param>
+		void addLine(const BlockerLine& line, bool oneSided);
+
+		/// <summary>
+		/// Removes a line with the same endpoints from its group and marks the group dirty.
+		/// </summary>
+		/// <param name="line">The endpoints of the line.</param>
+		/// <param name="oneSided">If the line is one sided.</param>
+		void removeLine(const BlockerLine& line, bool oneSided);
+
+		/// <summary>
+		/// Marks <paramref name="group"/> to be merged by <see cref="mergeDirtyGroups"/>.
+		/// </summary>
+		/// <param name="key">The key of the group.</param>
+		/// <param name="group">The group.</param>
+		void markDirty(const GroupKey& key, BlockerGroup& group);
+
+		/// <summary>
+		/// Merges the lines of every dirty group and erases the groups left empty.
+		/// </summary>
+		/// <param name="epoch">The version given to the merged groups.</param>
+		void mergeDirtyGroups(uint64_t epoch);
+
+		/// <summary>
+		/// Sorts the lines of <paramref name="group"/> along their supporting line and joins the ones that touch into <see cref="BlockerGroup::mergedLines"/>.
+		/// </summary>
+		/// <param name="key">The key of the group.</param>
+		/// <param name="group">The group to merge.</param>
+		static void MergeGroup(const GroupKey& key, BlockerGroup& group);
+
+		/// <summary>
+		/// Every group with at least one line.
+		/// </summary>
+		std::unordered_map<GroupKey, BlockerGroup, GroupKeyHash> groups;
+
+		/// <summary>
+		/// The keys of the groups that changed since the last merge.
+		/// </summary>
+		std::vector<GroupKey> dirtyGroups;
+
+		/// <summary>
+		/// The total size of the <see cref="BlockerGroup::mergedLines"/>.
+		/// </summary>
+		size_t numMergedLines;
+
+		/// <summary>
+		/// Scratch buffers for <see cref="BlockerSlotMap::takeChanges"/>.
+		/// </summary>
+		std::vector<BlockerLine> removedLines, addedLines;
+
+		/// <summary>
+		/// Scratch buffers for <see cref="BlockerSlotMap::takeChanges"/>.
+		/// </summary>
+		std::vector<uint8_t> removedOneSided, addedOneSided;
+	};
+}
@@ -0,0 +1,294 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "LightBlocker.h"
+
+namespace lighting
+{
+	/// <summary>
+	/// The values of a <see cref="LightBlocker"/> only used when it is moved or rotated, kept apart from the endpoints every frame reads.
+	/// </summary>
+	struct BlockerOffsets
+	{
+		/// <summary>
+		/// The horizontal displacement of the first endpoint from the position.
+		/// </summary>
+		float epX1;
+
+		/// <summary>
+		/// The vertical displacement of the first endpoint from the position.
+		/// </summary>
+		float epY1;
+
+		/// <summary>
+		/// The horizontal displacement of the second endpoint from the position.
+		/// </summary>
+		float epX2;
+
+		/// <summary>
+		/// The vertical displacement of the second endpoint from the position.
+		/// </summary>
+		float epY2;
+
+		/// <summary>
+		/// The horizontal displacement of the first endpoint due to rotation.
+		/// </summary>
+		float rotateXOff1;
+
+		/// <summary>
+		/// The vertical displacement of the first endpoint due to rotation.
+		/// </summary>
+		float rotateYOff1;
+
+		/// <summary>
+		/// The horizontal displacement of the second endpoint due to rotation.
+		/// </summary>
+		float rotateXOff2;
+
+		/// <summary>
+		/// The vertical displacement of the second endpoint due to rotation.
+		/// </summary>
+		float rotateYOff2;
+	};
+
+	/// <summary>
+	/// Stores the <see cref="LightBlocker"/>s of a <see cref="LightLayer"/> in dense arrays with O(1) add and remove through <see cref="BlockerHandle"/>s.
+	/// </summary>
+	/// <para>
+	/// The endpoints are packed in <see cref="lines"/> with no gaps, so copying them into a frame is a single copy of contiguous memory.  The offsets are in a parallel array
+	/// so they don't take up cache lines while the endpoints are read.  Removing swaps the last element into the hole and <see cref="slots"/> maps handles to the moved element.
+	/// </para>
+	class BlockerSlotMap
+	{
+	public:
+		/// <summary>
+		/// Initializes a new empty instance of the <see cref="BlockerSlotMap"/> class.
+		/// </summary>
+		BlockerSlotMap();
+
+		/// <summary>
+		/// Adds <paramref name="numLines"/> blockers whose endpoints are displaced from <paramref name="x"/>, <paramref name="y"/> by <paramref name="localLines"/>.
+		/// The storage grows at most once and <see cref="epoch"/> advances once for the whole batch.
+		/// </summary>
+		/// <param name="localLines">The endpoints of the blockers relative to <paramref name="x"/>, <paramref name="y"/>, which become their <see cref="BlockerOffsets"/>.</param>
+		/// <param name="numLines">The number of elements of <paramref name="localLines"/>.</param>
+		/// <param name="x">The horizontal position of the blockers.</param>
+		/// <param name="y">The vertical position of the blockers.</param>
+		/// <param name="handles">Receives the handle of each new blocker, must have room for <paramref name="numLines"/>.</param>
+		/// <param name="oneSided">If the blockers only block light from one side, see <see cref="oneSided"/>.</param>
+		void add(const BlockerLine* localLines, size_t numLines, float x, float y, BlockerHandle* handles, bool oneSided);
+
+		/// <summary>
+		/// Removes the blocker of <paramref name="handle"/>.
+		/// </summary>
+		/// <param name="handle">The handle returned by <see cref="add"/>.</param>
+		/// <returns><c>false</c> if the blocker was already removed.</returns>
+		bool remove(BlockerHandle handle);
+
+		/// <summary>
+		/// Checks if the blocker of <paramref name="handle"/> has not been removed.
+		/// </summary>
+		/// <param name="handle">The handle returned by <see cref="add"/>.</param>
+		/// <returns><c>true</c> if the blocker is stored.</returns>
+		bool contains(BlockerHandle handle) const
+		{
+			return handle.index < slots.size() && slots[handle.index].generation == handle.generation && slots[handle.index].denseIndex < lines.size() &&
+				denseSlots[slots[handle.index].denseIndex] == handle.index;
+		}
+
+		/// <summary>
+		/// Gets the endpoints of the blocker of <paramref name="handle"/>, which must be stored.
+		/// </summary>
+		/// <param name="handle">The handle returned by <see cref="add"/>.</param>
+		/// <returns>The endpoints, valid until the next <see cref="add"/> or <see cref="remove"/>.</returns>
+		const BlockerLine& getLine(BlockerHandle handle) const
+		{
+			return lines[slots[handle.index].denseIndex];
+		}
+
+		/// <summary>
+		/// Gets the endpoints of the blocker of <paramref name="handle"/> to modify them, which advances the <see cref="epoch"/>.
+		/// </summary>
+		/// <param name="handle">The handle returned by <see cref="add"/>.</param>
+		/// <returns>The endpoints, valid until the next <see cref="add"/> or <see cref="remove"/>.</returns>
+		BlockerLine& editLine(BlockerHandle handle)
+		{
+			uint32_t denseI = slots[handle.index].denseIndex;
+			versions[denseI] = ++epoch;
+			logChange(denseI, handle, true);
+			return lines[denseI];
+		}
+
+		/// <summary>
+		/// Gets the offsets of the blocker of <paramref name="handle"/>, which must be stored.
+		/// </summary>
+		/// <param name="handle">The handle returned by <see cref="add"/>.</param>
+		/// <returns>The offsets, valid until the next <see cref="add"/> or <see cref="remove"/>.</returns>
+		BlockerOffsets& getOffsets(BlockerHandle handle)
+		{
+			return offsets[slots[handle.index].denseIndex];
+		}
+
+		/// <summary>
+		/// Accessor for <see cref="lines"/>.
+		/// </summary>
+		/// <returns>The endpoints of every blocker, in no particular order.</returns>
+		const std::vector<BlockerLine>& getLines() const
+		{
+			return lines;
+		}
+
+		/// <summary>
+		/// Accessor for <see cref="versions"/>.
+		/// </summary>
+		/// <returns>The <see cref="epoch"/> each line of <see cref="getLines()"/> was last added or edited at.</returns>
+		const std::vector<uint64_t>& getVersions() const
+		{
+			return versions;
+		}
+
+		/// <summary>
+		/// Accessor for <see cref="oneSided"/>.
+		/// </summary>
+		/// <returns>If each line of <see cref="getLines()"/> only blocks light from one side.</returns>
+		const std::vector<uint8_t>& getOneSided() const
+		{
+			return oneSided;
+		}
+
+		/// <summary>
+		/// Accessor for <see cref="epoch"/>.
+		/// </summary>
+		/// <returns>A number that changes whenever <see cref="getLines()"/> may have changed.</returns>
+		uint64_t getEpoch() const
+		{
+			return epoch;
+		}
+
+		/// <summary>
+		/// Starts or stops recording which lines were added, edited and removed for <see cref="takeChanges"/>.  Either way the record is cleared.
+		/// </summary>
+		/// <param name="changeLogging"><c>true</c> to record changes.  Default is <c>false</c>.</param>
+		void setChangeLogging(bool changeLogging);
+
+		/// <summary>
+		/// Gets the changes since logging started or the last call and clears the record.  An edited line is reported as its old endpoints removed and its new ones added.
+		/// </summary>
+		/// <param name="removedLines">Receives the endpoints of the lines that are no longer stored, as they were at the last call.</param>
+		/// <param name="removedOneSided">Receives if each of <paramref name="removedLines"/> is one sided.</param>
+		/// <param name="addedLines">Receives the current endpoints of the lines added or edited.</param>
+		/// <param name="addedOneSided">Receives if each of <paramref name="addedLines"/> is one sided.</param>
+		void takeChanges(std::vector<BlockerLine>& removedLines, std::vector<uint8_t>& removedOneSided, std::vector<BlockerLine>& addedLines, std::vector<uint8_t>& addedOneSided);
+
+		/// <summary>
+		/// Gets the number of blockers stored.
+		/// </summary>
+		/// <returns>The size of <see cref="lines"/>.</returns>
+		size_t size() const
+		{
+			return lines.size();
+		}
+
+	private:
+		/// <summary>
+		/// Where the blocker of a handle is stored.
+		/// </summary>
+		struct Slot
+		{
+			/// <summary>
+			/// The index of the blocker in the dense arrays, or the index of the next free slot while the slot is free.
+			/// </summary>
+			uint32_t denseIndex;
+
+			/// <summary>
+			/// Incremented each time the blocker of the slot is removed so old handles stop matching.
+			/// </summary>
+			uint32_t generation;
+		};
+
+		/// <summary>
+		/// Value of <see cref="freeSlot"/> when no slot is free.
+		/// </summary>
+		static const uint32_t NO_SLOT = UINT32_MAX;
+
+		/// <summary>
+		/// Indexed by <see cref="BlockerHandle::index"/>.
+		/// </summary>
+		std::vector <Slot> slots;
+
+		/// <summary>
+		/// The first free element of <see cref="slots"/>, the free slots are linked through <see cref="Slot::denseIndex"/>.
+		/// </summary>
+		uint32_t freeSlot;
+
+		/// <summary>
+		/// Pops a slot off the free list, or appends one if it is empty.
+		/// </summary>
+		/// <returns>The index of the slot in <see cref="slots"/>.</returns>
+		uint32_t takeSlot();
+
+		/// <summary>
+		/// Records that the line at <paramref name="denseI"/> changed, unless it already did since the last <see cref="takeChanges"/> or <see cref="changeLogging"/> is off.
+		/// </summary>
+		/// <param name="denseI">The index of the line in the dense arrays.</param>
+		/// <param name="handle">The handle of the line.</param>
+		/// <param name="logOldLine"><c>true</c> if the line was stored before the change and its current endpoints must be reported as removed.</param>
+		void logChange(uint32_t denseI, BlockerHandle handle, bool logOldLine);
+
+		/// <summary>
+		/// If changes are recorded.  Set by <see cref="setChangeLogging(bool)"/>.
+		/// </summary>
+		bool changeLogging;
+
+		/// <summary>
+		/// Nonzero for the elements of <see cref="lines"/> in <see cref="changedHandles"/>, parallel to <see cref="lines"/>.
+		/// </summary>
+		std::vector<uint8_t> changeLogged;
+
+		/// <summary>
+		/// The handles of the lines added or edited since the last <see cref="takeChanges"/>.
+		/// </summary>
+		std::vector<BlockerHandle> changedHandles;
+
+		/// <summary>
+		/// The endpoints the changed lines had at the last <see cref="takeChanges"/>.
+		/// </summary>
+		std::vector<BlockerLine> removedLines;
+
+		/// <summary>
+		/// If each of <see cref="removedLines"/> is one sided.
+		/// </summary>
+		std::vector<uint8_t> removedOneSided;
+
+		/// <summary>
+		/// Advanced by every change to <see cref="lines"/>.
+		/// </summary>
+		uint64_t epoch;
+
+		/// <summary>
+		/// The <see cref="epoch"/> each element of <see cref="lines"/> was last added or edited at, parallel to <see cref="lines"/>.
+		/// </summary>
+		std::vector<uint64_t> versions;
+
+		/// <summary>
+		/// Nonzero for the elements of <see cref="lines"/> that only block light coming from their right, looking from the first endpoint to the second with y pointing down.
+		/// Parallel to <see cref="lines"/>.
+		/// </summary>
+		std::vector<uint8_t> oneSided;
+
+		/// <summary>
+		/// The endpoints of the blockers, read every frame.
+		/// </summary>
+		std::vector <BlockerLine> lines;
+
+		/// <summary>
+		/// The offsets of the blockers, parallel to <see cref="lines"/>.
+		/// </summary>
+		std::vector <BlockerOffsets> offsets;
+
+		/// <summary>
+		/// The slot of each blocker, parallel to <see cref="lines"/>.  Used to update the slot of the blocker moved by <see cref="remove"/>.
+		/// </summary>
+		std::vector <uint32_t> denseSlots;
+	};
+}
@@ -0,0 +1,186 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "ShadePointBuffer.h"
+
+namespace lighting
+{
+	/// <summary>
+	/// A set of lines of a <see cref="ShadePointBuffer"/> that a shadow cast can hit, each named by one of its endpoints.  Each point has a slot holding its place in
+	/// <see cref="members"/>, so adding, removing and checking a line are constant time without hashing, and the memory is kept between frames.
+	/// </summary>
+	/// <para>
+	/// The position and direction of each line are copied next to <see cref="members"/> by the first ray cast after it is added, so <see cref="castRay"/> reads them
+	/// contiguously and checks four lines at a time with SSE2.  Lines added and removed between casts are never copied.
+	/// Whether a line is hit, and which hit is closest, is found by multiplying instead of dividing, and only the closest hit is divided out.
+	/// </para>
+	class CastSegmentSet
+	{
+	public:
+		/// <summary>
+		/// Initializes a new empty instance of the <see cref="CastSegmentSet"/> class.  Lines can be added once it is <see cref="reset"/>.
+		/// </summary>
+		CastSegmentSet();
+
+		/// <summary>
+		/// Empties the set and makes room for the lines of <paramref name="points"/>, which lines are added from until the next reset.
+		/// </summary>
+		/// <param name="points">The points the lines are taken from.</param>
+		void reset(const ShadePointBuffer& points);
+
+		/// <summary>
+		/// Removes every line.  Only touches the slots of the lines in the set.
+		/// </summary>
+		void clear();
+
+		/// <summary>
+		/// Adds the line from a point to its <see cref="ShadePointBuffer::connect"/>, unless it is already in the set.
+		/// </summary>
+		/// <param name="point">The index of the point.</param>
+		void insert(uint32_t point);
+
+		/// <summary>
+		/// Removes the line from a point, if it is in the set.  The last line takes its place.
+		/// </summary>
+		/// <param name="point">The index of the point.</param>
+		void erase(uint32_t point);
+
+		/// <summary>
+		/// Gets the number of lines in the set.
+		/// </summary>
+		/// <returns>The size of <see cref="members"/>.</returns>
+		size_t size() const
+		{
+			return members.size();
+		}
+
+		/// <summary>
+		/// Iterates the points of the lines in the set, in no order.
+		/// </summary>
+		std::vector <uint32_t>::const_iterator begin() const
+		{
+			return members.begin();
+		}
+
+		std::vector <uint32_t>::const_iterator end() const
+		{
+			return members.end();
+		}
+
+		/// <summary>
+		/// Finds the line in the set hit closest to the start of the ray from (<paramref name="x1"/>, <paramref name="y1"/>) to (<paramref name="x2"/>, <paramref name="y2"/>).
+		/// </summary>
+		/// <param name="x1">The horizontal position the ray starts at.</param>
+		/// <param name="y1">The vertical position the ray starts at.</param>
+		/// <param name="x2">The horizontal position the ray ends at.</param>
+		/// <param name="y2">The vertical position the ray ends at.</param>
+		/// <param name="cX">Output parameter of the horizontal position of the hit.  Unmodified if nothing is hit.</param>
+		/// <param name="cY">Output parameter of the vertical position of the hit.  Unmodified if nothing is hit.</param>
+		/// <returns>The point of the line hit, <see cref="ShadePointBuffer::NO_POINT"/> if none is.</returns>
+		uint32_t castRay(float x1, float y1, float x2, float y2, float& cX, float& cY);
+
+		/// <summary>
+		/// Does the same as <see cref="castRay"/>, but skips lines with an endpoint at the position of either endpoint of the line of <paramref name="exceptionPoint"/>.
+		/// </summary>
+		/// <param name="x1">The horizontal position the ray starts at.</param>
+		/// <param name="y1">The vertical position the ray starts at.</param>
+		/// <param name="x2">The horizontal position the ray ends at.</param>
+		/// <param name="y2">The vertical position the ray ends at.</param>
+		/// <param name="exceptionPoint">An endpoint of the line whose neighbors are skipped.</param>
+		/// <param name="cX">Output parameter of the horizontal position of the hit.  Unmodified if nothing is hit.</param>
+		/// <param name="cY">Output parameter of the vertical position of the hit.  Unmodified if nothing is hit.</param>
+		/// <returns>The point of the line hit, <see cref="ShadePointBuffer::NO_POINT"/> if none is.</returns>
+		uint32_t castRayExceptTouching(float x1, float y1, float x2, float y2, uint32_t exceptionPoint, float& cX, float& cY);
+
+		/// <summary>
+		/// Does the same as <see cref="castRay"/>, but skips lines with an endpoint at the horizontal position <paramref name="exceptionX"/>.
+		/// </summary>
+		/// <param name="x1">The horizontal position the ray starts at.</param>
+		/// <param name="y1">The vertical position the ray starts at.</param>
+		/// <param name="x2">The horizontal position the ray ends at.</param>
+		/// <param name="y2">The vertical position the ray ends at.</param>
+		/// <param name="exceptionX">The horizontal position of the endpoints of the lines to skip.</param>
+		/// <param name="cX">Output parameter of the horizontal position of the hit.  Unmodified if nothing is hit.</param>
+		/// <param name="cY">Output parameter of the vertical position of the hit.  Unmodified if nothing is hit.</param>
+		/// <returns>The point of the line hit, <see cref="ShadePointBuffer::NO_POINT"/> if none is.</returns>
+		uint32_t castRayExceptX(float x1, float y1, float x2, float y2, float exceptionX, float& cX, float& cY);
+
+		/// <summary>
+		/// Checks if a ray hits a line, without dividing.
+		/// </summary>
+		/// <param name="x">The horizontal position the ray starts at.</param>
+		/// <param name="y">The vertical position the ray starts at.</param>
+		/// <param name="dirX">How far the ray goes horizontally.</param>
+		/// <param name="dirY">How far the ray goes vertically.</param>
+		/// <param name="lineX">The horizontal position of the first endpoint of the line.</param>
+		/// <param name="lineY">The vertical position of the first endpoint of the line.</param>
+		/// <param name="lineDirX">How far the second endpoint of the line is from the first horizontally.</param>
+		/// <param name="lineDirY">How far the second endpoint of the line is from the first vertically.</param>
+		/// <param name="along">Output parameter that, divided by <paramref name="alongDen"/>, is how far along the ray the hit is, from 0 to 1.</param>
+		/// <param name="alongDen">Output parameter, the positive denominator of <paramref name="along"/>.</param>
+		/// <returns><c>true</c> if the ray hits the line.</returns>
+		static bool CrossRay(float x, float y, float dirX, float dirY, float lineX, float lineY, float lineDirX, float lineDirY, float& along, float& alongDen);
+
+	private:
+		/// <summary>
+		/// Copies the position and direction of the line at <paramref name="slot"/> of <see cref="members"/> from <see cref="points"/>.
+		/// </summary>
+		/// <param name="slot">The index in <see cref="members"/>.</param>
+		void fill(size_t slot);
+
+		/// <summary>
+		/// Copies the position and direction of the lines added since the last ray cast, from <see cref="numFilled"/> on.
+		/// </summary>
+		void fillAll();
+
+		/// <summary>
+		/// The points the lines are taken from.
+		/// </summary>
+		const ShadePointBuffer* points;
+
+		/// <summary>
+		/// The number of <see cref="members"/> at the front whose position and direction are copied.
+		/// </summary>
+		size_t numFilled;
+
+		/// <summary>
+		/// The points of the lines in the set, in no order.
+		/// </summary>
+		std::vector <uint32_t> members;
+
+		/// <summary>
+		/// The index in <see cref="members"/> of each point of <see cref="points"/>, <see cref="ShadePointBuffer::NO_POINT"/> for the points not in the set.
+		/// </summary>
+		std::vector <uint32_t> slots;
+
+		/// <summary>
+		/// The horizontal position of the point of each of the <see cref="members"/>.  The segment arrays are as long as <see cref="points"/> and valid up to <see cref="numFilled"/>.
+		/// </summary>
+		std::vector <float> startX;
+
+		/// <summary>
+		/// The vertical position of the point of each of the <see cref="members"/>.
+		/// </summary>
+		std::vector <float> startY;
+
+		/// <summary>
+		/// The horizontal position of the <see cref="ShadePointBuffer::connect"/> of each of the <see cref="members"/>.
+		/// </summary>
+		std::vector <float> endX;
+
+		/// <summary>
+		/// The vertical position of the <see cref="ShadePointBuffer::connect"/> of each of the <see cref="members"/>.
+		/// </summary>
+		std::vector <float> endY;
+
+		/// <summary>
+		/// How far the <see cref="ShadePointBuffer::connect"/> of each of the <see cref="members"/> is from it horizontally.
+		/// </summary>
+		std::vector <float> dirX;
+
+		/// <summary>
+		/// How far the <see cref="ShadePointBuffer::connect"/> of each of the <see cref="members"/> is from it vertically.
+		/// </summary>
+		std::vector <float> dirY;
+	};
+}
@@ -1,12 +1,204 @@
 #pragma once
-#include <unordered_set>
+#include <atomic>
 #include <set>
 #include <vector>
 #include "LightSource.h"
-#include "CircleShadePoint.h"
+#include "CircleShadePointBuffer.h"
+#include "CastSegmentSet.h"
 
 namespace lighting
 {	
+	struct BlockerSnapshot;
+
+	struct CircleSweepChunk;
+
+	/// <summary>
+	/// Orders the lines of a <see cref="CircleSweepChunk::castPoints"/> by their distance along the ray the sector is at, closest first.
+	/// Lines that don't cross keep their order as the ray sweeps, so the order stays valid while the ray moves.
+	/// </summary>
+	struct CastPointOrder
+	{
+		/// <summary>
+		/// The relative difference under which two distances, or an endpoint and a line, are considered equal.
+		/// </summary>
+		static const float TOLERANCE;
+
+		/// <summary>
+		/// Initializes a new instance of the <see cref="CastPointOrder"/> struct.
+		/// </summary>
+		/// <param name="chunk">The sector whose <see cref="CircleSweepChunk::castRayX"/>, <see cref="CircleSweepChunk::castRayY"/> lines are compared along.</param>
+		/// <param name="points">The points the compared indices are of.</param>
+		CastPointOrder(const CircleSweepChunk* chunk = nullptr, const CircleShadePointBuffer* points = nullptr)
+			:chunk(chunk), points(points)
+		{
+		}
+
+		/// <summary>
+		/// Checks if the line of <paramref name="castPoint1"/> is closer to the light than the line of <paramref name="castPoint2"/> along the ray of <see cref="chunk"/>.
+		/// Lines at the same distance, which meet on the ray, are ordered by which one is in front past it.
+		/// </summary>
+		/// <param name="castPoint1">The endpoint the first line starts at.</param>
+		/// <param name="castPoint2">The endpoint the second line starts at.</param>
+		/// <returns><c>true</c> if the first line comes first.</returns>
+		bool operator()(uint32_t castPoint1, uint32_t castPoint2) const;
+
+		/// <summary>
+		/// Finds where the ray from the origin through <paramref name="rayX"/>, <paramref name="rayY"/> meets the line of <paramref name="linePoint"/>.
+		/// </summary>
+		/// <param name="points">The points of the light.</param>
+		/// <param name="linePoint">An endpoint of the line.</param>
+		/// <param name="rayX">The horizontal direction of the ray.</param>
+		/// <param name="rayY">The vertical direction of the ray.</param>
+		/// <returns>The distance in multiples of the length of the direction.</returns>
+		static float GetRayDistance(const CircleShadePointBuffer& points, uint32_t linePoint, float rayX, float rayY);
+
+		/// <summary>
+		/// Checks if a line is in front of another, meaning the endpoints of the other are behind or on it, or its endpoints are in front of or on the other.
+		/// </summary>
+		/// <param name="points">The points of the light.</param>
+		/// <param name="frontPoint">An endpoint of the line that may be in front.</param>
+		/// <param name="backPoint">An endpoint of the line that may be behind.</param>
+		/// <returns><c>true</c> if the line of <paramref name="frontPoint"/> is in front.</returns>
+		static bool InFront(const CircleShadePointBuffer& points, uint32_t frontPoint, uint32_t backPoint);
+
+		/// <summary>
+		/// Checks if two lines cross at a point that is not an endpoint of either, where their order would swap.
+		/// </summary>
+		/// <param name="points">The points of the light.</param>
+		/// <param name="linePoint1">An endpoint of the first line.</param>
+		/// <param name="linePoint2">An endpoint of the second line.</param>
+		/// <returns><c>true</c> if the lines cross.</returns>
+		static bool Cross(const CircleShadePointBuffer& points, uint32_t linePoint1, uint32_t linePoint2);
+
+		/// <summary>
+		/// Finds the side of a line a point is on.
+		/// </summary>
+		/// <param name="points">The points of the light.</param>
+		/// <param name="linePoint">An endpoint of the line.</param>
+		/// <param name="x">The horizontal position of the point.</param>
+		/// <param name="y">The vertical position of the point.</param>
+		/// <returns><c>1</c> or <c>-1</c> for each side, <c>0</c> if the point is on the line.</returns>
+		static int GetSide(const CircleShadePointBuffer& points, uint32_t linePoint, float x, float y);
+
+		/// <summary>
+		/// The sector whose ray lines are compared along.
+		/// </summary>
+		const CircleSweepChunk* chunk;
+
+		/// <summary>
+		/// The points the compared indices are of.
+		/// </summary>
+		const CircleShadePointBuffer* points;
+	};
+
+	/// <summary>
+	/// An angular sector of a <see cref="CircleLightSource"/>, a range of its sorted <see cref="CircleLightSource::shadePoints"/> that is swept on its own.
+	/// </summary>
+	struct CircleSweepChunk
+	{
+		/// <summary>
+		/// The index of the first point of the sector.
+		/// </summary>
+		size_t beginI;
+
+		/// <summary>
+		/// One past the index of the last point of the sector.
+		/// </summary>
+		size_t endI;
+
+		/// <summary>
+		/// The pseudo angle the sector starts at.  Half way between the last point of the previous sector and the first point of this one, so no point lies on it.
+		/// </summary>
+		float beginAngle;
+
+		/// <summary>
+		/// The pseudo angle the sector ends at, the <see cref="beginAngle"/> of the next sector.
+		/// </summary>
+		float endAngle;
+
+		/// <summary>
+		/// The lines that could be shadow casted to as the sector is swept, closest first.  Used once <see cref="castPointsOrdered"/> is set.
+		/// </summary>
+		std::set <uint32_t, CastPointOrder> castPoints;
+
+		/// <summary>
+		/// The lines that could be shadow casted to as the sector is swept, in no order.  Seeded with every line crossing <see cref="beginAngle"/>.
+		/// Moved to <see cref="castPoints"/> once shadow casts checked more than <see cref="CircleLightSource::ORDER_CAST_POINTS_SCANS"/> of them for each <see cref="castPointUpdates"/>.
+		/// </summary>
+		CastSegmentSet unorderedCastPoints;
+
+		/// <summary>
+		/// The number of lines added to and removed from <see cref="unorderedCastPoints"/> in the sweep.
+		/// </summary>
+		size_t castPointUpdates;
+
+		/// <summary>
+		/// The number of lines of <see cref="unorderedCastPoints"/> checked by shadow casts in the sweep.
+		/// </summary>
+		size_t castPointScans;
+
+		/// <summary>
+		/// The number of shadow casts in the sweep.  Added to <see cref="CircleLightSource::ShadowCalled"/> once the sweep is stitched, so sectors swept at the same time don't share a counter.
+		/// </summary>
+		size_t shadowCasts;
+
+		/// <summary>
+		/// The number of lines checked by shadow casts in the sweep, ordered or not.  Added to <see cref="CircleLightSource::CastPointsProcessed"/> once the sweep is stitched.
+		/// </summary>
+		size_t castPointsChecked;
+
+		/// <summary>
+		/// If the lines are in <see cref="castPoints"/>.
+		/// </summary>
+		bool castPointsOrdered;
+
+		/// <summary>
+		/// Set when two lines of the sector cross, they are then moved back to <see cref="unorderedCastPoints"/> for the rest of the sweep because their order changes as the ray passes the crossing.
+		/// </summary>
+		bool castPointsCrossed;
+
+		/// <summary>
+		/// The direction of the ray <see cref="castPoints"/> are ordered along, the position of the point being swept.
+		/// </summary>
+		float castRayX, castRayY;
+
+		/// <summary>
+		/// The drawing coordinates of the sector, appended to <see cref="CircleFrameSlot::drawPoints"/> by <see cref="CircleLightSource::stitchSweepChunks()"/>.
+		/// </summary>
+		std::vector <float> drawPoints;
+	};
+
+	/// <summary>
+	/// The inputs and results of a <see cref="CircleLightSource"/> for one frame.  There is one for each frame that may be processed or drawn at once.
+	/// </summary>
+	struct CircleFrameSlot
+	{
+		/// <summary>
+		/// Horizontal position of the center of the light on the screen.
+		/// </summary>
+		float x;
+
+		/// <summary>
+		/// Vertical position of the center of the light on the screen.
+		/// </summary>
+		float y;
+
+		/// <summary>
+		/// The number of sides of the polygon bounding the light in this frame, or <see cref="CircleLightSource::SQUARE_BOUNDS"/>.
+		/// </summary>
+		size_t circleBoundSides;
+
+		/// <summary>
+		/// Stores the x and y of the edges of shadows in the local bitmap.  Populated by <see cref="CircleLightSource::stitchSweepChunks()"/>.
+		/// </summary>
+		std::vector <float> drawPoints;
+
+		/// <summary>
+		/// The frame <see cref="drawPoints"/> were processed in, kept when they are reused so <see cref="CircleLightSource::shadeMap"/> is only redrawn when they change.
+		/// </summary>
+		uint64_t shadowsFrame;
+	};
+
 	/// <summary>
 	/// A child of <see cref="LightSource" /> represents a full circle of light that would be produced by an oil lamp or a light bulb.
 	/// </summary>
@@ -16,30 +208,46 @@ namespace lighting
 	{
 	public:	
 
-		static uint64_t ShadePointsProcessed;
-		static uint64_t ShadowCalled;
-		static uint64_t CastPointsProcessed;
-		static uint64_t TotalCycles;
+		static std::atomic<uint64_t> ShadePointsProcessed;
+		static std::atomic<uint64_t> ShadowCalled;
+		static std::atomic<uint64_t> CastPointsProcessed;
+		static std::atomic<uint64_t> TotalCycles;
 
 		/// <summary>
-		/// Number of bits for the radix base
+		/// The number of lines a sector's shadow casts may check for each line added to or removed from its <see cref="CircleSweepChunk::unorderedCastPoints"/> before they are kept in order.
+		/// Keeping them in order makes adding and removing slower, so it only pays off when shadow casts check many lines.
 		/// </summary>
-		static const uint8_t RADIX_BASE_BITS = 8;
-		
+		static const size_t ORDER_CAST_POINTS_SCANS = 32;
+
 		/// <summary>
-		/// The maximum decimal value for the radix base.
+		/// Value for <see cref="setCircleBoundSides(size_t)"/> to bound the light by the square around its circle.
 		/// </summary>
-		static const unsigned int RADIX_BASE_NUM = 256;
-		
+		static const size_t SQUARE_BOUNDS = 0;
+
 		/// <summary>
-		/// Number of bits for the maximum value of elements sorted by radix sort
+		/// The fewest sides the polygon of circle bounds can have.  Shadow casts are twice the radius long, so the corners of the polygon must be closer than that.
 		/// </summary>
-		static const uint8_t RADIX_MAX_BITS = 24;
-		
+		static const size_t MIN_CIRCLE_BOUND_SIDES = 8;
+
+		/// <summary>
+		/// How far outside the circle the sides of the polygon of circle bounds are, so blockers clipped to the circle stay inside it even when rounding leaves them just past the circle.
+		/// </summary>
+		static const float CIRCLE_BOUND_GAP;
+
 		/// <summary>
-		/// The maximum decimal value of the elements sorted by <see cref="::radixSortShadePoints"/>.
+		/// The longest arc, in pixels of the light bitmap, that a step of <see cref="ShadePointBuffer::radixVal"/> may turn a ray through at the corners of the bounds.
+		/// Points closer together than that may sort out of order, which only moves a shadow edge by a fraction of a pixel.
 		/// </summary>
-		static unsigned int RADIX_MAX_NUM;
+		static const float RADIX_MAX_ARC;
+
+		/// <summary>
+		/// Finds the fewest bits of <see cref="ShadePointBuffer::radixVal"/> that keep a step of it within <see cref="RADIX_MAX_ARC"/> for a light of this size.
+		/// A pseudo angle changes at least half as fast as the real angle, so a step of a key with <c>n</c> bits turns a ray by at most <c>8 / 2^n</c> radians.
+		/// </summary>
+		/// <param name="radius">The radius of the light.</param>
+		/// <param name="lightBmpScale">The scale of the light bitmap the shadows are drawn to.</param>
+		/// <returns>The fewest bits the keys need, which <see cref="CircleShadePointBuffer::setRadixMaxBits"/> rounds up to a width it can sort.</returns>
+		static int GetRadixMaxBits(float radius, float lightBmpScale);
 
 		/// <summary>
 		/// Set to the most negative possible value of float.
@@ -57,7 +265,7 @@ namespace lighting
 		CircleLightSource(LightLayer* ownerLightLayer, float radius, uint8_t r = UINT8_MAX, uint8_t g = UINT8_MAX, uint8_t b = UINT8_MAX);
 				
 		/// <summary>
-		/// Sets the horizontal and vertical position of the center of the <see cref="CircleLightSource"/> on the screen.  Values are stored in <see cref="heldX"/> and <see cref="heldY"/> until <see cref="transferHeldVars()"/> is called.
+		/// Sets the horizontal and vertical position of the center of the <see cref="CircleLightSource"/> on the screen.  Values are stored in <see cref="heldX"/> and <see cref="heldY"/> until <see cref="transferHeldVars(size_t)"/> is called.
 		/// </summary>
 		/// <param name="x">The horizontal position.</param>
 		/// <param name="y">The vertical position.</param>
@@ -74,65 +282,103 @@ namespace lighting
 		/// <param name="g">The green value of the color (0 to 255).</param>
 		/// <param name="b">The blue value of the color (0 to 255).</param>
 		virtual void setLightColor(uint8_t r, uint8_t g, uint8_t b);
-		
-		virtual ~CircleLightSource();
 
-	protected:
 		/// <summary>
-		/// Uses radix sort to sort the elements of <see cref="shadePoints"/>.
+		/// Bounds the light by a polygon with <paramref name="circleBoundSides"/> sides around its circle instead of the square around it.
+		/// The corners of the square are outside the falloff of <see cref="LSource_Map"/>, so blockers only there are dropped before they are clipped, sorted and swept.
+		/// Value is stored in <see cref="heldCircleBoundSides"/> until <see cref="transferHeldVars(size_t)"/> is called.  Default is <see cref="SQUARE_BOUNDS"/>.
 		/// </summary>
-		void radixSortShadePoints();
+		/// <param name="circleBoundSides">The number of sides, raised to <see cref="MIN_CIRCLE_BOUND_SIDES"/>, or <see cref="SQUARE_BOUNDS"/>.</param>
+		void setCircleBoundSides(size_t circleBoundSides)
+		{
+			heldCircleBoundSides = (circleBoundSides == SQUARE_BOUNDS || circleBoundSides > MIN_CIRCLE_BOUND_SIDES) ? circleBoundSides : MIN_CIRCLE_BOUND_SIDES;
+		}
 		
-		/// <summary>
-		/// Called by <see cref="radixSortShadePoints"/> as a helper method for the sorting process
-		/// </summary>
-		/// <param name="bI">The amount of bits to shift by.</param>
-		void countingSortShadePoints(int bI);
+		virtual ~CircleLightSource();
 
+	protected:
 		/// <summary>
 		/// The allegro bitmap flags for creating the <see cref="shadeMap"/>.
 		/// </summary>
-		static const int SHADE_MAP_FLAGS = ALLEGRO_NO_PRESERVE_TEXTURE | ALLEGRO_MIN_LINEAR | ALLEGRO_MAG_LINEAR;;
+		/// <para>
+		/// The texture is preserved because the <see cref="shadeMap"/> of an unchanged light is drawn again without being redrawn.
+		/// </para>
+		static const int SHADE_MAP_FLAGS = ALLEGRO_MIN_LINEAR | ALLEGRO_MAG_LINEAR;
 				
 		/// <summary>
-		/// The amount of preset <see cref="CircleShadePoint"/>s that will be added to <see cref="shadePoints"/>.
+		/// The amount of preset points that will be added to <see cref="shadePoints"/> for <see cref="SQUARE_BOUNDS"/>.
 		/// </summary>
 		static const int BOUND_POINTS_SIZE = 8;
 
 		/// <summary>
 		/// If the line created by <paramref name="testPoint"/> and its connected point cross angle = 0, return <c>true</c>, <c>false</c> otherwise.
 		/// </summary>
-		/// <param name="testPoint"> The <see cref="CircleShadePoint"/> which represents one of the endpoints of the line to test.</param>
+		/// <param name="testPoint">The index of one of the endpoints of the line to test.</param>
 		/// <returns>If the line passes through angle = 0.</returns>
-		static bool CrossesZero(CircleShadePoint* testPoint);
+		bool crossesZero(uint32_t testPoint) const;
 		
 		/// <summary>
-		/// Finds the angle of <paramref name="ep2"/> from origin <paramref name="ep1"/> relative to <paramref name="oriRads"/>.
+		/// Finds the pseudo angle of <paramref name="ep2"/> from origin <paramref name="ep1"/> relative to <paramref name="oriAngle"/>.
 		/// </summary>
 		/// <par>
-		/// If <c>0</c>was returned, that means the angle between <paramref name="ep2"/> and <paramref name="ep1"/> is in line with the <paramref name="oriRads"/>.
+		/// If <c>0</c>was returned, that means the angle between <paramref name="ep2"/> and <paramref name="ep1"/> is in line with the <paramref name="oriAngle"/>.
 		/// </par>
-		/// <param name="ep1">The <see cref="CircleShadePoint"/> representing the first endpoint.</param>
-		/// <param name="ep2">The <see cref="CircleShadePoint"/> representing the second endpoint (this is usually just the <see cref="ShadePoint::connectedPoint"/> of <paramref name="ep1"/>.</param>
-		/// <param name="oriRads">The radian the line relative to the <see cref="CircleLightSource"/> center (this is usualy just the <see cref="ShadePoint::rads"/> of <paramref name="ep1"/></param>
-		/// <returns>The angle of <paramref name="ep2"/> from origin <paramref name="ep1"/> relative to <paramref name="oriRads"/>.</returns>
-		static float GetRadDif(CircleShadePoint* ep1, CircleShadePoint* ep2, float oriRads);
+		/// <param name="ep1">The index of the first endpoint.</param>
+		/// <param name="ep2">The index of the second endpoint (this is usually just the <see cref="ShadePointBuffer::connect"/> of <paramref name="ep1"/>.</param>
+		/// <param name="oriAngle">The pseudo angle of the line relative to the <see cref="CircleLightSource"/> center (this is usualy just the <see cref="CircleShadePointBuffer::getAngle"/> of <paramref name="ep1"/></param>
+		/// <returns>The pseudo angle of <paramref name="ep2"/> from origin <paramref name="ep1"/> relative to <paramref name="oriAngle"/>.</returns>
+		float getAngleDif(uint32_t ep1, uint32_t ep2, float oriAngle) const;
 		
 		/// <summary>
 		/// Calculates if the <paramref name="checkPoint"/> is in front of <paramref name="alphaPoint"/>.
 		/// </summary>
-		/// <param name="alphaPoint">The <see cref="CircleShadePoint"/> representing one of the endpoints of the line that will be used to check <paramref name="checkPoint"/>.</param>
-		/// <param name="checkPoint">The <see cref="CircleShadePoint"/> to check if in front of line made by <paramref name="alphaPoint"/>.</param>
+		/// <param name="alphaPoint">The index of one of the endpoints of the line that will be used to check <paramref name="checkPoint"/>.</param>
+		/// <param name="checkPoint">The index of the point to check if in front of line made by <paramref name="alphaPoint"/>.</param>
 		/// <returns><c>true</c> if  <paramref name="checkPoint"/> is closer to the center of the <see cref="LightSource"/> than the line made by <paramref name="alphaPoint"/></returns>
-		static bool CheckPointFront(CircleShadePoint* alphaPoint, CircleShadePoint* checkPoint);
+		bool checkPointFront(uint32_t alphaPoint, uint32_t checkPoint) const;
+
+		/// <summary>
+		/// Sets the <see cref="CircleFrameSlot::x"/>, <see cref="CircleFrameSlot::y"/>, <see cref="CircleFrameSlot::circleBoundSides"/> of the frame slot at <paramref name="slot"/> to the corresponding "held" attributes.  Called from <see cref="LightLayer::detach()"/>.
+		/// </summary>
+		/// <param name="slot">The frame slot that will be processed next.</param>
+		virtual void transferHeldVars(size_t slot) override;
 
 		/// <summary>
-		/// Sets the <see paramref="x"/>, <see paramref="y"/> attributes to the corresponding "held" attributes.  Called from <see cref="LightLayer::dispatch()"/>.
+		/// Resizes <see cref="frameSlots"/>.
 		/// </summary>
-		virtual void transferHeldVars() override;
+		/// <param name="slots">The number of frame slots.</param>
+		virtual void setPipelineSlots(size_t slots) override;
 
 		/// <summary>
-		/// Converts all elements of <paramref name="lightBlockers" /> into two <see cref="CircleShadePoint"/>s which are stored in the <see cref="shadePoints" /> vector and then sorted using <see cref="::radixSortShadePoints"/>.  Function also handles edge cases.
+		/// Copies the <see cref="CircleFrameSlot::drawPoints"/> of the frame slot at <paramref name="previousSlot"/> to the frame slot at <see cref="computeSlot"/>.
+		/// </summary>
+		/// <param name="previousSlot">The frame slot of the last frame <c>this</c> has shadows for.</param>
+		virtual void reuseResults(size_t previousSlot) override;
+
+		/// <summary>
+		/// Checks if the position, the bounds and the <see cref="BlockerLine"/>s near the frame slot at <see cref="computeSlot"/> are the same as when <see cref="createShadePoints()"/> last ran.
+		/// </summary>
+		/// <returns><c>true</c> if the shadows would not change.</returns>
+		virtual bool hasUnchangedInputs() override;
+
+		/// <summary>
+		/// Populates <see cref="nearbyLines"/> with the lines of <paramref name="blockers"/> whose bounding box overlaps the bounds of <c>this</c> centered at
+		/// <paramref name="x"/>, <paramref name="y"/> and sets <see cref="nearbyLinesVersion"/>.  With circle bounds, lines whose bounding box doesn't come within the radius are left out.
+		/// </summary>
+		/// <param name="blockers">The blockers of the frame being processed.</param>
+		/// <param name="x">The horizontal position of the center of the light.</param>
+		/// <param name="y">The vertical position of the center of the light.</param>
+		/// <param name="circleBoundSides">The number of sides of the circle bounds, or <see cref="SQUARE_BOUNDS"/>.</param>
+		void queryNearbyLines(const BlockerSnapshot& blockers, float x, float y, size_t circleBoundSides);
+
+		/// <summary>
+		/// Checks if <see cref="shadeMap"/> must be redrawn for the frame slot at <see cref="drawSlot"/> and records that it is.
+		/// </summary>
+		/// <returns><c>false</c> if <see cref="shadeMap"/> already holds the shadows of the frame slot in the current color.</returns>
+		bool beginShadeMapRedraw();
+
+		/// <summary>
+		/// Converts all elements of <paramref name="lightBlockers" /> into two points which are stored in <see cref="shadePoints" /> and then sorted using <see cref="CircleShadePointBuffer::sort()"/>.  Function also handles edge cases.
 		/// </summary>
 		virtual void createShadePoints() override;
 		
@@ -141,6 +387,31 @@ namespace lighting
 		/// </summary>
 		virtual void mapShadePoints();
 
+		/// <summary>
+		/// Splits <see cref="shadePoints"/> into angular sectors stored in <see cref="sweepChunks"/>.  Sectors only start between two different radians.
+		/// </summary>
+		/// <param name="maxChunks">The maximum number of sectors to create.</param>
+		/// <returns>The number of sectors created.</returns>
+		virtual size_t createSweepChunks(size_t maxChunks) override;
+
+		/// <summary>
+		/// Sweeps the sector at <paramref name="chunkI"/> of <see cref="sweepChunks"/>.  The first sector is started like <see cref="mapShadePoints()"/>,
+		/// the others are seeded by a <see cref="shadowCast"/> at their <see cref="CircleSweepChunk::beginAngle"/>.
+		/// </summary>
+		/// <param name="chunkI">The index of the sector.</param>
+		virtual void mapSweepChunk(size_t chunkI) override;
+
+		/// <summary>
+		/// Appends the <see cref="CircleSweepChunk::drawPoints"/> of every sector to <see cref="drawPoints"/>.
+		/// </summary>
+		virtual void stitchSweepChunks() override;
+
+		/// <summary>
+		/// Adds every line that crosses the <see cref="CircleSweepChunk::beginAngle"/> of <paramref name="chunk"/> to its <see cref="CircleSweepChunk::castPoints"/>.
+		/// </summary>
+		/// <param name="chunk">The sector to seed.</param>
+		void seedCastPoints(CircleSweepChunk& chunk);
+
 		/// <summary>
 		/// Uses the <see cref="LightSource::drawPoint"/> vector, which was set by <see cref="mapShadePoints"/>, to draw onto the <see cref="shadeMap"/>.
 		/// </summary>
@@ -152,28 +423,19 @@ namespace lighting
 		virtual void drawToLightMap() override;
 
 		/// <summary>
-		/// Restores <see cref="shadePoints" /> and
+		/// Empties <see cref="shadePoints" />, keeping its memory, and adds the bound points back.
 		/// </summary>
-		/// <param name="lightBlockersSize">Size of the list of <see cref="lightBlocker"/>s passed to be converted to <see cref="CircleShadePoint"/>s.</param>
+		/// <param name="lightBlockersSize">Size of the list of <see cref="lightBlocker"/>s passed to be converted to points.</param>
 		virtual void resetPoints(size_t lightBlockersSize);
 		
 		/// <summary>
-		/// Creates and pushes <see cref="CircleShadePoint"/>s representing the edges of the light to <see cref="shadePoints"/>.
+		/// Adds the points representing the edges of the light to <see cref="shadePoints"/>, the square around its circle or the polygon of <see cref="computedCircleBoundSides"/> sides.
+		/// The polygon is turned half a side so that, like the square, none of its corners are at angle=<c>0</c>.
 		/// </summary>
 		virtual void createBoundShadePoints();
 		
 		/// <summary>
-		/// Checks if the lines created by these coordinates intersect with the boundaries.  If they do, find the collision point and set the coordinates to that.  Calls <see cref="::moveIntoRadius" /> on all coordinates.
-		/// </summary>
-		/// <param name="x1">The horizontal position of the first endpoint.  Used as out parameter.</param>
-		/// <param name="y1">The vertical position of the first endpoint.  Used as out parameter.</param>
-		/// <param name="x2">The horizontal position of the second endpoint.  Used as out parameter.</param>
-		/// <param name="y2">The vertical position of the second endpoint.  Used as out parameter</param>
-		/// <returns>Whether the line is within the bounds of the light.</returns>
-		virtual bool handleBoundCollisions(float& x1, float& y1, float& x2, float& y2);
-				
-		/// <summary>
-		/// If num is on the radius, it is brought into the radius to avoid collisions with <see cref="ShadePoint"/>s.
+		/// If num is on the radius, it is brought into the radius to avoid collisions with the bound points.
 		/// </summary>
 		/// <param name="num">The value to check if on bound.  Output parameter</param>
 		virtual void bringEqualBoundToInBound(float& num)
@@ -189,106 +451,217 @@ namespace lighting
 		}
 		
 		/// <summary>
-		/// Converts parameters into screen coordinates and pushes them to <see cref="drawPoints"/>.
+		/// Converts parameters into screen coordinates and pushes them to the <see cref="CircleSweepChunk::drawPoints"/> of <paramref name="chunk"/>.
 		/// </summary>
+		/// <param name="chunk">The sector being swept.</param>
 		/// <param name="x1">The horizontal position of the first endpoint.</param>
 		/// <param name="y1">The vertical position of the first endpoint.</param>
 		/// <param name="x2">The horizontal position of the second endpoint.</param>
 		/// <param name="y2">The vertical position of the second endpoint.</param>
-		virtual void addDrawPoints(float x1, float y1, float x2, float y2);
+		virtual void addDrawPoints(CircleSweepChunk& chunk, float x1, float y1, float x2, float y2);
 
 		/// <summary>
-		/// Handles the first <see cref="CircleShadePoint"/> from <see cref="shadePoints"/> appropiatly.  Called at beginning of <see cref="::mapShadePoints"/> function.
+		/// Handles the first point from <see cref="shadePoints"/> appropiatly.  Called at beginning of <see cref="::mapShadePoints"/> function.
 		/// </summary>
+		/// <param name="chunk">The first sector.</param>
 		/// <param name="alphaPoint">One of the endpoints of the line closest to origin.  Completely an output parameter.</param>
 		/// <param name="firstX">The first x of the collision with the line created by <paramref name="alphaPoint"/> at angle=<c>0</c></param>
 		/// <param name="firstY">The first y of the collision with the line created by <paramref name="alphaPoint"/> at angle=<c>0</c>.</param>
 		/// <param name="i">Used as an output parameter for the number of elements of <see cref="shadePoints"/> that were processed finding the first valid line.</param>
-		/// <param name="radAtZero"><c>true</c> when a <see cref="CircleShadePoint"/> was found exactly at angle=<c>0</c>.</param>
-		virtual void handleFirstShadePoint(CircleShadePoint*& alphaPoint, float& firstX, float& firstY, int& i, bool& radAtZero);
+		/// <param name="radAtZero"><c>true</c> when a point was found exactly at angle=<c>0</c>.</param>
+		virtual void handleFirstShadePoint(CircleSweepChunk& chunk, uint32_t& alphaPoint, float& firstX, float& firstY, int& i, bool& radAtZero);
 				
 		/// <summary>
 		/// Called after the <see cref="shadePoints"/> have been entirely iterated over by <see cref="::mapShadePoints"/>.
 		/// </summary>
-		/// <param name="alphaPoint">The last <see cref="ShadePoint"/> that had a line closest to the origin.</param>
-		/// <param name="radAtZero">Whether the first <see cref="ShadePoint"/> was a point directly at angle=<c>0</c>.</param>
+		/// <param name="chunk">The last sector.</param>
+		/// <param name="alphaPoint">The last point that had a line closest to the origin.</param>
+		/// <param name="radAtZero">Whether the first point was directly at angle=<c>0</c>.</param>
 		/// <param name="prevX">The previousX value when a collision with <see cref="alphaPoint"/> occured.</param>
 		/// <param name="prevY">The previousY value when a collision with <see cref="alphaPoint"/> occured.</param>
-		/// <param name="firstX">The x value of the first <see cref="CirleShadePoint"/>.</param>
-		/// <param name="firstY">The y value of the first <see cref="CircleShadePoint"/>.</param>
-		virtual void handleLastShadePoint(CircleShadePoint* alphaPoint, bool radAtZero, float prevX, float prevY, float firstX, float firstY);
+		/// <param name="firstX">The x value of the first point.</param>
+		/// <param name="firstY">The y value of the first point.</param>
+		virtual void handleLastShadePoint(CircleSweepChunk& chunk, uint32_t alphaPoint, bool radAtZero, float prevX, float prevY, float firstX, float firstY);
 		
 		/// <summary>
-		/// When the end of the line of an alphaPoint is reached,  this function will check if any <see cref="ShadePoint"/>s at the same radian
+		/// When the end of the line of an alphaPoint is reached,  this function will check if any points at the same radian
 		/// as the endpoint are valid.  If any are valid, it will return the line that will be closest to the origin using the output parameters.
 		/// </summary>
 		/// <par>
-		/// Will add the <paramref name="updatePoint"/> to <see cref="castPoints"/> if the <see cref="ShadePoint::connectedPoint"/> has a greater angle.  Will remove <paramref name="updatePoint"/>'s 
-		/// <see cref="ShadePoint::connectedPoint"/> from <see cref="castPOints"/> if <paramref name="updatePoint"/> has a radian greater than the <see cref="ShadePoint::connectedPoint"/>.  Will account for lines crossing radian zero.
+		/// Will add the <paramref name="updatePoint"/> to <see cref="castPoints"/> if the <see cref="ShadePointBuffer::connect"/> has a greater angle.  Will remove <paramref name="updatePoint"/>'s 
+		/// <see cref="ShadePointBuffer::connect"/> from <see cref="castPOints"/> if <paramref name="updatePoint"/> has a radian greater than the <see cref="ShadePointBuffer::connect"/>.  Will account for lines crossing radian zero.
 		/// </par>
-		/// <param name="updatePoint">The <see cref="CircleShadePoint"/> to check if adding or removing is needed.</param>
-		virtual void updateCastPoints(CircleShadePoint* updatePoint);
+		/// <param name="chunk">The sector whose <see cref="CircleSweepChunk::castPoints"/> are updated.</param>
+		/// <param name="updatePoint">The index of the point to check if adding or removing is needed.</param>
+		virtual void updateCastPoints(CircleSweepChunk& chunk, uint32_t updatePoint);
+
+		/// <summary>
+		/// Adds the line starting at <paramref name="castPoint"/> to the <see cref="CircleSweepChunk::castPoints"/> of <paramref name="chunk"/>, unless it is already there.
+		/// </summary>
+		/// <param name="chunk">The sector being swept.</param>
+		/// <param name="castPoint">The endpoint the line starts at.</param>
+		void addCastPoint(CircleSweepChunk& chunk, uint32_t castPoint);
+
+		/// <summary>
+		/// Removes the line starting at <paramref name="castPoint"/> from the <see cref="CircleSweepChunk::castPoints"/> of <paramref name="chunk"/>, if it is there.
+		/// </summary>
+		/// <param name="chunk">The sector being swept.</param>
+		/// <param name="castPoint">The endpoint the line starts at.</param>
+		void removeCastPoint(CircleSweepChunk& chunk, uint32_t castPoint);
+
+		/// <summary>
+		/// Moves the <see cref="CircleSweepChunk::unorderedCastPoints"/> of <paramref name="chunk"/> to its <see cref="CircleSweepChunk::castPoints"/>, unless two of them cross.
+		/// </summary>
+		/// <param name="chunk">The sector being swept.</param>
+		void orderCastPoints(CircleSweepChunk& chunk);
+
+		/// <summary>
+		/// Moves the <see cref="CircleSweepChunk::castPoints"/> of <paramref name="chunk"/> back to its <see cref="CircleSweepChunk::unorderedCastPoints"/> if <paramref name="castPoint1"/> and <paramref name="castPoint2"/> cross.
+		/// </summary>
+		/// <param name="chunk">The sector being swept.</param>
+		/// <param name="castPoint1">The endpoint the first line starts at.</param>
+		/// <param name="castPoint2">The endpoint the second line starts at.</param>
+		void checkCastPointsCross(CircleSweepChunk& chunk, uint32_t castPoint1, uint32_t castPoint2);
+
+		/// <summary>
+		/// Shortens a ray from the origin to where it hits the line of <paramref name="castPoint"/>, unless that line shares an endpoint with the line of <paramref name="exceptionPoint"/>.
+		/// </summary>
+		/// <param name="castPoint">The endpoint the line starts at.</param>
+		/// <param name="exceptionPoint">The endpoint of a line that is ignored, may be <see cref="ShadePointBuffer::NO_POINT"/>.</param>
+		/// <param name="cX">The horizontal position of the end of the ray, moved to the hit.</param>
+		/// <param name="cY">The vertical position of the end of the ray, moved to the hit.</param>
+		/// <returns><c>true</c> if the ray hit the line.</returns>
+		bool castToLine(uint32_t castPoint, uint32_t exceptionPoint, float& cX, float& cY) const;
 		
 		/// <summary>
-		/// When a line ends and there is no clear point to go to, this method is called to iterate through all of the lines below the radian
-		/// and find which one is closest to the origin and return it.
+		/// When a line ends and there is no clear point to go to, this method is called to find the line closest to the origin at the radian.
 		/// </summary>
-		/// <param name="rads">The radian to check.</param>
-		/// <param name="cX">Output parameter of the horizontal position of a collision with the <see cref="ShadePoint"/> being returned.</param>
-		/// <param name="cY">>Output parameter of the vertical position of a collision with the <see cref="ShadePoint"/> being returned.</param>
+		/// <par>
+		/// Once a sector keeps its lines in <see cref="CircleSweepChunk::castPoints"/> they are in order, so this is the first one the ray hits.  Until then, or after two of them cross, all of them are checked at once by
+		/// <see cref="CastSegmentSet::castRay"/>.
+		/// </par>
+		/// <param name="chunk">The sector whose <see cref="CircleSweepChunk::castPoints"/> are checked.</param>
+		/// <param name="angle">The pseudo angle to check.</param>
+		/// <param name="cX">Output parameter of the horizontal position of a collision with the line being returned.</param>
+		/// <param name="cY">>Output parameter of the vertical position of a collision with the line being returned.</param>
 		/// <param name="exceptionPoint">Set a point that cannot be a valid return, will be ignored.</param>
-		/// <returns>A <see cref="CircleShadePoint"/> representing an endpoint for a line closest to the origin at angle <paramref name="rads"/></returns>
-		virtual CircleShadePoint* shadowCast(float rads, float& cX, float& cY, CircleShadePoint* exceptionPoint = nullptr);
+		/// <returns>The index of an endpoint for a line closest to the origin at angle <paramref name="angle"/></returns>
+		virtual uint32_t shadowCast(CircleSweepChunk& chunk, float angle, float& cX, float& cY, uint32_t exceptionPoint = ShadePointBuffer::NO_POINT);
 				
 		/// <summary>
-		/// Will iterate through all of the <see cref="ShadePoint"/>s with the same radian as the element in <see cref="shadePoints"/> at index <paramref name="i"/> and set the <paramref name="alphaPoint"/>, <paramref name="prevX"/>, and lastY to the point that has the minimum distance 
+		/// Will iterate through all of the points with the same radian as the element in <see cref="shadePoints"/> at index <paramref name="i"/> and set the <paramref name="alphaPoint"/>, <paramref name="prevX"/>, and lastY to the point that has the minimum distance 
 		/// from the origin, and the highest angle between it and its connecting point.  If a valid point is not found, return false and leave alphaPoint, prevX, prevY as they were.
 		/// </summary>
-		/// <param name="alphaPoint">A <see cref="ShadePoint"/> representing an endpoint of the line that was last closest to the origin.  Output parameter.</param>
-		/// <param name="i">The index of the <see cref="ShadePoint"/> we want to check the radians of in the <see cref="shadePoints"> attribute.  Output parameter.</param>
+		/// <param name="chunk">The sector being swept.</param>
+		/// <param name="alphaPoint">The index of an endpoint of the line that was last closest to the origin.  Output parameter.</param>
+		/// <param name="i">The index of the point we want to check the radians of in the <see cref="shadePoints"> attribute.  Output parameter.</param>
 		/// <param name="prevX">The previous collision position with the line created by <paramref name="alphaPoint"/>. Output parameter.</param>
 		/// <param name="prevY">The previous collision position with the line created by <paramref name="alphaPoint"/>. Output parameter.</param>
 		/// <returns><c>true</c> if a valid point was found, <c>false</c> otherwise.</returns>
-		bool getAlphaLineAtRad(CircleShadePoint*& alphaPoint, int& i, float& prevX, float& prevY);
+		bool getAlphaLineAtRad(CircleSweepChunk& chunk, uint32_t& alphaPoint, int& i, float& prevX, float& prevY);
 
 		/// <summary>
-		/// Keeps track of all of the <see cref="CircleShadePoint"/>s that have a line that could be shadow casted to.
+		/// The sectors <see cref="shadePoints"/> are split into by <see cref="createSweepChunks(size_t)"/>.  Each keeps track of the points
+		/// that have a line that could be shadow casted to in its <see cref="CircleSweepChunk::castPoints"/>.
 		/// </summary>		
 		/// <par>
-		/// Constantly added and removed from by <see cref="::updateCastPoints"/> as <see cref="shadePoints"/> are processed by <see cref="::mapShadePoints"/>.
+		/// Constantly added and removed from by <see cref="::updateCastPoints"/> as <see cref="shadePoints"/> are processed by <see cref="::mapSweepChunk"/>.
 		/// Elements in this list should only include lines that can possibly be shadow casted onto by <see cref="::shadowCast">.
 		/// </par>
-		std::unordered_set <CircleShadePoint*> castPoints;
+		std::vector <CircleSweepChunk> sweepChunks;
 		
 		/// <summary>
-		/// Endpoints of <see cref="LightBlocker"/>s.  Populated by <see cref="::createShadePoints"/>.
+		/// Endpoints of <see cref="LightBlocker"/>s.  Populated by <see cref="::createShadePoints"/> and reused every frame, in sweep order once sorted.
 		/// </summary>
-		std::vector <CircleShadePoint*> shadePoints;
-		
+		CircleShadePointBuffer shadePoints;
+
 		/// <summary>
-		/// Stores the x and y of the edges of shadows in the local bitmap.  Populated by <see cref="::mapShadePoints"/>.
+		/// Indices of the <see cref="BlockerLine"/>s of the frame near <c>this</c>, found with the <see cref="BlockerGrid"/> by <see cref="::createShadePoints"/>.
 		/// </summary>
-		std::vector <float> drawPoints;
+		std::vector <uint32_t> nearbyLines;
 
 		/// <summary>
-		/// The color of the light.
+		/// The horizontal position of the first endpoint of each of the <see cref="nearbyLines"/> that faces the light, relative to it.  Clipped to the bounds of the light
+		/// by <see cref="LineClipper::ClipLines"/> or <see cref="LineClipper::ClipLinesToCircle"/> in <see cref="::createShadePoints"/>, which moves the lines that are kept to the front.
 		/// </summary>
-		ALLEGRO_COLOR lightColor;
+		std::vector <float> clipX1;
 
 		/// <summary>
-		/// Bitmap where shadows are drawn to.
+		/// The vertical position of the first endpoint of each line being clipped.  See <see cref="clipX1"/>.
 		/// </summary>
-		ALLEGRO_BITMAP* shadeMap;
-		
+		std::vector <float> clipY1;
+
 		/// <summary>
-		/// Horizontal position of the center of the light on the screen.
+		/// The horizontal position of the second endpoint of each line being clipped.  See <see cref="clipX1"/>.
 		/// </summary>
-		float x;
+		std::vector <float> clipX2;
+
+		/// <summary>
+		/// The vertical position of the second endpoint of each line being clipped.  See <see cref="clipX1"/>.
+		/// </summary>
+		std::vector <float> clipY2;
 		
 		/// <summary>
-		/// Vertical position of the center of the light on the screen.
+		/// The highest <see cref="BlockerSnapshot::blockerVersions"/> of <see cref="nearbyLines"/>.
 		/// </summary>
-		float y;
+		uint64_t nearbyLinesVersion;
+
+		/// <summary>
+		/// The frame of the <see cref="LightLayer"/> <see cref="nearbyLines"/> were last queried for, or <see cref="NO_FRAME"/>.  Lets <see cref="createShadePoints()"/>
+		/// reuse the query <see cref="hasUnchangedInputs()"/> ran in the same frame.  Only accessed by the tasks of the <see cref="LightLayer"/>.
+		/// </summary>
+		uint64_t nearbyLinesFrame;
+
+		/// <summary>
+		/// The position <see cref="createShadePoints()"/> last ran at.  Only accessed by the tasks of the <see cref="LightLayer"/>.
+		/// </summary>
+		float computedX;
+
+		/// <summary>
+		/// The position <see cref="createShadePoints()"/> last ran at.  Only accessed by the tasks of the <see cref="LightLayer"/>.
+		/// </summary>
+		float computedY;
+
+		/// <summary>
+		/// The size of <see cref="nearbyLines"/> when <see cref="createShadePoints()"/> last ran.  If none of the lines near <c>this</c> changed since
+		/// <see cref="computedEpoch"/>, the same count means they are the same lines.
+		/// </summary>
+		size_t computedLines;
+
+		/// <summary>
+		/// The <see cref="BlockerSnapshot::epoch"/> of the blockers <see cref="createShadePoints()"/> last ran with.
+		/// </summary>
+		uint64_t computedEpoch;
+
+		/// <summary>
+		/// The <see cref="CircleFrameSlot::circleBoundSides"/> <see cref="createShadePoints()"/> last ran with.  Only accessed by the tasks of the <see cref="LightLayer"/>.
+		/// </summary>
+		size_t computedCircleBoundSides;
+
+		/// <summary>
+		/// The <see cref="CircleFrameSlot::shadowsFrame"/> last drawn to <see cref="shadeMap"/>, or <see cref="NO_FRAME"/>.
+		/// </summary>
+		uint64_t shadeMapFrame;
+
+		/// <summary>
+		/// Set when something drawn to <see cref="shadeMap"/> other than the shadows changes, like <see cref="lightColor"/>.
+		/// </summary>
+		bool shadeMapDirty;
+
+		/// <summary>
+		/// The position and drawing coordinates for each frame slot.  The slot at <see cref="computeSlot"/> is written by <see cref="::mapShadePoints"/> while the slot at <see cref="drawSlot"/> is drawn.
+		/// </summary>
+		std::vector <CircleFrameSlot> frameSlots;
+
+		/// <summary>
+		/// The color of the light.
+		/// </summary>
+		ALLEGRO_COLOR lightColor;
+
+		/// <summary>
+		/// Bitmap where shadows are drawn to.
+		/// </summary>
+		ALLEGRO_BITMAP* shadeMap;
 		
 		/// <summary>
 		/// The radius of the <c>this</c> <see cref="LightBlocker"/>.
@@ -296,13 +669,18 @@ namespace lighting
 		float radius;
 
 		/// <summary>
-		/// Temporarily stores position of the <see cref="CircleLightSource"/> until <see cref="transferHeldVars()"/> is called, where the values are assigned to <see cref="x"/> and <see cref="y"/>.
+		/// Temporarily stores position of the <see cref="CircleLightSource"/> until <see cref="transferHeldVars(size_t)"/> is called, where the values are assigned to a <see cref="CircleFrameSlot"/>.
 		/// </summary>
 		float heldX;
 		
 		/// <summary>
-		/// Temporarily stores position of the <see cref="CircleLightSource"/> until <see cref="transferHeldVars()"/> is called, where the values are assigned to <see cref="x"/> and <see cref="y"/>.
+		/// Temporarily stores position of the <see cref="CircleLightSource"/> until <see cref="transferHeldVars(size_t)"/> is called, where the values are assigned to a <see cref="CircleFrameSlot"/>.
 		/// </summary>
 		float heldY;
+
+		/// <summary>
+		/// Temporarily stores the number of sides set by <see cref="setCircleBoundSides(size_t)"/> until <see cref="transferHeldVars(size_t)"/> is called, where it is assigned to a <see cref="CircleFrameSlot"/>.
+		/// </summary>
+		size_t heldCircleBoundSides;
 	};
 }
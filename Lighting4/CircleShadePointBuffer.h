@@ -0,0 +1,130 @@
+#pragma once
+#include "ShadePointBuffer.h"
+
+namespace lighting
+{
+	/// <summary>
+	/// The endpoints of the <see cref="LightBlocker"/>s in a <see cref="CircleLightSource"/>, sorted by their angle around the origin (0, 0).
+	/// </summary>
+	/// <para>
+	/// Angles are pseudo angles: the distance walked counterclockwise from the positive x axis around the diamond |x| + |y| = 1, from 0 up to <see cref="FULL_TURN"/>.
+	/// They increase with the real angle, so they sort and compare the same way, but only take a divide to find.
+	/// <see cref="radixVal"/> is the pseudo angle scaled to <see cref="getRadixMaxNum"/>, and is what points are sorted and matched by.
+	/// </para>
+	/// <para>
+	/// The number of bits of <see cref="radixVal"/> is picked once by <see cref="setRadixMaxBits"/>, which also picks the instantiation of
+	/// <see cref="ShadePointBuffer::sortByRadixVal"/> for that width, so a light that needs fewer bits sorts in fewer passes without checking its width while sorting.
+	/// </para>
+	/// <seealso cref="ShadePointBuffer" />
+	class CircleShadePointBuffer : public ShadePointBuffer
+	{
+	public:
+		/// <summary>
+		/// The pseudo angle of a full turn.
+		/// </summary>
+		static const float FULL_TURN;
+
+		/// <summary>
+		/// The pseudo angle of a half turn, between a direction and its opposite.
+		/// </summary>
+		static const float HALF_TURN;
+
+		/// <summary>
+		/// The fewest bits <see cref="radixVal"/> can have, sorted in one 12 bit pass.
+		/// </summary>
+		static const int SMALL_RADIX_BITS = 12;
+
+		/// <summary>
+		/// The middle number of bits <see cref="radixVal"/> can have, sorted in two 8 bit passes.
+		/// </summary>
+		static const int MEDIUM_RADIX_BITS = 16;
+
+		/// <summary>
+		/// The most bits <see cref="radixVal"/> can have, sorted in three 8 bit passes.
+		/// </summary>
+		static const int LARGE_RADIX_BITS = 24;
+
+		/// <summary>
+		/// Initializes a new empty instance of the <see cref="CircleShadePointBuffer"/> class with <see cref="LARGE_RADIX_BITS"/> bit keys.
+		/// </summary>
+		CircleShadePointBuffer();
+
+		/// <summary>
+		/// Sets the number of bits of <see cref="radixVal"/>, rounded up to <see cref="SMALL_RADIX_BITS"/>, <see cref="MEDIUM_RADIX_BITS"/> or <see cref="LARGE_RADIX_BITS"/>.
+		/// Must be set before points are added.
+		/// </summary>
+		/// <param name="maxBits">The fewest bits the keys need.</param>
+		void setRadixMaxBits(int maxBits);
+
+		/// <summary>
+		/// Gets the largest <see cref="radixVal"/>, which stands for a full turn.
+		/// </summary>
+		/// <returns>One less than 2 to the number of bits of the keys.</returns>
+		unsigned int getRadixMaxNum() const
+		{
+			return radixMaxNum;
+		}
+
+		/// <summary>
+		/// Adds the two endpoints of a line, connected to each other, with their <see cref="radixVal"/> set to their pseudo angle.
+		/// </summary>
+		/// <param name="x1">The horizontal position of the first endpoint.</param>
+		/// <param name="y1">The vertical position of the first endpoint.</param>
+		/// <param name="x2">The horizontal position of the second endpoint.</param>
+		/// <param name="y2">The vertical position of the second endpoint.</param>
+		/// <returns>The index of the first endpoint, the second is the one after it.</returns>
+		uint32_t addLine(float x1, float y1, float x2, float y2);
+
+		/// <summary>
+		/// Sorts the points by angle.
+		/// </summary>
+		void sort();
+
+		/// <summary>
+		/// Gets the pseudo angle of a point, its <see cref="radixVal"/> converted back.
+		/// </summary>
+		/// <param name="pointI">The index of the point.</param>
+		/// <returns>The pseudo angle of the point when rotated around origin (0, 0).</returns>
+		float getAngle(uint32_t pointI) const;
+
+		/// <summary>
+		/// Gets the pseudo angle of the direction from origin (0, 0) to a position.
+		/// </summary>
+		/// <param name="x">The horizontal position.</param>
+		/// <param name="y">The vertical position.</param>
+		/// <returns>The pseudo angle, <c>0</c> for the origin itself.</returns>
+		static double GetPseudoAngle(double x, double y);
+
+		/// <summary>
+		/// Gets the unit vector pointing at a pseudo angle, without trigonometry.
+		/// </summary>
+		/// <param name="angle">The pseudo angle, from 0 to <see cref="FULL_TURN"/>.</param>
+		/// <param name="dirX">Output parameter of the horizontal part of the vector.</param>
+		/// <param name="dirY">Output parameter of the vertical part of the vector.</param>
+		static void GetDirection(float angle, float& dirX, float& dirY);
+
+	private:
+		/// <summary>
+		/// Finds the integer value representing the pseudo angle of a point at the precision of <see cref="radixMaxNum"/>.
+		/// </summary>
+		/// <param name="x">The horizontal position of the point.</param>
+		/// <param name="y">The vertical position of the point.</param>
+		/// <returns>The sort key of the point.</returns>
+		unsigned int getRadixVal(float x, float y) const;
+
+		/// <summary>
+		/// The largest <see cref="radixVal"/>, which stands for <see cref="FULL_TURN"/>.
+		/// </summary>
+		unsigned int radixMaxNum;
+
+		/// <summary>
+		/// What a pseudo angle is multiplied by to get its <see cref="radixVal"/>.
+		/// </summary>
+		double radixScale;
+
+		/// <summary>
+		/// The instantiation of <see cref="ShadePointBuffer::sortByRadixVal"/> for the number of bits of the keys.
+		/// </summary>
+		void (ShadePointBuffer::*sortPoints)();
+	};
+}
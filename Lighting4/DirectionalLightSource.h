@@ -44,6 +44,7 @@ namespace lighting
 		void setDegs(float degs)
 		{
 			rads = (degs * (M_PI / 180));
+			shadeMapDirty = true;
 		}
 		
 		/// <summary>
@@ -53,6 +54,7 @@ namespace lighting
 		void changeDegs(float deltaDegs)
 		{
 			rads += deltaDegs * (M_PI / 180);
+			shadeMapDirty = true;
 		}
 		
 		/// <summary>
@@ -62,6 +64,7 @@ namespace lighting
 		void setRads(float rads)
 		{
 			this->rads = rads;
+			shadeMapDirty = true;
 		}
 		
 		/// <summary>
@@ -71,6 +74,7 @@ namespace lighting
 		void changeRads(float deltaRads)
 		{
 			this->rads += deltaRads;
+			shadeMapDirty = true;
 		}
 
 		virtual ~DirectionalLightSource();
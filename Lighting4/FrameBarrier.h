@@ -0,0 +1,97 @@
+#pragma once
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+namespace lighting
+{
+	/// <summary>
+	/// Counts the <see cref="LightSource"/>s of the frames of a <see cref="LightLayer"/> as they are processed.  Frames are processed one after another,
+	/// the tasks submitted to the <see cref="LightExecutor"/> arrive here and the main thread sleeps on <see cref="processedCondition"/> until the frame it
+	/// is waiting for has been processed.
+	/// </summary>
+	class FrameBarrier
+	{
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="FrameBarrier"/> class with no frame processed.
+		/// </summary>
+		FrameBarrier();
+
+		/// <summary>
+		/// Starts processing the next frame by resetting the arrival counter.  The previous frame must have been processed.
+		/// </summary>
+		/// <param name="lightSources">The number of <see cref="LightSource"/>s that will call <see cref="arriveProcessed()"/> this frame.</param>
+		void beginFrame(size_t lightSources);
+
+		/// <summary>
+		/// Called each time a <see cref="LightSource"/> has mapped its shade points for the current frame.
+		/// </summary>
+		/// <returns><c>true</c> for the last <see cref="LightSource"/> of the frame, whose caller must then call <see cref="endFrame()"/>.</returns>
+		bool arriveProcessed();
+
+		/// <summary>
+		/// Marks the current frame as processed and wakes the threads in <see cref="waitProcessed(uint64_t)"/>.  Separate from <see cref="arriveProcessed()"/>
+		/// so the last <see cref="LightSource"/> can finish its work for the frame before anyone is woken.
+		/// </summary>
+		void endFrame();
+
+		/// <summary>
+		/// Blocks until the frame at <paramref name="frame"/> has been processed.  Frames are numbered from 0 in the order they are begun.
+		/// </summary>
+		/// <param name="frame">The number of the frame to wait for.</param>
+		void waitProcessed(uint64_t frame);
+
+		/// <summary>
+		/// Checks if the frame at <paramref name="frame"/> has been processed without blocking.
+		/// </summary>
+		/// <param name="frame">The number of the frame to check.</param>
+		/// <returns><c>true</c> if <see cref="waitProcessed(uint64_t)"/> would return immediately.</returns>
+		bool isProcessed(uint64_t frame);
+
+		/// <summary>
+		/// Accessor for <see cref="lastFrameNanos"/>.
+		/// </summary>
+		/// <returns>Nanoseconds between the last processed frame being begun and the last light arriving.</returns>
+		uint64_t getLastFrameNanos();
+
+	private:
+		typedef std::chrono::steady_clock Clock;
+
+		/// <summary>
+		/// Guards every other data member.
+		/// </summary>
+		std::mutex barrierMutex;
+
+		/// <summary>
+		/// The main thread waits on this for frames to be processed.
+		/// </summary>
+		std::condition_variable processedCondition;
+
+		/// <summary>
+		/// The number of <see cref="LightSource"/>s expected to arrive this frame.
+		/// </summary>
+		size_t lightSources;
+
+		/// <summary>
+		/// The number of <see cref="LightSource"/>s that called <see cref="arriveProcessed()"/> this frame.
+		/// </summary>
+		size_t processedCount;
+
+		/// <summary>
+		/// The number of frames that have been processed.  Incremented by <see cref="endFrame()"/>.
+		/// </summary>
+		uint64_t processedFrames;
+
+		/// <summary>
+		/// The time the current frame was begun.
+		/// </summary>
+		Clock::time_point frameBeginTime;
+
+		/// <summary>
+		/// Set when the last light arrives in <see cref="arriveProcessed()"/>.
+		/// </summary>
+		uint64_t lastFrameNanos;
+	};
+}
@@ -1,27 +1,75 @@
 #pragma once
+#include <cstdint>
 
 namespace lighting
 {	
+	class LightLayer;
+
+	/// <summary>
+	/// The global endpoints of a <see cref="LightBlocker"/> copied when a frame is detached, so the frame is processed from values the main thread can't modify.
+	/// </summary>
+	struct BlockerLine
+	{
+		/// <summary>
+		/// The horizontal position of the first endpoint.
+		/// </summary>
+		float x1;
+
+		/// <summary>
+		/// The vertical position of the first endpoint.
+		/// </summary>
+		float y1;
+
+		/// <summary>
+		/// The horizontal position of the second endpoint.
+		/// </summary>
+		float x2;
+
+		/// <summary>
+		/// The vertical position of the second endpoint.
+		/// </summary>
+		float y2;
+	};
+
+	/// <summary>
+	/// Identifies a <see cref="LightBlocker"/> in a <see cref="BlockerSlotMap"/>.  Stays valid while other blockers are added and removed,
+	/// and stops matching once its own blocker is removed, even if the slot is reused.
+	/// </summary>
+	struct BlockerHandle
+	{
+		/// <summary>
+		/// The index of the slot.
+		/// </summary>
+		uint32_t index;
+
+		/// <summary>
+		/// The generation of the slot when the handle was created.
+		/// </summary>
+		uint32_t generation;
+	};
+
 	/// <summary>
-	/// Represents a line that will be used by <see cref="LightSource">s to determine if their rays are being blocked.
+	/// Represents a line that will be used by <see cref="LightSource">s to determine if their rays are being blocked.  The values are stored in the <see cref="BlockerSlotMap"/>
+	/// of the <see cref="owner"/>, <c>this</c> only keeps the <see cref="BlockerHandle"/> to them.
 	/// </summary>
 	class LightBlocker
 	{
 	public:		
 		/// <summary>
 		/// Initializes a new instance of the <see cref="LightBlocker"/> class.  Specifying the <paramref name="x"/> and <paramref name="y"/> of the line and the offset of the endpoints from <paramref name="x"/> and <paramref name="y"/>.
+		/// Adds itself to <paramref name="owner"/>.
 		/// </summary>
+		/// <param name="owner">The <see cref="LightLayer"/> that stores the line.</param>
 		/// <param name="x">The horizontal postion of the line.</param>
 		/// <param name="y">The vertical position of the line.</param>
-		/// <param name="epX1">The horizontal displacement of the first endpoint from <paramref name="x"/>. Sets <see cref="epX1"/>.</param>
-		/// <param name="epY1">The vertical displacement of the first endpoint from <paramref name="y"/>. Sets <see cref="epY1"/>.</param>
-		/// <param name="epX2">The horizontal displacement of the second endpoint from <paramref name="x"/>. Sets <see cref="epX2"/>.</param>
-		/// <param name="epY2">The vertical displacement of the second endpoint from <paramref name="x"/>. Sets <see cref="epY2"/>.</param>
-		LightBlocker(float x, float y, float epX1, float epY1, float epX2, float epY2);
+		/// <param name="epX1">The horizontal displacement of the first endpoint from <paramref name="x"/>.</param>
+		/// <param name="epY1">The vertical displacement of the first endpoint from <paramref name="y"/>.</param>
+		/// <param name="epX2">The horizontal displacement of the second endpoint from <paramref name="x"/>.</param>
+		/// <param name="epY2">The vertical displacement of the second endpoint from <paramref name="x"/>.</param>
+		LightBlocker(LightLayer* owner, float x, float y, float epX1, float epY1, float epX2, float epY2);
 
-		
 		/// <summary>
-		/// Sets the location of the line.  Modifies attributes <see cref="x1"/>, <see cref="y1"/> and <see cref="x2"/>, <see cref="y2">.
+		/// Sets the location of the line.  Modifies the endpoints stored in the <see cref="owner"/>.
 		/// </summary>
 		/// <param name="x">The horizontal position.</param>
 		/// <param name="y">The vertical position.</param>
@@ -29,76 +77,66 @@ namespace lighting
 
 		/// <summary>
 		/// Rotates the endpoints around <paramref name="cX"/> and <paramref name="cY"/>.  
-		/// The change in coordinates from the rotation are stored in <see cref="rotateXOff1"/>, <see cref="rotateYOff1"/> and <see cref="rotateXOff2"/>, <see cref="rotateYOff2"/>.
+		/// The change in coordinates from the rotation are stored in the rotate offsets of the <see cref="BlockerOffsets"/>.
 		/// </summary>
 		/// <param name="cX">The horizontal displacement from <see cref="x"/> to rotate around.</param>
 		/// <param name="cY">The vertical displacement from <see cref="y"/> to rotate around.</param>
 		/// <param name="rads">The rads.</param>
 		void setRads(float cX, float cY, float rads);
-		
-		/// <summary>
-		/// Horizontal position of first endpoint on the screen.
-		/// </summary>
-		float x1;
 
 		/// <summary>
-		/// Vertical position of first endpoint on the screen.
-		/// </summary>
-		float y1;
-		
-		/// <summary>
-		/// Horizontal position of the second endpoint on the screen.
+		/// Gets the endpoints of the line on the screen.
 		/// </summary>
-		float x2;
-		
-		/// <summary>
-		/// Vertical position of the second endpoint on the screen.
-		/// </summary>
-		float y2;
-		
+		/// <returns>A copy of the endpoints.</returns>
+		BlockerLine getLine();
+
 		/// <summary>
-		/// The displacement between x and the endpointX
+		/// Gets the horizontal displacement of the first endpoint from the position.
 		/// </summary>
-		float epX1;
+		/// <returns>The offset given to the constructor.</returns>
+		float getEpX1();
 
 		/// <summary>
-		/// The displacement between y and the endpointY
+		/// Gets the vertical displacement of the first endpoint from the position.
 		/// </summary>
-		float epY1;
+		/// <returns>The offset given to the constructor.</returns>
+		float getEpY1();
 
 		/// <summary>
-		/// The displacement between x and the endpointX
+		/// Gets the horizontal displacement of the second endpoint from the position.
 		/// </summary>
-		float epX2;
+		/// <returns>The offset given to the constructor.</returns>
+		float getEpX2();
 
 		/// <summary>
-		/// The displacement between y and the endpointY
+		/// Gets the vertical displacement of the second endpoint from the position.
 		/// </summary>
-		float epY2;
+		/// <returns>The offset given to the constructor.</returns>
+		float getEpY2();
 
 		/// <summary>
-		/// The horizontal displacement of the first endpoint due to rotation, set by <see cref="setRads()"/>.
+		/// Accessor for <see cref="handle"/>.
 		/// </summary>
-		float rotateXOff1;
+		/// <returns>The handle of the line in the <see cref="BlockerSlotMap"/> of the <see cref="owner"/>.</returns>
+		BlockerHandle getHandle()
+		{
+			return handle;
+		}
 		
 		/// <summary>
-		/// The vertical displacement of the first endpoint due to rotation, set by <see cref="setRads()"/>.
+		/// Finalizes an instance of the <see cref="LightBlocker"/> class.  Removes itself from <see cref="owner"/>.
 		/// </summary>
-		float rotateYOff1;
+		~LightBlocker();
 
+	private:
 		/// <summary>
-		/// The horizontal displacement of the second endpoint due to rotation, set by <see cref="setRads()"/>.
+		/// The <see cref="LightLayer"/> that stores the line.
 		/// </summary>
-		float rotateXOff2;
+		LightLayer* owner;
 
 		/// <summary>
-		/// The vertical displacement of the second endpoint due to rotation, set by <see cref="setRads()"/>.
-		/// </summary>
-		float rotateYOff2;
-		
-		/// <summary>
-		/// Finalizes an instance of the <see cref="LightBlocker"/> class.  Default destructor.
+		/// Where the line is stored in the <see cref="owner"/>.
 		/// </summary>
-		~LightBlocker();
+		BlockerHandle handle;
 	};
 }
@@ -1,5 +1,5 @@
 #pragma once
-#include <list>
+#include <vector>
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include "LightBlocker.h"
@@ -9,7 +9,8 @@ namespace lighting
 	class LightLayer;
 	
 	/// <summary>
-	/// Contains related <see cref="LightBlocker"/>s, such as the lines that make up a shape.  Handles adding and removing from <see cref="LightMap"/>.
+	/// Contains related lines that block light, such as the lines that make up a shape.  Handles adding and removing from <see cref="LightMap"/>.  The lines are stored by the
+	/// <see cref="owner"/> and <c>this</c> keeps their <see cref="BlockerHandle"/>s, so adding many lines is one batch instead of a <see cref="LightBlocker"/> each.
 	/// </summary>
 	class LightBlockerContainer
 	{
@@ -17,18 +18,18 @@ namespace lighting
 		/// <summary>
 		/// Initializes a new instance of the <see cref="LightBlockerContainer"/> class.
 		/// </summary>
-		/// <param name="ownerLightLayer">Value to set <see cref="owner"/> to.  Represents the <see cref="LightLayer"/> the <see cref="LightBlocker"/>s will belong to.</param>
+		/// <param name="ownerLightLayer">Value to set <see cref="owner"/> to.  Represents the <see cref="LightLayer"/> the lines will belong to.</param>
 		LightBlockerContainer(LightLayer* ownerLightLayer);
 				
 		/// <summary>
-		/// Sets the xy of all elements of <see cref="lightBlockers"/>.
+		/// Sets the xy of all lines of <see cref="blockerHandles"/>.
 		/// </summary>
 		/// <param name="x">The x.</param>
 		/// <param name="y">The y.</param>
 		void setXY(float x, float y);
 
 		/// <summary>
-		/// Adds a <see cref="LightBlocker"/> with the specified endpoints.
+		/// Adds a line with the specified endpoints.
 		/// </summary>
 		/// <param name="x1">The x1.</param>
 		/// <param name="y1">The y1.</param>
@@ -37,14 +38,29 @@ namespace lighting
 		void addLine(float x1, float y1, float x2, float y2);
 
 		/// <summary>
-		/// Creates four <see cref="LightBlocker"/>s in the shape of a rectangle, the top left corner of the rectangle is at <see cref="x"/> and <see cref="y"/>.
+		/// Adds <paramref name="numLines"/> lines in one batch.
+		/// </summary>
+		/// <param name="lines">The endpoints of the lines relative to the position of <c>this</c>.</param>
+		/// <param name="numLines">The number of elements of <paramref name="lines"/>.</param>
+		/// <param name="oneSided">If the lines only block light from one side, see <see cref="LightLayer::addLightBlockers"/>.</param>
+		void addLines(const BlockerLine* lines, size_t numLines, bool oneSided = false);
+
+		/// <summary>
+		/// Creates four lines in the shape of a rectangle, the top left corner of the rectangle is at <see cref="x"/> and <see cref="y"/>.
 		/// </summary>
 		/// <param name="w">The w.</param>
 		/// <param name="h">The h.</param>
 		void initSquare(float w, float h);
+
+		/// <summary>
+		/// Creates a solid closed polygon whose corners are <paramref name="vertices"/>.  Each edge only blocks light
+		/// from outside the polygon, so a <see cref="CircleLightSource"/> drops the edges facing away from it, and a light inside the polygon is not blocked by it.
+		/// </summary>
+		/// <param name="vertices">The x and y of each corner relative to <see cref="x"/> and <see cref="y"/>, in either winding order.  The polygon should not intersect itself.</param>
+		void initPolygon(const std::vector <float>& vertices);
 		
 		/// <summary>
-		/// Increments <see cref="rads"/> by <paramref name="deltaDegs"/> and rotates all elements in <see cref="lightBlockers"/>.
+		/// Increments <see cref="rads"/> by <paramref name="deltaDegs"/> and rotates all lines of <see cref="blockerHandles"/>.
 		/// </summary>
 		/// <param name="deltaDegs">The amount of degrees to rotate by.</param>
 		void changeDegs(float deltaDegs)
@@ -54,7 +70,7 @@ namespace lighting
 		}
 
 		/// <summary>
-		/// Set <see cref="rads"/> to the converted valie of <paramref name="degs"/> and rotates all elements in <see cref="lightBlockers"/>.
+		/// Set <see cref="rads"/> to the converted valie of <paramref name="degs"/> and rotates all lines of <see cref="blockerHandles"/>.
 		/// </summary>
 		/// <param name="degs">The angle to set <see cref="rads"/> to.</param>
 		void setDegs(float degs)
@@ -64,7 +80,7 @@ namespace lighting
 		}
 
 		/// <summary>
-		/// Increments <see cref="rads"/> by the value of the parameter <paramref name="rads"/> and rotates all elements in <see cref="lightBlockers"/>.
+		/// Increments <see cref="rads"/> by the value of the parameter <paramref name="rads"/> and rotates all lines of <see cref="blockerHandles"/>.
 		/// </summary>
 		/// <param name="deltaRads">The amount of radians to rotate by.</param>
 		void changeRads(float deltaRads)
@@ -74,7 +90,7 @@ namespace lighting
 		}
 
 		/// <summary>
-		/// Set <see cref="rads"/> data member to the converted value of <paramref name="rads"/> and rotates all elements in <see cref="lightBlockers"/>.
+		/// Set <see cref="rads"/> data member to the converted value of <paramref name="rads"/> and rotates all lines of <see cref="blockerHandles"/>.
 		/// </summary>
 		/// <param name="rads">The angle to set <see cref="rads"/> to.</param>
 		void setRads(float rads)
@@ -95,49 +111,45 @@ namespace lighting
 		}
 		
 		/// <summary>
-		/// Sets attributes <see cref="cX"/> and <see cref="cY"/> to the center of the <see cref="lightBlockers"/>.
+		/// Sets attributes <see cref="cX"/> and <see cref="cY"/> to the center of the lines of <see cref="blockerHandles"/>.
 		/// </summary>
 		void setCXYToCenter();
 
 		/// <summary>
-		/// Finalizes an instance of the <see cref="LightBlockerContainer"/> class.  Removes all elements of <see cref="lightBlockers"/> from the <see cref="owner"/>.
+		/// Finalizes an instance of the <see cref="LightBlockerContainer"/> class.  Removes all lines of <see cref="blockerHandles"/> from the <see cref="owner"/>.
 		/// </summary>
 		~LightBlockerContainer();
 
 	private:
 				
 		/// <summary>
-		/// Sets elements of <see cref="lightBlockers"/> to the angle <see cref="rads"/>.
+		/// Sets the lines of <see cref="blockerHandles"/> to the angle <see cref="rads"/>.
 		/// </summary>
-		void setLightBlockerRads()
-		{
-			for (auto it = lightBlockers.begin(); it != lightBlockers.end(); it++)
-			{
-				(*it)->setRads(rads, cX, cY);
-			}
-		}
+		void setLightBlockerRads();
+
 		/// <summary>
-		/// The <see cref="LightBlocker"/>s created by <c>this</c>.  Should form a shape.
+		/// The handles of the lines created by <c>this</c>.  Should form a shape.
 		/// </summary>
-		std::list <LightBlocker*> lightBlockers;
+		std::vector <BlockerHandle> blockerHandles;
+
 				
 		/// <summary>
-		/// The <see cref="LightLayer"/> that the <see cref="lightBlockers"/> are added and removed from.
+		/// The <see cref="LightLayer"/> that the lines of <see cref="blockerHandles"/> are added and removed from.
 		/// </summary>
 		LightLayer* owner;
 
 		/// <summary>
-		/// Coordinates of the <see cref="lightBlockers"/> on the screen.
+		/// Coordinates of the lines on the screen.
 		/// </summary>
 		float x, y;
 		
 		/// <summary>
-		/// Coordinates to rotate <see cref="lightBlockers"/> around.
+		/// Coordinates to rotate the lines around.
 		/// </summary>
 		float cX, cY;
 		
 		/// <summary>
-		/// The angle of the <see cref="lightBlockers"/>.
+		/// The angle of the lines.
 		/// </summary>
 		float rads;
 	};
@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <cstddef>
+
+namespace lighting
+{
+	/// <summary>
+	/// An element of a <see cref="LightCommandQueue"/>.
+	/// </summary>
+	struct LightCommandNode
+	{
+		/// <summary>
+		/// The node pushed after this one, <c>nullptr</c> until its producer links it.
+		/// </summary>
+		std::atomic<LightCommandNode*> next;
+
+		/// <summary>
+		/// The mutation to apply.
+		/// </summary>
+		std::function<void()> command;
+	};
+
+	/// <summary>
+	/// A lock-free multi-producer single-consumer queue of mutations to <see cref="LightSource"/>s and <see cref="LightBlocker"/>s.
+	/// Any thread can <see cref="push"/> while the thread that owns the <see cref="LightLayer"/> applies them in a batch at the frame boundary.
+	/// </summary>
+	/// <para>
+	/// Producers swap themselves in as the <see cref="head"/> with a single atomic exchange and then link the previous head to their node, so pushing never waits on another thread.
+	/// The consumer owns <see cref="tail"/> and uses <see cref="stub"/> so the queue is never empty.  A command whose producer has not linked it yet is left for the next batch.
+	/// </para>
+	class LightCommandQueue
+	{
+	public:
+		/// <summary>
+		/// Initializes a new empty instance of the <see cref="LightCommandQueue"/> class.
+		/// </summary>
+		LightCommandQueue();
+
+		/// <summary>
+		/// Queues <paramref name="command"/>.  Safe to call from any thread.
+		/// </summary>
+		/// <param name="command">The mutation to apply.</param>
+		void push(std::function<void()> command);
+
+		/// <summary>
+		/// Runs every command pushed so far in the order they were pushed.  Must only be called by one thread at a time.
+		/// </summary>
+		/// <returns>The number of commands run.</returns>
+		size_t applyAll();
+
+		/// <summary>
+		/// Finalizes an instance of the <see cref="LightCommandQueue"/> class.  Deletes the commands that were never applied.
+		/// </summary>
+		~LightCommandQueue();
+
+	private:
+		/// <summary>
+		/// Takes the oldest linked command.  Only called by the consumer.
+		/// </summary>
+		/// <param name="command">Output parameter, set to the command.</param>
+		/// <returns><c>false</c> if there is no command or the oldest one is still being linked.</returns>
+		bool pop(std::function<void()>& command);
+
+		/// <summary>
+		/// Links <paramref name="node"/> after the current <see cref="head"/>.
+		/// </summary>
+		/// <param name="node">The node to push.</param>
+		void pushNode(LightCommandNode* node);
+
+		/// <summary>
+		/// The last node pushed.  Exchanged by every producer.
+		/// </summary>
+		std::atomic<LightCommandNode*> head;
+
+		/// <summary>
+		/// The oldest node that has not been popped.  Only accessed by the consumer.
+		/// </summary>
+		LightCommandNode* tail;
+
+		/// <summary>
+		/// Placeholder node that is pushed whenever the consumer reaches the last node, so that node can be deleted.
+		/// </summary>
+		LightCommandNode stub;
+	};
+}
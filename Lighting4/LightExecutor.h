@@ -0,0 +1,45 @@
+#pragma once
+#include <functional>
+#include <cstddef>
+
+namespace lighting
+{
+	/// <summary>
+	/// Runs the tasks of <see cref="LightLayer"/>s.  The default implementation is the process-wide <see cref="LightThreadPool::GetShared()"/>,
+	/// implement this to submit the work of Lighting4 to the job system of the host engine instead.
+	/// </summary>
+	class LightExecutor
+	{
+	public:
+		/// <summary>
+		/// Queues <paramref name="task"/> to be run on any thread.  Must be safe to call from any thread, including from inside a task.
+		/// The <see cref="LightLayer"/> tracks completion itself, so <paramref name="task"/> only has to be called exactly once.
+		/// </summary>
+		/// <param name="task">The task to run.</param>
+		virtual void submit(std::function<void()> task) = 0;
+
+		/// <summary>
+		/// Gets the number of tasks that can run at the same time.  Used to decide how finely work is split.
+		/// </summary>
+		/// <returns>The number of threads tasks are run on.</returns>
+		virtual size_t getConcurrency() = 0;
+
+		/// <summary>
+		/// Runs one queued task on the calling thread.  Called by the <see cref="LightLayer"/> while it waits for a frame so the waiting thread processes lights
+		/// instead of sleeping.  The default runs nothing.
+		/// </summary>
+		/// <returns><c>true</c> if a task was run, <c>false</c> if none were queued.</returns>
+		virtual bool runPendingTask()
+		{
+			return false;
+		}
+
+		/// <summary>
+		/// Finalizes an instance of the <see cref="LightExecutor"/> class.
+		/// </summary>
+		virtual ~LightExecutor()
+		{
+
+		}
+	};
+}
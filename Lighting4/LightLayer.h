@@ -2,15 +2,116 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <list>
-#include <queue>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <future>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <chrono>
 #include <allegro5/bitmap.h>
 #include "AboveLightBlocker.h"
 #include "LightBlocker.h"
+#include "BlockerGrid.h"
+#include "BlockerSlotMap.h"
+#include "BlockerSimplifier.h"
+#include "FrameBarrier.h"
+#include "LightExecutor.h"
+#include "LightCommandQueue.h"
 
 namespace lighting
 {
-	class LightRunnable;
 	class GaussianBlurrer;
+	class LightSource;
+
+	/// <summary>
+	/// A <see cref="LightSource"/> captured for a frame along with the maximum number of chunks its sweep may be split into.
+	/// </summary>
+	struct FrameLightSource
+	{
+		/// <summary>
+		/// The <see cref="LightSource"/> to process.
+		/// </summary>
+		LightSource* lightSource;
+
+		/// <summary>
+		/// The maximum number of chunks the sweep of <see cref="lightSource"/> is split into this frame.
+		/// </summary>
+		size_t maxSweepChunks;
+	};
+
+	/// <summary>
+	/// A read-only copy of the <see cref="LightBlocker"/>s of a <see cref="LightLayer"/>.  Frames detached while no blocker changed share the same snapshot.
+	/// </summary>
+	struct BlockerSnapshot
+	{
+		/// <summary>
+		/// The <see cref="BlockerSlotMap::getEpoch()"/> the snapshot was copied at.
+		/// </summary>
+		uint64_t epoch;
+
+		/// <summary>
+		/// The cell size <see cref="blockerGrid"/> was built with.
+		/// </summary>
+		float gridCellSize;
+
+		/// <summary>
+		/// A copy of the endpoints of every <see cref="LightBlocker"/>.
+		/// </summary>
+		std::vector <BlockerLine> blockerLines;
+
+		/// <summary>
+		/// The <see cref="epoch"/> each element of <see cref="blockerLines"/> last changed at, so a <see cref="LightSource"/> can tell if the lines near it moved.
+		/// </summary>
+		std::vector <uint64_t> blockerVersions;
+
+		/// <summary>
+		/// Nonzero for the elements of <see cref="blockerLines"/> that only block light from one side, see <see cref="BlockerSlotMap::getOneSided()"/>.
+		/// </summary>
+		std::vector <uint8_t> blockerOneSided;
+
+		/// <summary>
+		/// Index over <see cref="blockerLines"/> so each <see cref="LightSource"/> only visits the lines near it.
+		/// </summary>
+		BlockerGrid blockerGrid;
+	};
+
+	/// <summary>
+	/// Everything a frame is processed from.  Captured by <see cref="LightLayer::detach()"/> so the main thread can keep modifying the layer while the frame is processed.
+	/// </summary>
+	struct LayerFrame
+	{
+		/// <summary>
+		/// The <see cref="LightSource"/>s of the frame.
+		/// </summary>
+		std::vector <FrameLightSource> lightSources;
+
+		/// <summary>
+		/// The value of <see cref="LightLayer::frameBudgetNanos"/> when the frame was detached.
+		/// </summary>
+		uint64_t frameBudgetNanos;
+
+		/// <summary>
+		/// The <see cref="LightBlocker"/>s of the layer when the frame was detached.
+		/// </summary>
+		std::shared_ptr <const BlockerSnapshot> blockers;
+
+		/// <summary>
+		/// A copy of every <see cref="AboveLightBlocker"/> of the layer.
+		/// </summary>
+		std::vector <AboveBlockerLine> aboveBlockerLines;
+
+		/// <summary>
+		/// Set when the frame was detached by <see cref="LightLayer::detachAsync"/>, fulfilled once the shadows of the frame are processed.
+		/// </summary>
+		std::unique_ptr <std::promise<void>> processedPromise;
+
+		/// <summary>
+		/// Called on the thread of the last task of the frame once the shadows are processed, can be empty.
+		/// </summary>
+		std::function<void()> processedCallback;
+	};
 
 	/// <summary>
 	/// The core of the lighting system.  Holds all <see cref="LightSource" />s and LightBlockers, handles drawing operations, and manages threads.
@@ -19,6 +120,8 @@ namespace lighting
 	{
 		friend class AboveLightBlocker;
 		friend class AboveLightSource;
+		friend class LightBlocker;
+		friend class LightBlockerContainer;
 		friend class CircleLightSource;
 		friend class LightSource;
 		friend class GaussianBlurrer;
@@ -26,40 +129,80 @@ namespace lighting
 	public:
 		static const int MAX_THREAD_TO_CORES = 0;
 
+		/// <summary>
+		/// Value for <see cref="setFrameBudget(uint64_t)"/> to process every <see cref="LightSource"/> each frame.
+		/// </summary>
+		static const uint64_t NO_FRAME_BUDGET = 0;
+
 		/// <summary>
 		/// Initializes a new instance of the <see cref="LightLayer"/> class.  
 		/// </summary>
 		/// <param name="drawToBmpW">The draw to BMP w.</param>
 		/// <param name="drawToBmpH">The draw to BMP h.</param>
 		/// <param name="lightBmpScale">The light BMP scale.</param>
-		/// <param name="maxThreads">The maximum threads. Default will set this to number of cores on computer.</param>
+		/// <param name="maxThreads">The maximum threads. Default will share <see cref="LightThreadPool::GetShared()"/>, which has a thread for each core on the computer.
+		/// Any other value creates a <see cref="LightThreadPool"/> with that many threads owned by this layer.</param>
 		LightLayer(int drawToBmpW, int drawToBmpH, double lightBmpScale, size_t maxThreads = MAX_THREAD_TO_CORES);
+
+		/// <summary>
+		/// Initializes a new instance of the <see cref="LightLayer"/> class that runs its tasks on <paramref name="executor"/>, such as an adapter to the job system of the host engine.
+		/// </summary>
+		/// <param name="drawToBmpW">The draw to BMP w.</param>
+		/// <param name="drawToBmpH">The draw to BMP h.</param>
+		/// <param name="lightBmpScale">The light BMP scale.</param>
+		/// <param name="executor">Runs the tasks of the layer.  Not owned, must outlive the layer.</param>
+		LightLayer(int drawToBmpW, int drawToBmpH, double lightBmpScale, LightExecutor& executor);
 				
 		/// <summary>
-		/// Detaches all elements of <see cref="lightRunnables"/> to process <see cref="LightSource"/>s.
+		/// Captures the <see cref="LightSource"/>s and <see cref="LightBlocker"/>s into the next element of <see cref="frames"/> and queues it to be processed
+		/// by the <see cref="executor"/>.  Only blocks if the frame that last used that element is still being processed.
 		/// Attributes such as location and angle of <see cref="LightSource"/>s and <see cref="LightBlocker"/>s should be set before called
-		/// or you will have to wait until the next call to detach before they are implemented.
+		/// or you will have to wait until the next call to detach before they are implemented.  Commands queued by <see cref="queueCommand"/> are applied first.
 		/// </summary>
 		void detach();
+
+		/// <summary>
+		/// Queues <paramref name="command"/> to be run on the thread that calls <see cref="detach()"/>, before the next frame is captured.  Safe to call from any thread without a lock,
+		/// so other threads can move, recolor, add and remove <see cref="LightSource"/>s and <see cref="LightBlocker"/>s through it instead of touching them directly.
+		/// </summary>
+		/// <param name="command">The mutation to apply.  Commands are run in the order they were queued.</param>
+		void queueCommand(std::function<void()> command)
+		{
+			commandQueue.push(std::move(command));
+		}
+
+		/// <summary>
+		/// Same as <see cref="detach()"/> but gives a way to be told when the shadows of the frame are ready, so the main thread can do its own work
+		/// while they are processed and only block in <see cref="draw()"/>.
+		/// </summary>
+		/// <param name="onShadowsProcessed">Called once the shadows of the frame are processed, on the thread of the last task of the frame.  It must be quick and may not call
+		/// into <c>this</c>.  Can be empty.</param>
+		/// <returns>A future that becomes ready when the shadows of the frame are processed.  <see cref="draw()"/> only composites the frame once <see cref="pipelineDepth"/> more frames have been detached.</returns>
+		std::shared_future<void> detachAsync(std::function<void()> onShadowsProcessed = nullptr);
 		
 		/// <summary>
-		/// Draws all of the <see cref="LightSource"/>s to the <see cref="lightMap"/> after all elements in <see cref="lightRunnables"/> have finished
-		/// processing shadows.  Gaussian blurs will be applied to the map and everything will be drawn to the display.
+		/// Runs the queued light tasks on the calling thread, then sleeps on the <see cref="frameBarrier"/> until the frame detached <see cref="pipelineDepth"/> calls to <see cref="detach()"/> ago has been processed, then draws
+		/// the results of that frame for all of the <see cref="LightSource"/>s to the <see cref="lightMap"/>.  Gaussian blurs will be applied to the map and everything will be drawn to the display.
 		/// </summary>
 		void draw();
-		
+
 		/// <summary>
-		/// Adds <paramref name="lightBlocker"/> to <see cref="lightBlockers"/> and saves its location in that list in <see cref="lightBlockerTrackerMap"/>.
+		/// Sets how many frames the shadows drawn by <see cref="draw()"/> lag behind the last <see cref="detach()"/>.  With a depth of 0, <see cref="draw()"/> waits for
+		/// the frame that was just detached.  With a depth of 1 or more the workers process the next frames while the main thread draws, at the cost of that many frames
+		/// of latency.  Waits for every detached frame to be processed, and <see cref="LightSource"/>s are not drawn until the pipeline is full again.
 		/// </summary>
-		/// <param name="lightBlocker">The <see cref="LightBlocker"/> to be added.</param>
-		void addLightBlocker(LightBlocker* lightBlocker);
-		
+		/// <param name="pipelineDepth">The number of frames.  Default is 0.</param>
+		void setPipelineDepth(size_t pipelineDepth);
+
 		/// <summary>
-		/// Removes <paramref name="lightBlocker"/> from <see cref="lightBlockers"/> using its location from <see cref="lightBlockerTrackerMap"/>.
+		/// Accessor for <see cref="pipelineDepth"/>.
 		/// </summary>
-		/// <param name="lightBlocker">The light blocker.</param>
-		void removeLightBlocker(LightBlocker* lightBlocker);
-				
+		/// <returns>How many frames <see cref="draw()"/> lags behind <see cref="detach()"/>.</returns>
+		size_t getPipelineDepth()
+		{
+			return pipelineDepth;
+		}
+		
 		/// <summary>
 		/// Accessor for attribute <see cref="lightBmpScale"/>. Scale of <see cref="lightMap"/> relative to the display size.
 		/// </summary>
@@ -78,6 +221,74 @@ namespace lighting
 			return lightBlockers.size();
 		}
 		
+		/// <summary>
+		/// Sets how long the shadows of a frame may take.  <see cref="LightSource"/>s are processed from the highest <see cref="LightSource::getPriority()"/> down,
+		/// and the ones that start after the budget is spent keep the shadows of their previous frame instead of being processed.
+		/// </summary>
+		/// <param name="frameBudgetNanos">The budget in nanoseconds, measured from when the frame starts processing, or <see cref="NO_FRAME_BUDGET"/>.  Default is <see cref="NO_FRAME_BUDGET"/>.</param>
+		void setFrameBudget(uint64_t frameBudgetNanos)
+		{
+			this->frameBudgetNanos = frameBudgetNanos;
+		}
+
+		/// <summary>
+		/// Sets the width and height of the cells of the <see cref="BlockerGrid"/> built over the <see cref="LightBlocker"/>s every frame.
+		/// Around the radius of the smaller lights works well.
+		/// </summary>
+		/// <param name="blockerGridCellSize">The size of a cell in pixels.  Default is <see cref="BlockerGrid::DEFAULT_CELL_SIZE"/>, which is also used if the size is not positive.</param>
+		void setBlockerGridCellSize(float blockerGridCellSize)
+		{
+			//The grid divides by the size, written so NaN is rejected too
+			if (!(blockerGridCellSize > 0))
+			{
+				blockerGridCellSize = BlockerGrid::DEFAULT_CELL_SIZE;
+			}
+			this->blockerGridCellSize = blockerGridCellSize;
+		}
+
+		/// <summary>
+		/// Sets if <see cref="LightSource"/>s are given a simplified copy of the <see cref="LightBlocker"/>s, where lines on the same supporting line that touch or overlap are merged
+		/// and duplicates, like the shared walls of neighboring boxes, are dropped.  While on, a change to a blocker only merges again the lines on its old and new supporting lines.
+		/// </summary>
+		/// <param name="simplifyBlockers"><c>true</c> to simplify.  Default is <c>false</c>.</param>
+		void setSimplifyBlockers(bool simplifyBlockers);
+
+		/// <summary>
+		/// Gets the number of lines <see cref="LightSource"/>s are given, which is less than <see cref="getNumLightBlockers()"/> when <see cref="setSimplifyBlockers(bool)"/> merged some.
+		/// </summary>
+		/// <returns>The number of lines of the newest <see cref="BlockerSnapshot"/>.</returns>
+		size_t getNumSnapshotLightBlockers()
+		{
+			return blockerSnapshot ? blockerSnapshot->blockerLines.size() : lightBlockers.size();
+		}
+
+		/// <summary>
+		/// Accessor for <see cref="lastFrameDeferredLights"/>.
+		/// </summary>
+		/// <returns>The number of <see cref="LightSource"/>s of the last processed frame that reused their previous shadows because the frame budget was spent.</returns>
+		size_t getLastFrameDeferredLights()
+		{
+			return lastFrameDeferredLights;
+		}
+
+		/// <summary>
+		/// Accessor for <see cref="lastFrameSkippedLights"/>.
+		/// </summary>
+		/// <returns>The number of <see cref="LightSource"/>s of the last processed frame that reused their previous shadows because nothing near them changed.</returns>
+		size_t getLastFrameSkippedLights()
+		{
+			return lastFrameSkippedLights;
+		}
+
+		/// <summary>
+		/// Gets the time the <see cref="executor"/> took to process the shadows of the last processed frame.
+		/// </summary>
+		/// <returns>Nanoseconds between the frame's tasks being submitted and the last of them finishing.</returns>
+		uint64_t getLastFrameNanos()
+		{
+			return frameBarrier.getLastFrameNanos();
+		}
+
 		/// <summary>
 		/// Accessor for data members <see cref="lightMap"/>.
 		/// </summary>
@@ -88,7 +299,47 @@ namespace lighting
 		}
 
 		/// <summary>
-		/// Finalizes an instance of the <see cref="LightLayer"/>.  None of the <see cref="LightBlocker"/>s or <see cref="LightSource"/> are deleted.  Everything else is destroyed.
+		/// Adds <paramref name="numLines"/> lines that block light in one pass, for loading a level.  The lines are only stored by <c>this</c>, there is no <see cref="LightBlocker"/>
+		/// to own them, so they stay until <see cref="removeLightBlockers"/> is called with their handles.
+		/// </summary>
+		/// <param name="lines">The endpoints of the lines relative to <paramref name="x"/>, <paramref name="y"/>.</param>
+		/// <param name="numLines">The number of elements of <paramref name="lines"/>.</param>
+		/// <param name="handles">Receives the handle of each line, must have room for <paramref name="numLines"/>.</param>
+		/// <param name="x">The horizontal position the lines are relative to.</param>
+		/// <param name="y">The vertical position the lines are relative to.</param>
+		/// <param name="oneSided">If the lines only block light coming from their right, looking from the first endpoint to the second with y pointing down.
+		/// Used for the edges of closed shapes, whose edges facing away from a light are hidden behind the ones facing it.</param>
+		void addLightBlockers(const BlockerLine* lines, size_t numLines, BlockerHandle* handles, float x = 0, float y = 0, bool oneSided = false);
+
+		/// <summary>
+		/// Removes the lines of <paramref name="handles"/>.  Handles whose line was already removed are ignored.
+		/// </summary>
+		/// <param name="handles">The handles returned by <see cref="addLightBlockers"/>.</param>
+		/// <param name="numHandles">The number of elements of <paramref name="handles"/>.</param>
+		void removeLightBlockers(const BlockerHandle* handles, size_t numHandles);
+
+		/// <summary>
+		/// Moves the lines of <paramref name="handles"/> so their endpoints are displaced from <paramref name="x"/>, <paramref name="y"/> as they were when added, plus their rotation.
+		/// </summary>
+		/// <param name="handles">The handles returned by <see cref="addLightBlockers"/>.</param>
+		/// <param name="numHandles">The number of elements of <paramref name="handles"/>.</param>
+		/// <param name="x">The horizontal position.</param>
+		/// <param name="y">The vertical position.</param>
+		void setLightBlockersXY(const BlockerHandle* handles, size_t numHandles, float x, float y);
+
+		/// <summary>
+		/// Rotates the endpoints of the lines of <paramref name="handles"/> around <paramref name="cX"/>, <paramref name="cY"/>.
+		/// </summary>
+		/// <param name="handles">The handles returned by <see cref="addLightBlockers"/>.</param>
+		/// <param name="numHandles">The number of elements of <paramref name="handles"/>.</param>
+		/// <param name="cX">The horizontal displacement from the position of the lines to rotate around.</param>
+		/// <param name="cY">The vertical displacement from the position of the lines to rotate around.</param>
+		/// <param name="rads">The angle of the lines.</param>
+		void setLightBlockersRads(const BlockerHandle* handles, size_t numHandles, float cX, float cY, float rads);
+
+		/// <summary>
+		/// Finalizes an instance of the <see cref="LightLayer"/>.  None of the <see cref="LightBlocker"/>s or <see cref="LightSource"/> are deleted.  Everything else is destroyed
+		/// once the tasks of the current frame have finished, including the <see cref="executor"/> if <see cref="ownsExecutor"/>.
 		/// </summary>
 		~LightLayer();
 
@@ -121,83 +372,222 @@ namespace lighting
 		void removeAboveLightBlocker(AboveLightBlocker* aboveLightBlocker);
 
 		/// <summary>
-		/// The safe option for adding the <see cref="LightSource"/> object specified by the parameter <paramref name="lightSource"/>.
+		/// Adds <paramref name="lightSource"/> to <see cref="lightSources"/> and <see cref="lightSourceTrackerMap"/>.  Frames that were already detached don't include it.
 		/// </summary>
-		/// <para>
-		/// This method is safe because it will not attempt to add <paramref name="lightSource"/> if <see cref="threadsProcessing"/> is true.
-		/// If <see cref="threadsProcessing"/> is true, <paramref name="lightSource"/> is pushed to <see cref="heldAddLightSources"/>.
-		/// Otherwise <see cref="addLightSourceUnsafe(LightSource*)"/> is called.
-		/// </para>
 		/// <param name="lightSource">The <see cref="LightSource"/> to be added.</param>
 		void addLightSource(LightSource* lightSource);
 
 		/// <summary>
-		/// The safe option for removing the <see cref="LightSource"/> object specified by the parameter <paramref name="lightSource"/>.
+		/// Removes <paramref name="lightSource"/> from <see cref="lightSources"/> using the <see cref="lightSourceTrackerMap"/> to find it.  Does nothing if it was already removed.
+		/// Waits for every detached frame to be processed first, because tasks of those frames may still call the virtual methods of <paramref name="lightSource"/> and read its members.
 		/// </summary>
 		/// <para>
-		/// This method is safe because it will not attempt to remove <paramref name="lightSource"/> if <see cref="threadsProcessing"/> is true.
-		/// If <see cref="threadsProcessing"/> is true, <paramref name="lightSource"/> is pushed to <see cref="heldRemoveLightSources"/>.
-		/// Otherwise <see cref="removeLightSourceUnsafe(LightSource*)"/> is called.
+		/// Because of that wait, it must run before any of the state of <paramref name="lightSource"/> is destroyed: the destructor of every class deriving from
+		/// <see cref="LightSource"/> starts with <see cref="LightSource::removeFromOwner()"/>.  The destructor of <see cref="LightSource"/> itself runs after the derived
+		/// destructors, when the derived members and virtual methods are already gone, so it is too late to wait there.
 		/// </para>
 		/// <param name="lightSource">The <see cref="LightSource"/> to be removed.</param>
 		void removeLightSource(LightSource* lightSource);
 
 		/// <summary>
-		/// Transfers held variables and elements (attributes that can't be modified while processing <see cref="LightSource"/>s)
-		/// to their appropiate data members.  Called by <see cref="detach()"/>.
+		/// Transfers held variables (attributes that can't be modified while processing <see cref="LightSource"/>s) and copies of the <see cref="LightSource"/>s
+		/// and <see cref="LightBlocker"/>s into the element of <see cref="frames"/> for <paramref name="frame"/>.  Called by <see cref="detach()"/>.
 		/// </summary>
-		void transferHeldVars();
+		/// <param name="frame">The number of the frame being detached.</param>
+		void transferHeldVars(uint64_t frame);
 
 		/// <summary>
-		/// Finds the lightRunnable with the best run time and adds <paramref name="lightSource"/> to it.
-		/// Will also add <paramref name="lightSource"/> to <see cref="lightSourceTrackerMap"/>.
+		/// Submits a task for every <see cref="LightSource"/> of <paramref name="frame"/> to the <see cref="executor"/>.  Called by <see cref="detach()"/>, or by the
+		/// task that finished the previous frame when frames are queued.
 		/// </summary>
-		/// <param name="lightSource">The <see cref="LightSource"/> to be added.</param>
-		void addLightSourceUnsafe(LightSource* lightSource);
-		
+		/// <param name="frame">The number of the frame to process.</param>
+		void startFrame(uint64_t frame);
+
 		/// <summary>
-		/// Directly removes <paramref name="lightSource"/> from the <see cref="LightRunnable"/> it is stored in using
-		/// the <see cref="lightSourceTrackerMap"/> to find it.
+		/// Run by each task of a frame.  Takes the <see cref="LightSource"/> with the next highest priority from the frame, then either processes it or,
+		/// if the frame budget is spent and it has shadows from an earlier frame, reuses them.
 		/// </summary>
-		/// <param name="lightSource">The <see cref="LightSource"/> to be removed.</param>
-		void removeLightSourceUnsafe(LightSource* lightSource);
+		/// <param name="slot">The element of <see cref="frames"/> being processed.</param>
+		void processNextLightSource(size_t slot);
+
+		/// <summary>
+		/// Captures and queues the next frame.  Implements <see cref="detach()"/> and <see cref="detachAsync"/>.
+		/// </summary>
+		/// <param name="processedPromise">Fulfilled once the frame is processed, can be <c>nullptr</c>.</param>
+		/// <param name="processedCallback">Called once the frame is processed, can be empty.</param>
+		void detachFrame(std::unique_ptr<std::promise<void>> processedPromise, std::function<void()> processedCallback);
+
+		/// <summary>
+		/// Called when the last <see cref="LightSource"/> of a frame arrives at the <see cref="frameBarrier"/>.  Notifies whoever waits on the frame
+		/// and starts the next element of <see cref="queuedFrames"/>, if any.  The frame is ended while <see cref="queueMutex"/> is held, so it ends
+		/// before any frame detached after it can start.
+		/// </summary>
+		void finishFrame();
 
 		/// <summary>
-		/// Sets <see cref="maxThreads"/> to the number cores on the computer.
+		/// Blocks until the frame at <paramref name="frame"/> has been processed.  Until then the calling thread runs the queued tasks of the <see cref="executor"/>
+		/// itself, and only sleeps on the <see cref="frameBarrier"/> once every remaining task has been taken.
 		/// </summary>
-		void setMaxThreadsToNumCores();
+		/// <param name="frame">The number of the frame to wait for.</param>
+		void waitProcessed(uint64_t frame);
+
+		/// <summary>
+		/// Blocks until every frame detached so far has been processed and the task that ended the last one has released <see cref="queueMutex"/>,
+		/// so nothing of the layer is used by the tasks anymore.
+		/// </summary>
+		void waitDetachedProcessed();
+
+		/// <summary>
+		/// Gets the element of <see cref="frames"/> used by <paramref name="frame"/>.
+		/// </summary>
+		/// <param name="frame">The number of the frame.</param>
+		/// <returns>The index in <see cref="frames"/>.</returns>
+		size_t getFrameSlot(uint64_t frame)
+		{
+			return frame % frames.size();
+		}
+
+		/// <summary>
+		/// Calculates the drawing coordinates of <paramref name="lightSource"/> and arrives at the <see cref="frameBarrier"/>.  Called by a task after the
+		/// shade points are created.  If the sweep is split into chunks, all but the first are submitted to the <see cref="executor"/>.
+		/// </summary>
+		/// <param name="lightSource">The <see cref="LightSource"/> to map.</param>
+		/// <param name="maxSweepChunks">The maximum number of chunks to split the sweep into.</param>
+		void mapLightSource(LightSource* lightSource, size_t maxSweepChunks);
+
+		/// <summary>
+		/// Maps the chunk at <paramref name="chunkI"/> of <paramref name="lightSource"/>.  The last chunk to finish stitches them together and arrives at the <see cref="frameBarrier"/>.
+		/// </summary>
+		/// <param name="lightSource">The <see cref="LightSource"/> being mapped.</param>
+		/// <param name="chunkI">The index of the chunk.</param>
+		void mapSweepChunk(LightSource* lightSource, size_t chunkI);
 
 		std::list <GaussianBlurrer*> blurrers;
 
 		/// <summary>
-		/// The <see cref="LightRunnable"/>s used to handle various <see cref="LightSource"/> methods in a seperate thread.
+		/// Runs the tasks submitted by <see cref="detach()"/> to process each <see cref="LightSource"/> in a seperate thread.
 		/// </summary>
-		std::list <LightRunnable*> lightRunnables;
+		LightExecutor* executor;
 
 		/// <summary>
-		/// Temporarily stores <see cref="LightSource"/> objects when they cannot be directly added.  When <see cref="transferHeldVars()"/> is called, the queue is cleared.
+		/// Indicates whether <see cref="executor"/> was created by the constructor and must be deleted by the destructor.
 		/// </summary>
-		std::queue <LightSource*> heldAddLightSources;
-		
+		bool ownsExecutor;
+
+		/// <summary>
+		/// All of the <see cref="LightSource"/>s that are processed each frame.
+		/// </summary>
+		std::list <LightSource*> lightSources;
+
+		/// <summary>
+		/// Counts the tasks of the frame being processed so <see cref="detach()"/> and <see cref="draw()"/> can sleep until the frame they need is finished.
+		/// </summary>
+		FrameBarrier frameBarrier;
+
+		/// <summary>
+		/// The inputs of the frames that may still be processed or drawn.  Frame n uses the element at n modulo the size, which is <see cref="pipelineDepth"/> + 1.
+		/// </summary>
+		std::vector <LayerFrame> frames;
+
+		/// <summary>
+		/// How many frames <see cref="draw()"/> lags behind <see cref="detach()"/>.  Set by <see cref="setPipelineDepth(size_t)"/>.
+		/// </summary>
+		size_t pipelineDepth;
+
+		/// <summary>
+		/// The number of frames detached so far.  The next frame detached has this number.
+		/// </summary>
+		uint64_t detachedFrames;
+
+		/// <summary>
+		/// Frames that were detached while another frame was being processed.  Frames are processed one after another so each <see cref="LightSource"/> only needs one set of working data.
+		/// </summary>
+		std::deque <uint64_t> queuedFrames;
+
+		/// <summary>
+		/// Indicates whether a frame is being processed.  Guarded by <see cref="queueMutex"/>.
+		/// </summary>
+		bool frameProcessing;
+
+		/// <summary>
+		/// The number of the frame being processed.  Only accessed by the tasks of that frame, frames are started one after another.
+		/// </summary>
+		uint64_t processingFrame;
+
+		/// <summary>
+		/// Guards <see cref="queuedFrames"/> and <see cref="frameProcessing"/>.  Also held by <see cref="finishFrame()"/> while it ends the frame at the <see cref="frameBarrier"/>.
+		/// </summary>
+		std::mutex queueMutex;
+
+		/// <summary>
+		/// Mutations queued by <see cref="queueCommand"/>, applied in a batch by <see cref="detach()"/>.
+		/// </summary>
+		LightCommandQueue commandQueue;
+
+		/// <summary>
+		/// How long the shadows of a frame may take, or <see cref="NO_FRAME_BUDGET"/>.  Set by <see cref="setFrameBudget(uint64_t)"/>.
+		/// </summary>
+		uint64_t frameBudgetNanos;
+
+		/// <summary>
+		/// The newest snapshot of <see cref="lightBlockers"/>, given to every frame detached until a blocker changes.
+		/// </summary>
+		std::shared_ptr <const BlockerSnapshot> blockerSnapshot;
+
+		/// <summary>
+		/// The size of the cells of <see cref="BlockerSnapshot::blockerGrid"/>.  Set by <see cref="setBlockerGridCellSize(float)"/>.
+		/// </summary>
+		float blockerGridCellSize;
+
+		/// <summary>
+		/// If snapshots are built from <see cref="blockerSimplifier"/>.  Set by <see cref="setSimplifyBlockers(bool)"/>.
+		/// </summary>
+		bool simplifyBlockers;
+
+		/// <summary>
+		/// When the frame being processed was started.
+		/// </summary>
+		std::chrono::steady_clock::time_point processingStartTime;
+
 		/// <summary>
-		///  Temporarily stores <see cref="LightSource"/> objects when they cannot be directly removed.  When <see cref="transferHeldVars()"/> is called, the queue is cleared.
+		/// Index of the next element of <see cref="LayerFrame::lightSources"/> a task of the frame being processed will take.
 		/// </summary>
-		std::queue <LightSource*> heldRemoveLightSources;
+		std::atomic<size_t> nextFrameLightSource;
+
+		/// <summary>
+		/// The number of <see cref="LightSource"/>s of the frame being processed that reused their previous shadows because the frame budget was spent.
+		/// </summary>
+		std::atomic<size_t> processingDeferredLights;
+
+		/// <summary>
+		/// The value of <see cref="processingDeferredLights"/> when the last frame finished.
+		/// </summary>
+		std::atomic<size_t> lastFrameDeferredLights;
+
+		/// <summary>
+		/// The number of <see cref="LightSource"/>s of the frame being processed that reused their previous shadows because their inputs were unchanged.
+		/// </summary>
+		std::atomic<size_t> processingSkippedLights;
+
+		/// <summary>
+		/// The value of <see cref="processingSkippedLights"/> when the last frame finished.
+		/// </summary>
+		std::atomic<size_t> lastFrameSkippedLights;
 		
 		/// <summary>
-		/// Stores all of the <see cref="LightSource"/>s specific location in the <see cref="LightRunnable/"> so they can be quickly removed.
+		/// Stores all of the <see cref="LightSource"/>s specific location in <see cref="lightSources"/> so they can be quickly removed.
 		/// </summary>
-		std::unordered_map <LightSource*, std::pair <LightRunnable*, std::list <LightSource*>::iterator>> lightSourceTrackerMap;		
+		std::unordered_map <LightSource*, std::list <LightSource*>::iterator> lightSourceTrackerMap;
 				
 		/// <summary>
-		/// Stores all of the elements of <see cref="lightBlockers"/> as keys and their location in the list as values to improve access and removal time.
+		/// Stores the values of all of the <see cref="LightBlocker"/>s that will be processed by <see cref="LightSource">s.  <see cref="LightBlocker"/>s add and remove themselves.
 		/// </summary>
-		std::unordered_map <LightBlocker*, std::list <LightBlocker*>::iterator> lightBlockerTrackerMap;
-				
+		BlockerSlotMap lightBlockers;
+
 		/// <summary>
-		/// Stores all of the <see cref="LightBlocker"/>s that will be processed by <see cref="LightSource">s.
+		/// The merged lines of <see cref="lightBlockers"/>, kept up to date while <see cref="simplifyBlockers"/> is set.
 		/// </summary>
-		std::list <LightBlocker*> lightBlockers;
+		BlockerSimplifier blockerSimplifier;
 		
 		/// <summary>
 		/// Stores all of the <see cref="AboveLightBlocker"/>s that will be processed by <see cref="AboveLightSource"/>s.
@@ -219,16 +609,6 @@ namespace lighting
 		/// </summary>
 		float lightBmpScale;
 		
-		/// <summary>
-		/// Indicates whether the lightRunnables are processing shadows.  Set to <c>true</c> by <see cref="detach()"/ and set to <c>false</c> by <see cref="draw()"/>.
-		/// </summary>
-		bool threadsProcessing;
-		
-		/// <summary>
-		/// The maximum size of <see cref="lightRunnable"/>s (each <see cref="LightRunnable"/> contains a thread).  Must be greater than 0.
-		/// </summary>
-		size_t maxThreads;
-
 		/// <summary>
 		/// Width of the display the lightMap will be drawn to.
 		/// </summary>
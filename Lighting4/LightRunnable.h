@@ -1,145 +1,91 @@
 #pragma once
 #include <thread>
-#include <list>
+#include <deque>
 #include <mutex>
-#include "LightSource.h"
+#include "LightThreadPool.h"
 
 namespace lighting
 {
-	class LightSource;
-	
 	/// <summary>
-	/// Manages a seperate thread to process <see cref="LightSource"/>s.
+	/// Manages a seperate thread of a <see cref="LightThreadPool"/>.  Each runnable owns a deque of tasks, it takes work from the back of its own deque
+	/// and the other runnables of the pool steal from the front when their own is empty.
 	/// </summary>
 	class LightRunnable
 	{
+		friend class LightThreadPool;
+
 	public:
 		/// <summary>
-		/// Initializes a new instance of the <see cref="LightRunnable"/> class.  Detaches the <see cref="runThread"/>.
-		/// </summary>
-		LightRunnable();
-		
-		/// <summary>
-		/// Inifinite while loop to handle the processing of shadows, called by the <see cref="runThread"/> which is detached in the constructor.
+		/// Initializes a new instance of the <see cref="LightRunnable"/> class.  The <see cref="runThread"/> is not started until <see cref="start()"/>.
 		/// </summary>
-		void run();
-		
-		/// <summary>
-		/// Adds a <param to the <see cref="lightSources"/> list for processing.  Returns the list iterator to the element that was added.
-		/// </summary>
-		/// <param name="lightSource">The <see cref="LightSource"/> to be added.</param>
-		/// <returns>Iterator for <see cref="lightSources"/> list where the <paramref name="lightSource"/> was added.</returns>
-		std::list <LightSource*>::iterator addLightSource(LightSource* lightSource);
+		/// <param name="pool">The pool that owns this runnable.  Value is assigned to <see cref="pool"/>.</param>
+		/// <param name="index">The index of <c>this</c> in the runnables of <paramref name="pool"/>.</param>
+		LightRunnable(LightThreadPool* pool, size_t index);
 
 		/// <summary>
-		/// Removes a <see cref="LightSource"/> from <see cref="lightSources"/> at the iterator.
+		/// Starts the <see cref="runThread"/>.  Called by the <see cref="pool"/> once all of its runnables exist so they can be stolen from.
 		/// </summary>
-		/// <param name="removeIter">The iterator pointing to the <see cref="LightSource"/> to remove.</param>
-		void removeLightSource(std::list <LightSource*>::iterator removeIter);
-		
-		/// <summary>
-		/// When elements of <see cref="lightBlockers"/> copy data of <see cref="LightBlocker"/>s in the method <see cref="run()"/>, this is set to <c>true</c>.  Set to <c>false</c> when <see cref="LightLayer::detach()"/> is called.
-		/// </summary>
-		bool lightBlockersCopied;
-		
-		/// <summary>
-		/// Mutex to lock access to <see cref="lightBlockersCopied"/>
-		/// </summary>
-		std::mutex lightBlockersCopiedMutex;
-		
+		void start();
+
 		/// <summary>
-		/// When <see cref="run()"/> has finished calling <see cref="LightSource::mapShadePoints()"/> on each element in <see cref="lightBlockers"/>, this is set to <c>true</c>.  Set to <c>false</c> when <see cref="LightLayer::detach()"/> is called.
+		/// Loop to run tasks, called by the <see cref="runThread"/>.  Returns once the <see cref="pool"/> is stopped.
 		/// </summary>
-		bool shadowsProcessed;
-		
+		void run();
+
 		/// <summary>
-		/// Mutex to lock access to <see cref="shadowsProcessedMutex"/>
+		/// Waits for the <see cref="runThread"/> to return from <see cref="run()"/>, so <see cref="pool"/> must already be stopped.  Does nothing if it was never started or already joined.
 		/// </summary>
-		std::mutex shadowsProcessedMutex;
-		
+		void join();
+
 		/// <summary>
-		/// Accessor for the <see cref="runTime"/> attribute.
+		/// Pushes <paramref name="task"/> to the back of <see cref="tasks"/>.
 		/// </summary>
-		/// <returns>The amount of time it takes to process all the <see cref="lightBlockers"/></returns>
-		unsigned int getRunTime()
-		{
-			return runTime;
-		}
-		
+		/// <param name="task">The task to be added.</param>
+		void pushTask(PoolTask&& task);
+
 		/// <summary>
-		/// Increments <see cref="runTime"/> by <paramref name="deltaMillis"/>.
+		/// Finalizes an instance of the <see cref="LightRunnable"/> class.  Calls <see cref="join()"/>, so <see cref="pool"/> must already be stopped.
 		/// </summary>
-		/// <param name="deltaMillis">The delta millis.</param>
-		void incrRunTime(int deltaMillis)
-		{
-			runTime += deltaMillis;
-		}
-		
+		~LightRunnable();
+
+	private:
 		/// <summary>
-		/// Gets the size of <see cref="lightSources"/>.
+		/// Takes the newest task from the back of <see cref="tasks"/>.
 		/// </summary>
-		/// <returns>Number of <see cref="LightSource"/>s.</returns>
-		unsigned int getLightSourceSize()
-		{
-			return lightSources.size();
-		}
-		
+		/// <param name="task">Output parameter, set to the task that was taken.</param>
+		/// <returns><c>false</c> if <see cref="tasks"/> was empty.</returns>
+		bool popTask(PoolTask& task);
+
 		/// <summary>
-		/// Iterates over <see cref="lightSources"/> and transfersHeldVariables
+		/// Takes the oldest task from the front of <see cref="tasks"/>.  Called by other runnables when they steal.
 		/// </summary>
-		void transferHeldVars()
-		{
-			for (auto it = lightSources.begin(); it != lightSources.end(); it++)
-			{
-				(*it)->transferHeldVars();
-			}
-		}
-
-		void drawLocal()
-		{
-			for (auto it = lightSources.begin(); it != lightSources.end(); it++)
-			{
-				(*it)->drawLocal();
-			}
-		}
+		/// <param name="task">Output parameter, set to the task that was taken.</param>
+		/// <returns><c>false</c> if <see cref="tasks"/> was empty.</returns>
+		bool stealFrontTask(PoolTask& task);
 
-		void drawToLightMap()
-		{
-			for (auto it = lightSources.begin(); it != lightSources.end(); it++)
-			{
-				(*it)->drawToLightMap();
-			}
-		}
-		
 		/// <summary>
-		/// Finalizes an instance of the <see cref="LightRunnable"/> class.
+		/// The tasks pushed to this runnable that have not been taken yet.
 		/// </summary>
-		~LightRunnable();
+		std::deque <PoolTask> tasks;
 
-	private:
 		/// <summary>
-		/// Calls method <see cref="LightSource::createShadePoints()"/> on each element of <see cref="lightBlockers"/>.
+		/// Mutex to lock access to <see cref="tasks"/>.
 		/// </summary>
-		void transferLightBlockers();
-		
+		std::mutex tasksMutex;
+
 		/// <summary>
-		/// Calls method <see cref="LightSource::mapShadePoints()"/> on each element of <see cref="lightBlockers"/>.
+		/// The pool that owns this runnable.
 		/// </summary>
-		void processShadows();
+		LightThreadPool* pool;
 
 		/// <summary>
-		/// Holds all of the <see cref="LightSource"/>s to be processed by <see cref="run()"/>.
+		/// The index of <c>this</c> in the runnables of <see cref="pool"/>.
 		/// </summary>
-		std::list <LightSource*> lightSources;
-		
+		size_t index;
+
 		/// <summary>
-		/// Thread which calls the method <see cref="run"/>.  Detached and initialized in the consturctor.
+		/// Thread which calls the method <see cref="run"/>.  Started in <see cref="start()"/> and joined in the destructor.
 		/// </summary>
 		std::thread runThread;
-		
-		/// <summary>
-		/// The amount of milliseconds it takes to process all of the shadows on all <see cref="lightBlockers"/>.
-		/// </summary>
-		unsigned int runTime;
 	};
 }
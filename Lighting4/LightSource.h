@@ -2,8 +2,11 @@
 #include <unordered_map>
 #include <list>
 #include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
 #include <allegro5/bitmap.h>
-#include "ShadePoint.h"
+#include "ShadePointBuffer.h"
 #include "LightBlocker.h"
 
 namespace lighting
@@ -15,10 +18,24 @@ namespace lighting
 	/// </summary>
 	class LightSource
 	{
-		friend class LightRunnable;
 		friend class LightLayer;
 
 	public:		
+		/// <summary>
+		/// Value for <see cref="setMaxSweepChunks(size_t)"/> to split the sweep into as many chunks as the <see cref="LightExecutor"/> of the <see cref="owner"/> can run at once.
+		/// </summary>
+		static const size_t SWEEP_CHUNKS_TO_CONCURRENCY = 0;
+
+		/// <summary>
+		/// The fewest shade points a chunk of the sweep will have.  Smaller sweeps are not worth the cost of seeding a chunk.
+		/// </summary>
+		static const size_t MIN_SWEEP_CHUNK_SHADE_POINTS = 512;
+
+		/// <summary>
+		/// Value of the elements of <see cref="slotFrames"/> that hold no results.
+		/// </summary>
+		static const uint64_t NO_FRAME = UINT64_MAX;
+
 		/// <summary>
 		/// Initializes the <see cref="LSourceMap"/> and all non constant attributes relating to it.
 		/// </summary>
@@ -32,11 +49,46 @@ namespace lighting
 		LightSource(LightLayer* ownerLightLayer);
 
 		/// <summary>
-		/// Finalizes an instance of the <see cref="LightSource"/> class.  Removes the <c>this</c> from the <see cref="owner"/>.
+		/// Sets the maximum number of chunks the sweep of <see cref="mapShadePoints()"/> is split into so one large light can be processed by several threads.
+		/// Read by <see cref="LightLayer::detach()"/>.  Default is 1, which does not split the sweep.
+		/// </summary>
+		/// <param name="maxSweepChunks">The maximum number of chunks, or <see cref="SWEEP_CHUNKS_TO_CONCURRENCY"/>.</param>
+		void setMaxSweepChunks(size_t maxSweepChunks)
+		{
+			this->maxSweepChunks = maxSweepChunks;
+		}
+
+		/// <summary>
+		/// Sets the order <c>this</c> is processed in.  <see cref="LightSource"/>s with a higher priority are processed first, so they are the last to
+		/// reuse old shadows when the frame budget of the <see cref="LightLayer"/> is spent.  Read by <see cref="LightLayer::detach()"/>.
+		/// </summary>
+		/// <param name="priority">The priority.  Default is 0.</param>
+		void setPriority(float priority)
+		{
+			this->priority = priority;
+		}
+
+		/// <summary>
+		/// Accessor for <see cref="priority"/>.
+		/// </summary>
+		/// <returns>The priority of <c>this</c>.</returns>
+		float getPriority()
+		{
+			return priority;
+		}
+
+		/// <summary>
+		/// Finalizes an instance of the <see cref="LightSource"/> class.  Removes the <c>this</c> from the <see cref="owner"/>, if the derived destructor hasn't already.
 		/// </summary>
 		virtual ~LightSource();
 
 	protected:		
+		/// <summary>
+		/// Removes <c>this</c> from the <see cref="owner"/> with <see cref="LightLayer::removeLightSource"/>, which waits for the frames still processing <c>this</c>.
+		/// Must be the first thing the destructor of every derived class does, before anything those frames use is destroyed.  Can be called more than once.
+		/// </summary>
+		void removeFromOwner();
+
 		/// <summary>
 		/// The allegro bitmap flags for loading <see cref="LSource_Map"/>
 		/// </summary>
@@ -63,14 +115,42 @@ namespace lighting
 		static int LSource_Map_H;
 		
 		/// <summary>
-		/// Converts elements of <see cref="lightBlockers"/> to <see cref="ShadePoint"/>s, populating the vector of <see cref="ShadePoint"/>s.
+		/// Converts elements of <see cref="lightBlockers"/> to shade points, populating the <see cref="ShadePointBuffer"/> of <c>this</c>.
 		/// </summary>
 		virtual void createShadePoints() = 0;
 		
 		/// <summary>
-		/// Uses vector of <see cref="ShadePoint"/>s to calculate the drawing coordinates.  This will handle shadows.
+		/// Uses the shade points to calculate the drawing coordinates.  This will handle shadows.
 		/// </summary>
 		virtual void mapShadePoints() = 0;
+
+		/// <summary>
+		/// Splits the sorted shade points into at most <paramref name="maxChunks"/> chunks that <see cref="mapSweepChunk(size_t)"/> can process at the same time.
+		/// Called after <see cref="createShadePoints()"/>.  The default does not split the sweep.
+		/// </summary>
+		/// <param name="maxChunks">The maximum number of chunks to create.</param>
+		/// <returns>The number of chunks created, at least 1.</returns>
+		virtual size_t createSweepChunks(size_t)
+		{
+			return 1;
+		}
+
+		/// <summary>
+		/// Calculates the drawing coordinates of the chunk at <paramref name="chunkI"/>.  Safe to call for different chunks from different threads.  The default calls <see cref="mapShadePoints()"/>.
+		/// </summary>
+		/// <param name="chunkI">The index of the chunk, less than the value returned by <see cref="createSweepChunks(size_t)"/>.</param>
+		virtual void mapSweepChunk(size_t)
+		{
+			mapShadePoints();
+		}
+
+		/// <summary>
+		/// Joins the drawing coordinates of every chunk in order once all of them have been mapped.
+		/// </summary>
+		virtual void stitchSweepChunks()
+		{
+
+		}
 		
 		/// <summary>
 		/// Now that drawing operations are possible, shadows can be drawn to the bitmap data member, if it exists.
@@ -83,13 +163,79 @@ namespace lighting
 		virtual void drawToLightMap() = 0;
 		
 		/// <summary>
-		/// When the <see cref="LightSource"/> is being processed, setting some variables may not be thread safe, so they are stored in heldVariables, this function tranfers their values.
+		/// When the <see cref="LightSource"/> is being processed, setting some variables may not be thread safe, so they are stored in heldVariables, this function tranfers their values
+		/// to the inputs of the frame slot at <paramref name="slot"/>.  Called by <see cref="LightLayer::detach()"/> on the main thread.
 		/// </summary>
-		virtual void transferHeldVars() = 0;
+		/// <param name="slot">The frame slot that will be processed next.</param>
+		virtual void transferHeldVars(size_t slot) = 0;
+
+		/// <summary>
+		/// Resizes the per frame inputs and results to <paramref name="slots"/>, one for each frame that may be processed or drawn at once.  Only called when <c>this</c> is in no unfinished frame.
+		/// Overrides must call the base.
+		/// </summary>
+		/// <param name="slots">The number of frame slots.</param>
+		virtual void setPipelineSlots(size_t slots)
+		{
+			slotFrames.assign(slots, NO_FRAME);
+			resultFrame = NO_FRAME;
+		}
+
+		/// <summary>
+		/// Checks if the inputs of the frame slot at <see cref="computeSlot"/> are the ones the shadows of <see cref="resultFrame"/> were processed from, in which case
+		/// <see cref="reuseResults(size_t)"/> is called instead of processing them again.  Only called when <see cref="resultFrame"/> is not <see cref="NO_FRAME"/>.
+		/// The default never reuses shadows.
+		/// </summary>
+		/// <returns><c>true</c> if processing the frame slot would give the same shadows as <see cref="resultFrame"/>.</returns>
+		virtual bool hasUnchangedInputs()
+		{
+			return false;
+		}
+
+		/// <summary>
+		/// Makes the frame slot at <see cref="computeSlot"/> draw the same shadows as the frame slot at <paramref name="previousSlot"/> instead of processing them.
+		/// Called by a task of the <see cref="LightLayer"/> when the frame budget is spent or <see cref="hasUnchangedInputs()"/> is <c>true</c>.  The position of the frame slot is kept.
+		/// </summary>
+		/// <param name="previousSlot">The frame slot of the last frame <c>this</c> has shadows for, can be <see cref="computeSlot"/>.</param>
+		virtual void reuseResults(size_t previousSlot) = 0;
 
 		/// <summary>
 		/// The owner of <c>this</c>.  Set by constructor and is not reassigned afterwards.  Pointer is used to access lightBmpW and lightBmpH for drawing operations.  Also allows <c>this</c> to remove itself when <see cref="~LightSource()"/> is called.
 		/// </summary>
 		LightLayer* owner;
+
+		/// <summary>
+		/// The maximum number of chunks the sweep is split into.  Set by <see cref="setMaxSweepChunks(size_t)"/>.
+		/// </summary>
+		size_t maxSweepChunks;
+
+		/// <summary>
+		/// The number of chunks of the current frame that have not been mapped.  The <see cref="LightLayer"/> stitches the chunks when this reaches 0.
+		/// </summary>
+		std::atomic<size_t> sweepChunksLeft;
+
+		/// <summary>
+		/// The frame slot being processed.  Set by the task of the <see cref="LightLayer"/> before <see cref="createShadePoints()"/>.
+		/// </summary>
+		size_t computeSlot;
+
+		/// <summary>
+		/// The frame slot being drawn.  Set by <see cref="LightLayer::draw()"/> before <see cref="drawLocal()"/>.
+		/// </summary>
+		size_t drawSlot;
+
+		/// <summary>
+		/// The number of the frame whose inputs and results are in each frame slot, or <see cref="NO_FRAME"/>.
+		/// </summary>
+		std::vector<uint64_t> slotFrames;
+
+		/// <summary>
+		/// The last frame <c>this</c> was processed or reused its shadows in, or <see cref="NO_FRAME"/>.  Only accessed by the tasks of the <see cref="LightLayer"/>.
+		/// </summary>
+		uint64_t resultFrame;
+
+		/// <summary>
+		/// The order <c>this</c> is processed in.  Set by <see cref="setPriority(float)"/>.
+		/// </summary>
+		float priority;
 	};
 }
@@ -0,0 +1,146 @@
+#pragma once
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "LightExecutor.h"
+
+namespace lighting
+{
+	class LightRunnable;
+
+	/// <summary>
+	/// A task queued in a <see cref="LightThreadPool"/> along with the time it was submitted.
+	/// </summary>
+	struct PoolTask
+	{
+		/// <summary>
+		/// The work to run.
+		/// </summary>
+		std::function<void()> run;
+
+		/// <summary>
+		/// When <see cref="LightThreadPool::submit"/> was called, used to measure <see cref="LightThreadPool::TaskLatencyNanos"/>.
+		/// </summary>
+		std::chrono::steady_clock::time_point submitTime;
+	};
+
+	/// <summary>
+	/// The default <see cref="LightExecutor"/>.  Owns one <see cref="LightRunnable"/> per thread, each with its own deque of tasks that the others steal from.
+	/// Workers sleep when there are no tasks.  All <see cref="LightLayer"/>s constructed without an executor share <see cref="GetShared()"/>,
+	/// so several layers never run more threads than there are cores.
+	/// </summary>
+	class LightThreadPool : public LightExecutor
+	{
+		friend class LightRunnable;
+
+	public:
+		/// <summary>
+		/// Total nanoseconds tasks spent queued between <see cref="submit"/> and a worker starting them.
+		/// </summary>
+		static std::atomic<uint64_t> TaskLatencyNanos;
+
+		/// <summary>
+		/// Number of tasks started by all pools.  Divide <see cref="TaskLatencyNanos"/> by this for the average latency.
+		/// </summary>
+		static std::atomic<uint64_t> TaskCount;
+
+		/// <summary>
+		/// Total number of tasks a worker took from the deque of another worker.
+		/// </summary>
+		static std::atomic<uint64_t> TasksStolen;
+
+		/// <summary>
+		/// Total number of tasks run by threads outside of the pool through <see cref="runPendingTask()"/>.
+		/// </summary>
+		static std::atomic<uint64_t> TasksRunByCaller;
+
+		/// <summary>
+		/// Gets the process-wide pool with one thread per core.  Created on first use and never destroyed, its threads end with the process.
+		/// </summary>
+		/// <returns>The shared pool.</returns>
+		static LightThreadPool* GetShared();
+
+		/// <summary>
+		/// Initializes a new instance of the <see cref="LightThreadPool"/> class and starts its threads.
+		/// </summary>
+		/// <param name="numThreads">The number of threads.  0 will use the number of cores on the computer.</param>
+		LightThreadPool(size_t numThreads = 0);
+
+		/// <summary>
+		/// Pushes <paramref name="task"/> to the deque of the calling worker, or to the next worker's deque if called from outside the pool, and wakes a worker.
+		/// </summary>
+		/// <param name="task">The task to run.</param>
+		virtual void submit(std::function<void()> task) override;
+
+		/// <summary>
+		/// Gets the number of threads in the pool.
+		/// </summary>
+		/// <returns>The size of <see cref="runnables"/>.</returns>
+		virtual size_t getConcurrency() override
+		{
+			return runnables.size();
+		}
+
+		/// <summary>
+		/// Takes the oldest task of the first worker that has one and runs it on the calling thread.
+		/// </summary>
+		/// <returns><c>true</c> if a task was run, <c>false</c> if every deque was empty.</returns>
+		virtual bool runPendingTask() override;
+
+		/// <summary>
+		/// Finalizes an instance of the <see cref="LightThreadPool"/> class.  Stops and joins all threads, no tasks may be pending.
+		/// </summary>
+		virtual ~LightThreadPool();
+
+	private:
+		/// <summary>
+		/// Called by the thread of <paramref name="runnable"/>.  Takes a task from its own deque or steals one, and sleeps while there are none.
+		/// </summary>
+		/// <param name="runnable">The worker asking for a task.</param>
+		/// <param name="task">Output parameter, set to the task to run.</param>
+		/// <returns><c>false</c> when the pool is stopped and the worker should exit.</returns>
+		bool waitForTask(LightRunnable* runnable, PoolTask& task);
+
+		/// <summary>
+		/// Tries to steal a task from every element of <see cref="runnables"/> other than <paramref name="thief"/>, starting with the one after it.
+		/// </summary>
+		/// <param name="thief">The worker that is stealing.</param>
+		/// <param name="task">Output parameter, set to the task that was stolen.</param>
+		/// <returns><c>false</c> if every other deque was empty.</returns>
+		bool stealTask(LightRunnable* thief, PoolTask& task);
+
+		/// <summary>
+		/// The workers of the pool.  Created in the constructor and not modified until the destructor.
+		/// </summary>
+		std::vector <LightRunnable*> runnables;
+
+		/// <summary>
+		/// Index of the next element of <see cref="runnables"/> that a task submitted from outside the pool is pushed to.
+		/// </summary>
+		std::atomic<size_t> nextRunnable;
+
+		/// <summary>
+		/// Number of tasks submitted but not yet taken by a worker.  Only incremented while <see cref="sleepMutex"/> is locked so no wake up is lost.
+		/// Never less than the number of tasks in the deques of <see cref="runnables"/>.
+		/// </summary>
+		std::atomic<size_t> pendingTasks;
+
+		/// <summary>
+		/// Mutex for <see cref="sleepCondition"/>.
+		/// </summary>
+		std::mutex sleepMutex;
+
+		/// <summary>
+		/// Workers sleep on this when there are no <see cref="pendingTasks"/>.
+		/// </summary>
+		std::condition_variable sleepCondition;
+
+		/// <summary>
+		/// Set by the destructor to make the workers exit.
+		/// </summary>
+		bool stopped;
+	};
+}
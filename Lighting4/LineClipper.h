@@ -0,0 +1,121 @@
+#pragma once
+#include <cstddef>
+
+namespace lighting
+{
+	/// <summary>
+	/// Clips lines to the square from (-bound, -bound) to (bound, bound) with the Liang–Barsky method, which finds how far along a line it enters and leaves the square
+	/// with one divide per side instead of intersecting it with each side.
+	/// </summary>
+	/// <para>
+	/// Lines can also be clipped to the circle of a radius around the origin by <see cref="ClipLinesToCircle"/>, which solves where a line crosses the circle with one
+	/// square root.  Lines that miss the circle are found from the squared distance of the line to the origin before the root is used.
+	/// </para>
+	/// <para>
+	/// Lines are held as one array for each coordinate so <see cref="ClipLines"/> can clip four at a time with SSE.  <see cref="ClipLinesScalar"/> does the same math one
+	/// line at a time and gives the same results to the bit, so it is kept to check the vectorized path against.
+	/// </para>
+	class LineClipper
+	{
+	public:
+		/// <summary>
+		/// Clips one line.  An endpoint inside the square is left as it is, and an endpoint outside is moved to where the line crosses the square.
+		/// </summary>
+		/// <param name="x1">The horizontal position of the first endpoint.  Used as out parameter.</param>
+		/// <param name="y1">The vertical position of the first endpoint.  Used as out parameter.</param>
+		/// <param name="x2">The horizontal position of the second endpoint.  Used as out parameter.</param>
+		/// <param name="y2">The vertical position of the second endpoint.  Used as out parameter.</param>
+		/// <param name="bound">Half the width of the square.</param>
+		/// <returns><c>true</c> if more than a point of the line is in the square.  Lines along a side or touching a corner are not.</returns>
+		static bool ClipLine(float& x1, float& y1, float& x2, float& y2, float bound);
+
+		/// <summary>
+		/// Clips every line and moves the ones that are in the square to the front of the arrays, keeping their order.  Uses SSE when the compiler targets it.
+		/// </summary>
+		/// <param name="x1">The horizontal position of the first endpoint of each line.</param>
+		/// <param name="y1">The vertical position of the first endpoint of each line.</param>
+		/// <param name="x2">The horizontal position of the second endpoint of each line.</param>
+		/// <param name="y2">The vertical position of the second endpoint of each line.</param>
+		/// <param name="numLines">The number of lines.</param>
+		/// <param name="bound">Half the width of the square.</param>
+		/// <returns>The number of lines that are in the square.</returns>
+		static size_t ClipLines(float* x1, float* y1, float* x2, float* y2, size_t numLines, float bound);
+
+		/// <summary>
+		/// Does the same as <see cref="ClipLines"/> with <see cref="ClipLine"/>, one line at a time.
+		/// </summary>
+		/// <param name="x1">The horizontal position of the first endpoint of each line.</param>
+		/// <param name="y1">The vertical position of the first endpoint of each line.</param>
+		/// <param name="x2">The horizontal position of the second endpoint of each line.</param>
+		/// <param name="y2">The vertical position of the second endpoint of each line.</param>
+		/// <param name="numLines">The number of lines.</param>
+		/// <param name="bound">Half the width of the square.</param>
+		/// <returns>The number of lines that are in the square.</returns>
+		static size_t ClipLinesScalar(float* x1, float* y1, float* x2, float* y2, size_t numLines, float bound);
+
+		/// <summary>
+		/// Clips one line to the circle of <paramref name="radius"/> around the origin.  An endpoint inside the circle is left as it is, and an endpoint outside is moved to
+		/// where the line crosses the circle.  Moved endpoints are not pulled back in, so rounding can leave them a tiny distance outside.
+		/// </summary>
+		/// <param name="x1">The horizontal position of the first endpoint.  Used as out parameter.</param>
+		/// <param name="y1">The vertical position of the first endpoint.  Used as out parameter.</param>
+		/// <param name="x2">The horizontal position of the second endpoint.  Used as out parameter.</param>
+		/// <param name="y2">The vertical position of the second endpoint.  Used as out parameter.</param>
+		/// <param name="radius">The radius of the circle.</param>
+		/// <returns><c>true</c> if more than a point of the line is in the circle.  Lines touching the circle are not.</returns>
+		static bool ClipLineToCircle(float& x1, float& y1, float& x2, float& y2, float radius);
+
+		/// <summary>
+		/// Does the same as <see cref="ClipLines"/>, but clips to the circle of <paramref name="radius"/> around the origin like <see cref="ClipLineToCircle"/>.
+		/// </summary>
+		/// <param name="x1">The horizontal position of the first endpoint of each line.</param>
+		/// <param name="y1">The vertical position of the first endpoint of each line.</param>
+		/// <param name="x2">The horizontal position of the second endpoint of each line.</param>
+		/// <param name="y2">The vertical position of the second endpoint of each line.</param>
+		/// <param name="numLines">The number of lines.</param>
+		/// <param name="radius">The radius of the circle.</param>
+		/// <returns>The number of lines that are in the circle.</returns>
+		static size_t ClipLinesToCircle(float* x1, float* y1, float* x2, float* y2, size_t numLines, float radius);
+
+		/// <summary>
+		/// Does the same as <see cref="ClipLinesToCircle"/> with <see cref="ClipLineToCircle"/>, one line at a time.
+		/// </summary>
+		/// <param name="x1">The horizontal position of the first endpoint of each line.</param>
+		/// <param name="y1">The vertical position of the first endpoint of each line.</param>
+		/// <param name="x2">The horizontal position of the second endpoint of each line.</param>
+		/// <param name="y2">The vertical position of the second endpoint of each line.</param>
+		/// <param name="numLines">The number of lines.</param>
+		/// <param name="radius">The radius of the circle.</param>
+		/// <returns>The number of lines that are in the circle.</returns>
+		static size_t ClipLinesToCircleScalar(float* x1, float* y1, float* x2, float* y2, size_t numLines, float radius);
+
+	private:
+		/// <summary>
+		/// Clips the lines from <paramref name="beginI"/> up to <paramref name="endI"/> one at a time, writing the kept ones from index <paramref name="keptLines"/> on.
+		/// </summary>
+		/// <param name="x1">The horizontal position of the first endpoint of each line.</param>
+		/// <param name="y1">The vertical position of the first endpoint of each line.</param>
+		/// <param name="x2">The horizontal position of the second endpoint of each line.</param>
+		/// <param name="y2">The vertical position of the second endpoint of each line.</param>
+		/// <param name="beginI">The index of the first line to clip.</param>
+		/// <param name="endI">One past the index of the last line to clip.</param>
+		/// <param name="keptLines">The number of lines already kept, no more than <paramref name="beginI"/>.</param>
+		/// <param name="bound">Half the width of the square.</param>
+		/// <returns>The number of lines kept, including <paramref name="keptLines"/>.</returns>
+		static size_t ClipRange(float* x1, float* y1, float* x2, float* y2, size_t beginI, size_t endI, size_t keptLines, float bound);
+
+		/// <summary>
+		/// Does the same as <see cref="ClipRange"/> with <see cref="ClipLineToCircle"/>.
+		/// </summary>
+		/// <param name="x1">The horizontal position of the first endpoint of each line.</param>
+		/// <param name="y1">The vertical position of the first endpoint of each line.</param>
+		/// <param name="x2">The horizontal position of the second endpoint of each line.</param>
+		/// <param name="y2">The vertical position of the second endpoint of each line.</param>
+		/// <param name="beginI">The index of the first line to clip.</param>
+		/// <param name="endI">One past the index of the last line to clip.</param>
+		/// <param name="keptLines">The number of lines already kept, no more than <paramref name="beginI"/>.</param>
+		/// <param name="radius">The radius of the circle.</param>
+		/// <returns>The number of lines kept, including <paramref name="keptLines"/>.</returns>
+		static size_t ClipRangeToCircle(float* x1, float* y1, float* x2, float* y2, size_t beginI, size_t endI, size_t keptLines, float radius);
+	};
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace lighting
+{
+	/// <summary>
+	/// Stable sorts a list of keys with a least significant digit radix sort and gives back the order of their indices.
+	/// </summary>
+	/// <para>
+	/// Each key is packed with its index into one 64 bit value, so a counting pass reads and writes a single array and never looks back at the keys.
+	/// The histograms of every digit are counted from the keys before any element moves, so a digit that is the same for every key is found and its pass skipped,
+	/// and the last pass only writes the indices.
+	/// Lists of up to <see cref="INSERTION_SORT_MAX"/> keys are insertion sorted instead.
+	/// The arrays are kept between calls, so a sorter that is reused for lists of similar size doesn't allocate.  A sorter must only be used by one thread at a time.
+	/// </para>
+	class RadixSorter
+	{
+	public:
+		/// <summary>
+		/// The largest number of keys that are insertion sorted.
+		/// </summary>
+		static const size_t INSERTION_SORT_MAX = 48;
+
+		/// <summary>
+		/// Sorts the indices of <paramref name="keys"/> by their key.  Equal keys keep the order they had in <paramref name="keys"/>.
+		/// </summary>
+		/// <para>
+		/// The key width and digit width are template parameters, so the number of passes, their shifts and the histogram size are known when compiling and the passes
+		/// are unrolled.  Only the widths instantiated in RadixSorter.cpp can be used: 12 bit keys in one 12 bit pass, and 16 and 24 bit keys in 8 bit passes.
+		/// </para>
+		/// <param name="keys">The keys to sort, none of them can have more than <typeparamref name="MAX_BITS"/> bits.</param>
+		/// <typeparam name="MAX_BITS">The number of bits of the largest key, no more than 32.</typeparam>
+		/// <typeparam name="BASE_BITS">The number of bits sorted by each counting pass.</typeparam>
+		/// <returns>The indices of <paramref name="keys"/> in sorted order.  Valid until the next call.</returns>
+		template <int MAX_BITS, int BASE_BITS>
+		const std::vector <uint32_t>& sort(const std::vector <unsigned int>& keys);
+
+	private:
+		/// <summary>
+		/// Insertion sorts <see cref="pairs"/>.  Since the index is in the low bits, equal keys stay in the order of their index.
+		/// </summary>
+		void insertionSort();
+
+		/// <summary>
+		/// Each key in the high 32 bits and its index in the low 32 bits.
+		/// </summary>
+		std::vector <uint64_t> pairs;
+
+		/// <summary>
+		/// The destination of each counting pass, swapped with <see cref="pairs"/> after the pass.
+		/// </summary>
+		std::vector <uint64_t> pairsScratch;
+
+		/// <summary>
+		/// The histogram of every digit one after the other, turned into the starting offset of each digit value.
+		/// </summary>
+		std::vector <unsigned int> counts;
+
+		/// <summary>
+		/// The sorted indices returned by <see cref="sort"/>.
+		/// </summary>
+		std::vector <uint32_t> order;
+	};
+}
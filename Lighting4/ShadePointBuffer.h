@@ -0,0 +1,162 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "RadixSorter.h"
+
+namespace lighting
+{
+	/// <summary>
+	/// The endpoints of the <see cref="LightBlocker"/>s of a <see cref="LightSource"/>, stored as one array for each attribute indexed by point.
+	/// </summary>
+	/// <para>
+	/// A <see cref="LightSource"/> keeps one for its lifetime and refills it every frame, so once the arrays fit the busiest frame no memory is allocated.
+	/// Points are added in pairs, one for each endpoint of a line, and reference each other by index through <see cref="connect"/>.
+	/// <see cref="sortByRadixVal"/> moves the points themselves, so after it the index of a point is its place in the sweep.
+	/// </para>
+	class ShadePointBuffer
+	{
+	public:
+		/// <summary>
+		/// The index standing for no point.
+		/// </summary>
+		static const uint32_t NO_POINT = UINT32_MAX;
+
+		/// <summary>
+		/// Removes every point.  The arrays keep their capacity.
+		/// </summary>
+		void clear();
+
+		/// <summary>
+		/// Grows the arrays to fit <paramref name="numPoints"/> points without allocating.
+		/// </summary>
+		/// <param name="numPoints">The number of points.</param>
+		void reserve(size_t numPoints);
+
+		/// <summary>
+		/// Gets the number of points.
+		/// </summary>
+		/// <returns>The size of the arrays.</returns>
+		size_t size() const
+		{
+			return x.size();
+		}
+
+		/// <summary>
+		/// Adds the two endpoints of a line, connected to each other.
+		/// </summary>
+		/// <param name="x1">The horizontal position of the first endpoint.</param>
+		/// <param name="y1">The vertical position of the first endpoint.</param>
+		/// <param name="radixVal1">The sort key of the first endpoint.</param>
+		/// <param name="x2">The horizontal position of the second endpoint.</param>
+		/// <param name="y2">The vertical position of the second endpoint.</param>
+		/// <param name="radixVal2">The sort key of the second endpoint.</param>
+		/// <returns>The index of the first endpoint, the second is the one after it.</returns>
+		uint32_t addLine(float x1, float y1, unsigned int radixVal1, float x2, float y2, unsigned int radixVal2);
+
+		/// <summary>
+		/// Checks if the endpoints passed in as parameters form a line that would intersect with the line from the point at <paramref name="pointI"/> to its <see cref="connect"/>.
+		/// </summary>
+		/// <param name="pointI">The index of an endpoint of the line.</param>
+		/// <param name="x1">The horizontal position of the first endpoint.</param>
+		/// <param name="y1">The vertical position of the first endpoint.</param>
+		/// <param name="x2">The horizontal position of the second endpoint.</param>
+		/// <param name="y2">The vertical position of the second endpoint.</param>
+		/// <param name="cX">Serves as an output parameter.  If a collision occurs, the value
+		/// will represent the horizontal position of the collision.  Otherwise, it is unmodified.</param>
+		/// <param name="cY">Serves as an output parameter.  If a collision occurs, the value
+		/// will represent the vertical position of the collision.  Otherwise, it is unmodified.</param>
+		/// <returns><c>true</c> if the lines intersected. <c>false</c> otherwise.</returns>
+		bool checkIntersect(uint32_t pointI, float x1, float y1, float x2, float y2, float& cX, float& cY) const;
+
+		/// <summary>
+		/// Does the same as <see cref="checkIntersect"/> without finding where the lines intersect, so it doesn't divide.
+		/// </summary>
+		/// <param name="pointI">The index of an endpoint of the line.</param>
+		/// <param name="x1">The horizontal position of the first endpoint.</param>
+		/// <param name="y1">The vertical position of the first endpoint.</param>
+		/// <param name="x2">The horizontal position of the second endpoint.</param>
+		/// <param name="y2">The vertical position of the second endpoint.</param>
+		/// <returns><c>true</c> if the lines intersected. <c>false</c> otherwise.</returns>
+		bool checkCross(uint32_t pointI, float x1, float y1, float x2, float y2) const;
+
+		/// <summary>
+		/// Stable sorts the points by <see cref="radixVal"/> with <see cref="sorter"/>, then moves every array into that order and remaps <see cref="connect"/>.
+		/// </summary>
+		/// <typeparam name="MAX_BITS">The number of bits of the largest <see cref="radixVal"/>.</typeparam>
+		/// <typeparam name="BASE_BITS">The number of bits sorted by each counting pass.</typeparam>
+		template <int MAX_BITS, int BASE_BITS>
+		void sortByRadixVal()
+		{
+			reorder(sorter.sort<MAX_BITS, BASE_BITS>(radixVal));
+		}
+
+		/// <summary>
+		/// The horizontal position of each point.
+		/// </summary>
+		std::vector <float> x;
+
+		/// <summary>
+		/// The vertical position of each point.
+		/// </summary>
+		std::vector <float> y;
+
+		/// <summary>
+		/// The key each point is sorted by.
+		/// </summary>
+		std::vector <unsigned int> radixVal;
+
+		/// <summary>
+		/// The index of the other endpoint of the line of each point.
+		/// </summary>
+		std::vector <uint32_t> connect;
+
+	private:
+		/// <summary>
+		/// Moves every array into the order of <paramref name="sortedPoints"/> and remaps <see cref="connect"/>.
+		/// </summary>
+		/// <param name="sortedPoints">The indices of the points in sorted order.</param>
+		void reorder(const std::vector <uint32_t>& sortedPoints);
+
+		/// <summary>
+		/// Moves the elements of <paramref name="values"/> to the order of <paramref name="sortedPoints"/>, using <paramref name="scratch"/> as the destination.
+		/// </summary>
+		/// <param name="sortedPoints">The indices of the points in sorted order.</param>
+		/// <param name="values">The array to reorder.</param>
+		/// <param name="scratch">A spare array of the same type, left with the old order.</param>
+		template <typename T>
+		static void gather(const std::vector <uint32_t>& sortedPoints, std::vector <T>& values, std::vector <T>& scratch)
+		{
+			scratch.resize(values.size());
+			for (size_t i = 0; i < sortedPoints.size(); i++)
+			{
+				scratch[i] = values[sortedPoints[i]];
+			}
+			values.swap(scratch);
+		}
+
+		/// <summary>
+		/// Sorts the points by <see cref="radixVal"/>.  Kept between frames with the scratch arrays so sorting doesn't allocate.
+		/// </summary>
+		RadixSorter sorter;
+
+		/// <summary>
+		/// The new index of each point when <see cref="connect"/> is remapped.
+		/// </summary>
+		std::vector <uint32_t> pointsScratch;
+
+		/// <summary>
+		/// Scratch destinations for <see cref="gather"/>.
+		/// </summary>
+		std::vector <float> floatScratch;
+
+		/// <summary>
+		/// Scratch destinations for <see cref="gather"/>.
+		/// </summary>
+		std::vector <unsigned int> radixValScratch;
+
+		/// <summary>
+		/// Scratch destination for the remapped <see cref="connect"/>.
+		/// </summary>
+		std::vector <uint32_t> connectScratch;
+	};
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "LightBlocker.h"
+
+namespace lighting
+{
+	class LightLayer;
+
+	/// <summary>
+	/// Blocks light with the solid tiles of a grid.  Only the edges between a solid and an empty tile are added to the <see cref="owner"/>, and each straight run of them along
+	/// a row or column boundary is merged into one line, so a wall of many tiles costs a handful of lines instead of four per tile.
+	/// </summary>
+	/// <para>
+	/// Changing a tile only marks the two row boundaries and two column boundaries around it, <see cref="update()"/> then replaces the lines of the marked boundaries in one batch.
+	/// The lines are one sided with the solid tiles behind them, so a <see cref="CircleLightSource"/> drops the ones facing away from it.
+	/// </para>
+	class TileBlockerMap
+	{
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="TileBlockerMap"/> class with every tile empty.
+		/// </summary>
+		/// <param name="owner">The <see cref="LightLayer"/> the lines are added to.</param>
+		/// <param name="columns">The number of tiles in a row.</param>
+		/// <param name="rows">The number of tiles in a column.</param>
+		/// <param name="tileSize">The width and height of a tile.</param>
+		/// <param name="x">The horizontal position of the left edge of the grid.</param>
+		/// <param name="y">The vertical position of the top edge of the grid.</param>
+		TileBlockerMap(LightLayer* owner, size_t columns, size_t rows, float tileSize, float x = 0, float y = 0);
+
+		/// <summary>
+		/// Sets if the tile at <paramref name="column"/>, <paramref name="row"/> blocks light.  Takes effect at the next <see cref="update()"/>.
+		/// </summary>
+		/// <param name="column">The column of the tile.</param>
+		/// <param name="row">The row of the tile.</param>
+		/// <param name="solid"><c>true</c> if the tile blocks light.</param>
+		void setSolid(size_t column, size_t row, bool solid);
+
+		/// <summary>
+		/// Sets every tile at once.  Takes effect at the next <see cref="update()"/>, which only replaces the lines around the tiles that changed.
+		/// </summary>
+		/// <param name="tiles">Nonzero for the solid tiles, row after row.  Must have <see cref="columns"/> * <see cref="rows"/> elements.</param>
+		void setTiles(const std::vector<uint8_t>& tiles);
+
+		/// <summary>
+		/// Checks if the tile at <paramref name="column"/>, <paramref name="row"/> blocks light.
+		/// </summary>
+		/// <param name="column">The column of the tile.</param>
+		/// <param name="row">The row of the tile.</param>
+		/// <returns><c>true</c> if the tile is solid.</returns>
+		bool isSolid(size_t column, size_t row) const
+		{
+			return tiles[row * columns + column] != 0;
+		}
+
+		/// <summary>
+		/// Replaces the lines of every boundary a changed tile touches.  Call before <see cref="LightLayer::detach()"/> once the tiles of the frame are set.
+		/// </summary>
+		void update();
+
+		/// <summary>
+		/// Gets the number of lines added to the <see cref="owner"/>.
+		/// </summary>
+		/// <returns>The number of merged edges.</returns>
+		size_t getNumLightBlockers() const
+		{
+			return numLightBlockers;
+		}
+
+		/// <summary>
+		/// Finalizes an instance of the <see cref="TileBlockerMap"/> class.  Removes every line from the <see cref="owner"/>.
+		/// </summary>
+		~TileBlockerMap();
+
+	private:
+		/// <summary>
+		/// Which side of an edge the solid tile is on.
+		/// </summary>
+		enum EdgeSide : uint8_t
+		{
+			NO_EDGE,
+			SOLID_BEFORE,	//The tile above or to the left is solid
+			SOLID_AFTER	//The tile below or to the right is solid
+		};
+
+		/// <summary>
+		/// Checks if a tile is solid, tiles outside of the grid are empty.
+		/// </summary>
+		/// <param name="column">The column of the tile, may be -1 or <see cref="columns"/>.</param>
+		/// <param name="row">The row of the tile, may be -1 or <see cref="rows"/>.</param>
+		/// <returns><c>true</c> if the tile is in the grid and solid.</returns>
+		bool isSolidOrOutside(long long column, long long row) const
+		{
+			return column >= 0 && row >= 0 && column < (long long)columns && row < (long long)rows && isSolid((size_t)column, (size_t)row);
+		}
+
+		/// <summary>
+		/// Marks the boundaries around the tile at <paramref name="column"/>, <paramref name="row"/> to be replaced by <see cref="update()"/>.
+		/// </summary>
+		/// <param name="column">The column of the tile.</param>
+		/// <param name="row">The row of the tile.</param>
+		void markTileDirty(size_t column, size_t row);
+
+		/// <summary>
+		/// Appends the merged edges of a boundary to <paramref name="lines"/>, relative to <see cref="x"/>, <see cref="y"/>.
+		/// </summary>
+		/// <param name="boundaryI">Less than <see cref="rows"/> + 1 for the row boundary at that index, otherwise the column boundary <see cref="rows"/> + 1 before.</param>
+		/// <param name="lines">Receives the edges.</param>
+		void appendBoundaryEdges(size_t boundaryI, std::vector<BlockerLine>& lines) const;
+
+		/// <summary>
+		/// The <see cref="LightLayer"/> the lines are added to.
+		/// </summary>
+		LightLayer* owner;
+
+		/// <summary>
+		/// The number of tiles in a row.
+		/// </summary>
+		size_t columns;
+
+		/// <summary>
+		/// The number of tiles in a column.
+		/// </summary>
+		size_t rows;
+
+		/// <summary>
+		/// The width and height of a tile.
+		/// </summary>
+		float tileSize;
+
+		/// <summary>
+		/// The position of the top left corner of the grid.
+		/// </summary>
+		float x, y;
+
+		/// <summary>
+		/// Nonzero for the solid tiles, row after row.
+		/// </summary>
+		std::vector<uint8_t> tiles;
+
+		/// <summary>
+		/// The handles of the lines on each boundary, the <see cref="rows"/> + 1 row boundaries followed by the <see cref="columns"/> + 1 column boundaries.
+		/// </summary>
+		std::vector<std::vector<BlockerHandle>> boundaryHandles;
+
+		/// <summary>
+		/// Nonzero for the elements of <see cref="boundaryHandles"/> to replace at the next <see cref="update()"/>.
+		/// </summary>
+		std::vector<uint8_t> dirtyBoundaries;
+
+		/// <summary>
+		/// The number of nonzero elements of <see cref="dirtyBoundaries"/>.
+		/// </summary>
+		size_t numDirtyBoundaries;
+
+		/// <summary>
+		/// The total size of the elements of <see cref="boundaryHandles"/>.
+		/// </summary>
+		size_t numLightBlockers;
+	};
+}
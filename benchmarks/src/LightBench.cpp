@@ -0,0 +1,322 @@
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_image.h>
+#include <allegro5/allegro_primitives.h>
+#include <CircleLightSource.h>
+#include <LightBlockerContainer.h>
+#include <LightExecutor.h>
+#include <LightLayer.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace lighting;
+
+namespace
+{
+	const int LAYER_WIDTH = 1920;
+	const int LAYER_HEIGHT = 1080;
+	const double LAYER_SCALE = .5;
+	const int DEFAULT_FRAMES = 20;
+
+	/// <summary>
+	/// Runs every task on the thread that submits it, so a scene is timed on a single core and <see cref="LightLayer::detach()"/> returns with the shadows processed.
+	/// </summary>
+	class InlineExecutor : public LightExecutor
+	{
+	public:
+		void submit(std::function<void()> task) override
+		{
+			task();
+		}
+
+		size_t getConcurrency() override
+		{
+			return 1;
+		}
+	};
+
+	InlineExecutor Inline;
+
+	double GetMillisSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	/// <summary>
+	/// Detaches and draws a frame of <paramref name="lightLayer"/>.  Only the detach is timed, with the <see cref="InlineExecutor"/> it processes every shadow of the frame.
+	/// </summary>
+	/// <returns>The milliseconds the shadows took.</returns>
+	double RunFrame(LightLayer* lightLayer)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		lightLayer->detach();
+		double millis = GetMillisSince(start);
+		lightLayer->draw();
+		al_flip_display();
+		return millis;
+	}
+
+	/// <summary>
+	/// 50k blockers and 200 moving lights over a 5000 x 2500 level, where each light only reaches a few of the blockers.
+	/// </summary>
+	void RunGridScene(int frames)
+	{
+		LightLayer* lightLayer = new LightLayer(LAYER_WIDTH, LAYER_HEIGHT, LAYER_SCALE, Inline);
+		std::vector <LightBlockerContainer*> containers;
+		for (int i = 0; i < 125; i++)
+		{
+			for (int j = 0; j < 100; j++)
+			{
+				LightBlockerContainer* container = new LightBlockerContainer(lightLayer);
+				container->initSquare(8, 8);
+				container->setXY(i * 40 + (j % 3) * 7, j * 25);
+				containers.push_back(container);
+			}
+		}
+		srand(7);
+		std::vector <CircleLightSource*> lights;
+		for (int i = 0; i < 200; i++)
+		{
+			lights.push_back(new CircleLightSource(lightLayer, 100 + rand() % 100));
+		}
+		std::vector <float> lightX;
+		std::vector <float> lightY;
+		for (size_t i = 0; i < lights.size(); i++)
+		{
+			lightX.push_back(rand() % 5000);
+			lightY.push_back(rand() % 2500);
+		}
+		//The first frame fills the caches of the layer and the lights, so it isn't counted
+		double totalMillis = 0;
+		for (int f = 0; f <= frames; f++)
+		{
+			for (size_t i = 0; i < lights.size(); i++)
+			{
+				lights[i]->setXY(lightX[i] + f * 3, lightY[i] + f * 2);
+			}
+			double millis = RunFrame(lightLayer);
+			if (f > 0)
+			{
+				totalMillis += millis;
+			}
+		}
+		std::cout << "blockers " << lightLayer->getNumLightBlockers() << " lights " << lights.size() << " avg shadow ms per frame " << totalMillis / frames << std::endl;
+		for (size_t i = 0; i < lights.size(); i++)
+		{
+			delete lights[i];
+		}
+		for (size_t i = 0; i < containers.size(); i++)
+		{
+			delete containers[i];
+		}
+		delete lightLayer;
+	}
+
+	/// <summary>
+	/// 100k blockers over a 10000 x 2500 level, all moved every frame, with 200 moving lights.  The blockers are created between other allocations like a game would,
+	/// so how they are stored decides how scattered they are in memory.
+	/// </summary>
+	void RunBlockerStorageScene(int frames)
+	{
+		LightLayer* lightLayer = new LightLayer(LAYER_WIDTH, LAYER_HEIGHT, LAYER_SCALE, Inline);
+		std::vector <LightBlockerContainer*> containers;
+		std::vector <void*> otherAllocations;
+		for (int i = 0; i < 250; i++)
+		{
+			for (int j = 0; j < 100; j++)
+			{
+				LightBlockerContainer* container = new LightBlockerContainer(lightLayer);
+				container->initSquare(8, 8);
+				container->setXY(i * 40 + (j % 3) * 7, j * 25);
+				containers.push_back(container);
+				otherAllocations.push_back(malloc(64 + rand() % 256));
+			}
+		}
+		srand(7);
+		std::vector <CircleLightSource*> lights;
+		for (int i = 0; i < 200; i++)
+		{
+			lights.push_back(new CircleLightSource(lightLayer, 100 + rand() % 100));
+		}
+		std::vector <float> lightX;
+		std::vector <float> lightY;
+		for (size_t i = 0; i < lights.size(); i++)
+		{
+			lightX.push_back(rand() % 10000);
+			lightY.push_back(rand() % 2500);
+		}
+		double totalMoveMillis = 0;
+		double totalMillis = 0;
+		for (int f = 0; f <= frames; f++)
+		{
+			for (size_t i = 0; i < lights.size(); i++)
+			{
+				lights[i]->setXY(lightX[i] + f * 3, lightY[i] + f * 2);
+			}
+			std::chrono::steady_clock::time_point moveStart = std::chrono::steady_clock::now();
+			//Every blocker moves back and forth by a pixel, so every frame has to copy all of them
+			for (size_t i = 0; i < containers.size(); i++)
+			{
+				containers[i]->setXY((i / 100) * 40 + ((i % 100) % 3) * 7 + (f & 1), (i % 100) * 25);
+			}
+			double moveMillis = GetMillisSince(moveStart);
+			double millis = RunFrame(lightLayer);
+			if (f > 0)
+			{
+				totalMoveMillis += moveMillis;
+				totalMillis += millis;
+			}
+		}
+		std::cout << "blockers " << lightLayer->getNumLightBlockers() << " lights " << lights.size() << " avg move all ms " << totalMoveMillis / frames
+			<< " avg shadow ms per frame " << totalMillis / frames << std::endl;
+		for (size_t i = 0; i < lights.size(); i++)
+		{
+			delete lights[i];
+		}
+		for (size_t i = 0; i < containers.size(); i++)
+		{
+			delete containers[i];
+		}
+		for (size_t i = 0; i < otherAllocations.size(); i++)
+		{
+			free(otherAllocations[i]);
+		}
+		delete lightLayer;
+	}
+
+	/// <summary>
+	/// Creates <paramref name="numLines"/> lines around a light at 1000, 1000 in a 1800 x 1800 area.  <paramref name="layout"/> is "picket" for short lines close around the light
+	/// with gaps between them in front of long parallel lines, "horizontal" for only the long parallel lines, and anything else for short lines in random directions, one per grid cell.
+	/// </summary>
+	std::vector <BlockerLine> CreateSweepLines(int numLines, const std::string& layout)
+	{
+		std::vector <BlockerLine> lines;
+		std::mt19937 random(5);
+		std::uniform_real_distribution <float> distribution(0, 1);
+		int cellsPerSide = (int)ceil(sqrt((double)numLines));
+		float cellSize = 1800.0f / cellsPerSide;
+		for (int i = 0; i < numLines; i++)
+		{
+			if (layout == "picket" && i % 2 == 0)
+			{
+				//The sweep keeps falling through the gaps to the lines behind
+				float angle = 6.2831853f * i / numLines;
+				float radius = 60 + 80 * distribution(random);
+				float halfAngle = 3.14159265f / numLines;
+				BlockerLine line = { 1000 + radius * cosf(angle - halfAngle), 1000 + radius * sinf(angle - halfAngle), 1000 + radius * cosf(angle + halfAngle), 1000 + radius * sinf(angle + halfAngle) };
+				lines.push_back(line);
+			}
+			else if (layout == "picket" || layout == "horizontal")
+			{
+				//A ray from the light crosses many of them
+				float y = 100 + 1800.0f * i / numLines;
+				if (layout == "picket" && fabsf(y - 1000) < 300)
+				{
+					y += y < 1000 ? -300 : 300;
+				}
+				float x1 = 100 + distribution(random) * 1700;
+				float x2 = 100 + distribution(random) * 1700;
+				BlockerLine line = { x1, y, x2, y };
+				lines.push_back(line);
+			}
+			else
+			{
+				float cellX = 100 + (i % cellsPerSide) * cellSize;
+				float cellY = 100 + (i / cellsPerSide) * cellSize;
+				float x1 = cellX + distribution(random) * cellSize * .9f;
+				float y1 = cellY + distribution(random) * cellSize * .9f;
+				float x2 = cellX + distribution(random) * cellSize * .9f;
+				float y2 = cellY + distribution(random) * cellSize * .9f;
+				BlockerLine line = { x1, y1, x2, y2 };
+				lines.push_back(line);
+			}
+		}
+		return lines;
+	}
+
+	/// <summary>
+	/// One light of radius 1000 swept as a single chunk over lines with <paramref name="endpoints"/> endpoints.  Reports how many lines each shadow cast checks,
+	/// which is what grows with the number of endpoints when the lines crossed by the sweep ray aren't kept in order.
+	/// </summary>
+	void RunSweepScene(int endpoints, const std::string& layout, int frames)
+	{
+		LightLayer* lightLayer = new LightLayer(LAYER_WIDTH, LAYER_HEIGHT, LAYER_SCALE, Inline);
+		CircleLightSource* light = new CircleLightSource(lightLayer, 1000);
+		light->setMaxSweepChunks(1);
+		std::vector <BlockerLine> lines = CreateSweepLines(endpoints / 2, layout);
+		std::vector <BlockerHandle> handles(lines.size());
+		lightLayer->addLightBlockers(lines.data(), lines.size(), handles.data());
+		double totalMillis = 0;
+		uint64_t shadowCasts = 0;
+		uint64_t castPointsChecked = 0;
+		for (int f = 0; f <= frames; f++)
+		{
+			//Moved a little so the light isn't skipped for having the same inputs
+			light->setXY(1000 + f * .01f, 1000 + f * .01f);
+			uint64_t prevShadowCasts = CircleLightSource::ShadowCalled;
+			uint64_t prevCastPointsChecked = CircleLightSource::CastPointsProcessed;
+			double millis = RunFrame(lightLayer);
+			if (f > 0)
+			{
+				totalMillis += millis;
+				shadowCasts += CircleLightSource::ShadowCalled - prevShadowCasts;
+				castPointsChecked += CircleLightSource::CastPointsProcessed - prevCastPointsChecked;
+			}
+		}
+		std::cout << "endpoints " << lines.size() * 2 << " layout " << layout << " avg shadow ms per frame " << totalMillis / frames << " shadow casts " << shadowCasts
+			<< " lines checked per cast " << (shadowCasts > 0 ? (double)castPointsChecked / shadowCasts : 0) << std::endl;
+		delete light;
+		lightLayer->removeLightBlockers(handles.data(), handles.size());
+		delete lightLayer;
+	}
+}
+
+/// <summary>
+/// Times the scenes the performance work on Lighting4 was measured with, on a single core.  Run the same scene on the commits before and after a change to compare them.
+/// Usage: LightBench grid|blockers [frames], or LightBench sweep endpoints [picket|horizontal|cells] [frames]
+/// </summary>
+int main(int argc, char** argv)
+{
+	std::string scene = argc > 1 ? argv[1] : "";
+	//The sweep scene takes its endpoints and layout before the number of frames
+	int framesArg = scene == "sweep" ? 4 : 2;
+	int frames = argc > framesArg ? atoi(argv[framesArg]) : DEFAULT_FRAMES;
+	if (frames <= 0)
+	{
+		frames = DEFAULT_FRAMES;
+	}
+	al_init();
+	al_init_image_addon();
+	al_init_primitives_addon();
+	ALLEGRO_DISPLAY* display = al_create_display(LAYER_WIDTH, LAYER_HEIGHT);
+	if (display == nullptr)
+	{
+		std::cout << "Could not create a display" << std::endl;
+		return 1;
+	}
+	int result = 0;
+	if (scene == "grid")
+	{
+		RunGridScene(frames);
+	}
+	else if (scene == "blockers")
+	{
+		RunBlockerStorageScene(frames);
+	}
+	else if (scene == "sweep" && argc > 2 && atoi(argv[2]) > 0)
+	{
+		RunSweepScene(atoi(argv[2]), argc > 3 ? argv[3] : "cells", frames);
+	}
+	else
+	{
+		std::cout << "Usage: LightBench grid|blockers [frames]" << std::endl;
+		std::cout << "       LightBench sweep endpoints [picket|horizontal|cells] [frames]" << std::endl;
+		result = 1;
+	}
+	al_destroy_display(display);
+	return result;
+}
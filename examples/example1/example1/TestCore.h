@@ -15,6 +15,12 @@ class TestCore : public Core
 {
 public:
 	static const int LS_SIZE = 4;
+	static const int STATIC_LS_SIZE = 40;
+	static const int STATIC_LS_RADIUS = 150;
+	static const int PIPELINE_DEPTH = 1;
+	static const uint64_t FRAME_BUDGET_NANOS = 12000000;
+	static const int IDLE_FRAMES = 300;
+	static const int IDLE_FRAME_MILLIS = 5;
 	TestCore();
 
 	bool init() override;
@@ -31,6 +37,7 @@ private:
 	GaussianBlurrer* blurrer;
 	LightLayer* lightLayer;
 	std::vector <CircleLightSource*> lightSources;
+	std::vector <CircleLightSource*> staticLightSources;
 	AboveLightSource* sun;
 	int drawCount;
 	float lightVX;
@@ -38,7 +45,17 @@ private:
 	float lightX, lightY;
 	int passes;
 	void handlePass();
+	void measureIdleFrames();
 	void generateReport();
 	uint64_t startTimeMillis;
+	uint64_t startCpuMicros;
+	uint64_t idleCpuMicros;
+	uint64_t idleTaskLatencyNanos;
+	uint64_t idleTaskCount;
+	uint64_t idleTasksRunByCaller;
+	size_t idleSkippedLights;
+	std::vector <uint64_t> frameNanos;
+	std::vector <size_t> frameDeferredLights;
+	std::vector <size_t> frameSkippedLights;
 	std::vector <LightBlockerContainer*> lbcs;
 };
\ No newline at end of file
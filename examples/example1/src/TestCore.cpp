@@ -1,9 +1,26 @@
 #include "TestCore.h"
+#include <LightThreadPool.h>
 #include <Windows.h>
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+//User and kernel time of every thread in the process, so sleeping workers show up as saved CPU time
+static uint64_t getProcessCpuMicros()
+{
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+	GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime);
+	ULARGE_INTEGER kernel, user;
+	kernel.LowPart = kernelTime.dwLowDateTime;
+	kernel.HighPart = kernelTime.dwHighDateTime;
+	user.LowPart = userTime.dwLowDateTime;
+	user.HighPart = userTime.dwHighDateTime;
+	return (kernel.QuadPart + user.QuadPart) / 10;	//FILETIME is in 100ns units
+}
 
 TestCore::TestCore()
-	:Core(""), kernelData(43, 9), drawCount(0), lightLayer(nullptr), lightX(STANDARD_WIDTH / 2), lightY(STANDARD_HEIGHT / 2), lightVX(1), lightVY(0), passes(0)
+	:Core(""), kernelData(43, 9), drawCount(0), lightLayer(nullptr), lightX(STANDARD_WIDTH / 2), lightY(STANDARD_HEIGHT / 2), lightVX(1), lightVY(0), passes(0), idleCpuMicros(0), idleTaskLatencyNanos(0), idleTaskCount(0), idleTasksRunByCaller(0), idleSkippedLights(0)
 {
 
 }
@@ -16,11 +33,25 @@ bool TestCore::init()
 		fpsLogger = new FPSLogger(1);
 		std::cout << kernelData.pixelOffsets.size() << std::endl;
 		lightLayer = new LightLayer(STANDARD_WIDTH, STANDARD_HEIGHT, .5, 4);
+		//Shadows lag a frame behind so the workers process the next frame while this one is drawn
+		lightLayer->setPipelineDepth(PIPELINE_DEPTH);
+		//Static lights give up their turn first when the shadows run past the budget
+		lightLayer->setFrameBudget(FRAME_BUDGET_NANOS);
 		for (int i = 0; i < LS_SIZE; i++)
 		{
 			CircleLightSource* circleLightSource = new CircleLightSource(lightLayer, 900);
+			//The big lights dominate the frame, so let each of them use every worker
+			circleLightSource->setMaxSweepChunks(LightSource::SWEEP_CHUNKS_TO_CONCURRENCY);
+			circleLightSource->setPriority(1);
 			lightSources.push_back(circleLightSource);
 		}
+		for (int i = 0; i < STATIC_LS_SIZE; i++)
+		{
+			CircleLightSource* staticLightSource = new CircleLightSource(lightLayer, STATIC_LS_RADIUS);
+			//10% of the static lights sit in the dense rows of small blockers, the rest are in the open
+			staticLightSource->setXY(100 + i * 45, (i % 10 == 0) ? 770 : 150);
+			staticLightSources.push_back(staticLightSource);
+		}
 		//blurrer = new GaussianBlurrer(lightLayer, kernelData, "VertShader.hlsl", "XFragShader.hlsl", "YFragShader.hlsl");
 		populateLBC(0, 100, 1, 1, 2100, 70);
 		populateLBC(0, 200, 50, 1, 50, 70);
@@ -40,6 +71,7 @@ void TestCore::draw()
 	if (drawCount == 0)
 	{
 		startTimeMillis = GetTickCount64();
+		startCpuMicros = getProcessCpuMicros();
 	}
 	lightX += lightVX * rate;
 	lightY += lightVY * rate;
@@ -50,6 +82,9 @@ void TestCore::draw()
 
 	lightLayer->detach();
 	lightLayer->draw();
+	frameNanos.push_back(lightLayer->getLastFrameNanos());
+	frameDeferredLights.push_back(lightLayer->getLastFrameDeferredLights());
+	frameSkippedLights.push_back(lightLayer->getLastFrameSkippedLights());
 	fpsLogger->draw(10, 30, 25);
 	drawCount++;
 	if (lightX > STANDARD_WIDTH)
@@ -112,6 +147,7 @@ void TestCore::handlePass()
 	}
 	else
 	{
+		measureIdleFrames();
 		generateReport();
 		system("pause");
 		for (int i = 0; i < lbcs.size(); i++)
@@ -130,10 +166,37 @@ void TestCore::handlePass()
 	}
 }
 
+void TestCore::measureIdleFrames()
+{
+	//Nothing moves from here on, so every light is skipped and the workers only wake for the tasks that find that out.
+	//The frames still in the pipeline are let through first so they aren't counted
+	for (int i = 0; i <= PIPELINE_DEPTH; i++)
+	{
+		lightLayer->detach();
+		lightLayer->draw();
+	}
+	uint64_t cpuStart = getProcessCpuMicros();
+	uint64_t taskLatencyStart = LightThreadPool::TaskLatencyNanos;
+	uint64_t taskCountStart = LightThreadPool::TaskCount;
+	uint64_t tasksRunByCallerStart = LightThreadPool::TasksRunByCaller;
+	for (int i = 0; i < IDLE_FRAMES; i++)
+	{
+		lightLayer->detach();
+		//Lets the workers take the tasks and go back to sleep before the next frame, so the tasks measure how long a sleeping worker takes to wake
+		std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_FRAME_MILLIS));
+		lightLayer->draw();
+		idleSkippedLights += lightLayer->getLastFrameSkippedLights();
+	}
+	idleCpuMicros = getProcessCpuMicros() - cpuStart;
+	idleTaskLatencyNanos = LightThreadPool::TaskLatencyNanos - taskLatencyStart;
+	idleTaskCount = LightThreadPool::TaskCount - taskCountStart;
+	idleTasksRunByCaller = LightThreadPool::TasksRunByCaller - tasksRunByCallerStart;
+}
+
 void TestCore::generateReport()
 {
 	std::cout << std::endl << "STANDARD VARIABLE REPORT: " << std::endl;
-	std::cout << "NUM LIGHT SOURCES: " << lightSources.size() << std::endl;
+	std::cout << "NUM LIGHT SOURCES: " << lightSources.size() + staticLightSources.size() << std::endl;
 	std::cout << "NUM LIGHT BLOCKERS: " << lightLayer->getNumLightBlockers() << std::endl;
 	std::cout << "NUM LIGHT BLOCKER CONTAINER: " << lbcs.size() << std::endl << std::endl;
 	std::cout << "CIRLCE LIGHT SOURCE PERFORMANCE REPORT: " << std::endl;
@@ -144,5 +207,35 @@ void TestCore::generateReport()
 	std::cout << "AVG MS: " << (GetTickCount64() - startTimeMillis) / (float)drawCount << std::endl;
 	std::cout << "AVG FPS: " << 1000.0f / ((GetTickCount64() - startTimeMillis) / (float)drawCount) << std::endl;
 	std::cout << "Total # of DRAW CALLS: " << drawCount << std::endl;
-	std::cout << "Total MS: " << GetTickCount64() - startTimeMillis << std::endl;
+	std::cout << "Total MS: " << GetTickCount64() - startTimeMillis << std::endl << std::endl;
+	std::cout << "THREAD REPORT: " << std::endl;
+	std::cout << "PIPELINE DEPTH: " << lightLayer->getPipelineDepth() << std::endl;
+	std::cout << "AVG CPU MS PER FRAME (all threads): " << (getProcessCpuMicros() - startCpuMicros) / 1000.0f / (float)drawCount << std::endl;
+	std::cout << "AVG TASK START LATENCY US: " << (LightThreadPool::TaskLatencyNanos / 1000.0f) / (float)LightThreadPool::TaskCount << std::endl;
+	std::cout << "TASKS STOLEN: " << LightThreadPool::TasksStolen << std::endl;
+	std::cout << "TASKS RUN BY DRAW THREAD: " << LightThreadPool::TasksRunByCaller << std::endl;
+	std::sort(frameNanos.begin(), frameNanos.end());
+	std::cout << "SHADOW FRAME MS P50: " << frameNanos.at(frameNanos.size() / 2) / 1000000.0f << std::endl;
+	std::cout << "SHADOW FRAME MS P99: " << frameNanos.at((frameNanos.size() * 99) / 100) / 1000000.0f << std::endl;
+	std::sort(frameDeferredLights.begin(), frameDeferredLights.end());
+	size_t totalDeferredLights = 0;
+	for (size_t i = 0; i < frameDeferredLights.size(); i++)
+	{
+		totalDeferredLights += frameDeferredLights.at(i);
+	}
+	std::cout << "FRAME BUDGET MS: " << FRAME_BUDGET_NANOS / 1000000.0f << std::endl;
+	std::cout << "AVG DEFERRED LIGHTS PER FRAME: " << totalDeferredLights / (float)frameDeferredLights.size() << std::endl;
+	std::cout << "MAX DEFERRED LIGHTS PER FRAME: " << frameDeferredLights.back() << std::endl;
+	size_t totalSkippedLights = 0;
+	for (size_t i = 0; i < frameSkippedLights.size(); i++)
+	{
+		totalSkippedLights += frameSkippedLights.at(i);
+	}
+	std::cout << "AVG UNCHANGED LIGHTS SKIPPED PER FRAME: " << totalSkippedLights / (float)frameSkippedLights.size() << std::endl << std::endl;
+	std::cout << "IDLE FRAME REPORT: " << std::endl;
+	std::cout << "IDLE FRAMES: " << IDLE_FRAMES << std::endl;
+	std::cout << "AVG UNCHANGED LIGHTS SKIPPED PER IDLE FRAME: " << idleSkippedLights / (float)IDLE_FRAMES << std::endl;
+	std::cout << "AVG CPU MS PER IDLE FRAME (all threads): " << idleCpuMicros / 1000.0f / (float)IDLE_FRAMES << std::endl;
+	std::cout << "AVG IDLE WAKE LATENCY US: " << (idleTaskLatencyNanos / 1000.0f) / (float)idleTaskCount << std::endl;
+	std::cout << "IDLE TASKS RUN BY DRAW THREAD: " << idleTasksRunByCaller << std::endl;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "LightLayer.h"
 #include <allegro5/allegro.h>
 #include <allegro5/allegro_primitives.h>
+#include <algorithm>
 
 namespace lighting
 {
@@ -18,48 +19,20 @@ namespace lighting
 
 	AboveLightSource::~AboveLightSource()
 	{
+		//Frames still in flight call the methods of this class, so they must finish before its members go
+		removeFromOwner();
 	}
 
-	void AboveLightSource::countingSortShadePoints(int bI)
+	bool AboveLightSource::checkPointFront(uint32_t alphaPoint, uint32_t checkPoint) const
 	{
-		std::vector <unsigned int> counts(RADIX_BASE_NUM);
-		for (int i = 0; i < shadePoints.size(); i++)
-		{
-			int countIdx = (shadePoints[i]->radixVal >> bI) & 0xF;
-			counts.at(countIdx)++;
-		}
-
-		for (int i = 1; i < RADIX_BASE_NUM; i++)
-		{
-			counts.at(i) += counts.at(i - 1);
-		}
-
-		std::vector<AboveShadePoint*> output(shadePoints.size());
-		for (int i = shadePoints.size() - 1; i >= 0; i--)
-		{
-			int countIdx = (shadePoints[i]->radixVal >> bI) & 0xF;
-			output[counts[countIdx] - 1] = shadePoints[i];
-			counts[countIdx]--;
-		}
-		for (int i = 0; i < shadePoints.size(); i++)
-		{
-			shadePoints[i] = output[i];
-		}
-	}
-
-	void AboveLightSource::radixSortShadePoints()
-	{
-		for (int bI = 0; bI < RADIX_MAX_BITS; bI += RADIX_BASE_BITS)
-		{
-			countingSortShadePoints(bI);
-		}
+		return !shadePoints.checkCross(alphaPoint, shadePoints.x[checkPoint], -(BOUND_OFF + LINE_CHECK_OFF), shadePoints.x[checkPoint], shadePoints.y[checkPoint]);
 	}
 
-	bool AboveLightSource::CheckPointFront(AboveShadePoint * alphaPoint, AboveShadePoint * checkPoint)
+	unsigned int AboveLightSource::GetRadixVal(float x, int minX, int maxX)
 	{
-		float cX;
-		float cY;
-		return !alphaPoint->checkIntersect(checkPoint->x, -(BOUND_OFF + LINE_CHECK_OFF), checkPoint->x, checkPoint->y, cX, cY);
+		float range = maxX - minX;
+		float normalizedX = x - minX;
+		return (normalizedX / range) * RADIX_MAX_NUM;
 	}
 
 	void AboveLightSource::createShadePoints()
@@ -67,12 +40,14 @@ namespace lighting
 		resetPoints();
 		int minX = getMinX();
 		int maxX = getMaxX();
-		for (auto it = owner->lightBlockers.begin(); it != owner->lightBlockers.end(); it++)
+		const LayerFrame& layerFrame = owner->frames.at(computeSlot);
+		const std::vector <BlockerLine>& blockerLines = layerFrame.blockers->blockerLines;
+		for (auto it = blockerLines.begin(); it != blockerLines.end(); it++)
 		{
-			float x1 = (*it)->x1;
-			float y1 = (*it)->y1;
-			float x2 = (*it)->x2;
-			float y2 = (*it)->y2;
+			float x1 = it->x1;
+			float y1 = it->y1;
+			float x2 = it->x2;
+			float y2 = it->y2;
 			if (x1 < minX && x2 < minX)
 			{
 				continue;
@@ -81,35 +56,30 @@ namespace lighting
 			{
 				continue;
 			}
-			AboveShadePoint* sp1 = new AboveShadePoint(x1, y1, minX, maxX);
-			AboveShadePoint* sp2 = new AboveShadePoint(x2, y2, minX, maxX);
-			sp1->setConnectPoint(sp2);
-			sp2->setConnectPoint(sp1);
+			unsigned int radixVal1 = GetRadixVal(x1, minX, maxX);
+			unsigned int radixVal2 = GetRadixVal(x2, minX, maxX);
 			if (x1 < minX)
 			{
-				sp1->x = minX;
-				castPoints.emplace(sp1);
+				x1 = minX;
 			}
 			else if (x2 < minX)
 			{
-				sp2->x = minX;
-				castPoints.emplace(sp2);
+				x2 = minX;
 			}
 			if (x1 > maxX)
 			{
-				sp1->x = maxX;
+				x1 = maxX;
 			}
 			else if (x2 > maxX)
 			{
-				sp2->x = maxX;
+				x2 = maxX;
 			}
-			shadePoints.push_back(sp1);
-			shadePoints.push_back(sp2);
+			shadePoints.addLine(x1, y1, radixVal1, x2, y2, radixVal2);
 		}
-		for (auto it = owner->aboveLightBlockers.begin(); it != owner->aboveLightBlockers.end(); it++)
+		for (auto it = layerFrame.aboveBlockerLines.begin(); it != layerFrame.aboveBlockerLines.end(); it++)
 		{
-			float x1 = (*it)->x1;
-			float x2 = (*it)->x2;
+			float x1 = it->x1;
+			float x2 = it->x2;
 			if (x1 < minX && x2 < minX)
 			{
 				continue;
@@ -118,60 +88,121 @@ namespace lighting
 			{
 				continue;
 			}
-			AboveShadePoint* sp1 = new AboveShadePoint(x1, ABOVE_LIGHT_BLOCKER_Y, minX, maxX);
-			AboveShadePoint* sp2 = new AboveShadePoint(x2, ABOVE_LIGHT_BLOCKER_Y, minX, maxX);	
-			sp1->setConnectPoint(sp2);
-			sp2->setConnectPoint(sp1);
+			unsigned int radixVal1 = GetRadixVal(x1, minX, maxX);
+			unsigned int radixVal2 = GetRadixVal(x2, minX, maxX);
 			if (x1 < minX)
 			{
-				sp1->x = minX;
-				castPoints.emplace(sp1);
+				x1 = minX;
 			}
 			else if (x2 < minX)
 			{
-				sp2->x = minX;
-				castPoints.emplace(sp2);
+				x2 = minX;
 			}
 			if (x1 > maxX)
 			{
-				sp1->x = maxX;
+				x1 = maxX;
 			}
 			else if (x2 > maxX)
 			{
-				sp2->x = maxX;
+				x2 = maxX;
 			}
-			shadePoints.push_back(sp1);
-			shadePoints.push_back(sp2);
+			shadePoints.addLine(x1, ABOVE_LIGHT_BLOCKER_Y, radixVal1, x2, ABOVE_LIGHT_BLOCKER_Y, radixVal2);
 		}
-		radixSortShadePoints();
+		shadePoints.sortByRadixVal<RADIX_MAX_BITS, RADIX_BASE_BITS>();
 	}
 
 	void AboveLightSource::mapShadePoints()
 	{
-		AboveShadePoint* alphaPoint = nullptr;
-		int i = 0;
+		createSweepChunks(1);
+		mapSweepChunk(0);
+		stitchSweepChunks();
+	}
+
+	size_t AboveLightSource::createSweepChunks(size_t maxChunks)
+	{
+		size_t numChunks = std::min(maxChunks, shadePoints.size() / MIN_SWEEP_CHUNK_SHADE_POINTS);
+		if (numChunks < 1)
+		{
+			numChunks = 1;
+		}
+		sweepChunks.resize(numChunks);
+		size_t chunkI = 0;
+		sweepChunks.at(0).beginI = 0;
+		sweepChunks.at(0).beginX = getMinX();
+		for (size_t splitI = 1; splitI < numChunks; splitI++)
+		{
+			size_t i = (shadePoints.size() * splitI) / numChunks;
+			//A strip can't start between two points at the same x
+			while (i < shadePoints.size() && shadePoints.radixVal[i] == shadePoints.radixVal[i - 1])
+			{
+				i++;
+			}
+			if (i >= shadePoints.size() || i <= sweepChunks.at(chunkI).beginI)
+			{
+				continue;
+			}
+			float splitX = (shadePoints.x[i - 1] + shadePoints.x[i]) / 2;
+			sweepChunks.at(chunkI).endI = i;
+			sweepChunks.at(chunkI).endX = splitX;
+			chunkI++;
+			sweepChunks.at(chunkI).beginI = i;
+			sweepChunks.at(chunkI).beginX = splitX;
+		}
+		sweepChunks.at(chunkI).endI = shadePoints.size();
+		sweepChunks.at(chunkI).endX = getMaxX();
+		sweepChunks.resize(chunkI + 1);
+		return sweepChunks.size();
+	}
+
+	void AboveLightSource::seedCastPoints(AboveSweepChunk & chunk)
+	{
+		for (uint32_t startPoint = 0; startPoint < shadePoints.size(); startPoint++)
+		{
+			if (shadePoints.x[startPoint] <= chunk.beginX && chunk.beginX < shadePoints.x[shadePoints.connect[startPoint]])
+			{
+				chunk.castPoints.insert(startPoint);
+			}
+		}
+	}
+
+	void AboveLightSource::mapSweepChunk(size_t chunkI)
+	{
+		AboveSweepChunk& chunk = sweepChunks.at(chunkI);
+		chunk.castPoints.reset(shadePoints);
+		chunk.drawPoints.clear();
+		seedCastPoints(chunk);
+		uint32_t alphaPoint = ShadePointBuffer::NO_POINT;
+		int i = chunk.beginI;
 		float alphaContactX = 0;
 		float alphaContactY = 0;
-		handleFirstShadePoints(alphaPoint, alphaContactX, alphaContactY, i);
-		for (; i < shadePoints.size(); i++)
+		if (chunkI == 0)
+		{
+			handleFirstShadePoints(chunk, alphaPoint, alphaContactX, alphaContactY, i);
+		}
+		else
+		{
+			alphaContactX = chunk.beginX;
+			alphaPoint = shadowCast(chunk, alphaContactX, alphaContactY);
+		}
+		for (; i < chunk.endI; i++)
 		{
-			if (shadePoints.at(i)->x == alphaPoint->getConnectPoint()->x)
+			if (shadePoints.x[i] == shadePoints.x[shadePoints.connect[alphaPoint]])
 			{
-				addDrawPoints(alphaContactX, alphaContactY, alphaPoint->getConnectPoint()->x, alphaPoint->getConnectPoint()->y);
-				float alphaConnectY = alphaPoint->getConnectPoint()->y;
-				bool found = getAlphaLineAtX(alphaPoint, i, alphaContactX, alphaContactY);
+				addDrawPoints(chunk, alphaContactX, alphaContactY, shadePoints.x[shadePoints.connect[alphaPoint]], shadePoints.y[shadePoints.connect[alphaPoint]]);
+				float alphaConnectY = shadePoints.y[shadePoints.connect[alphaPoint]];
+				bool found = getAlphaLineAtX(chunk, alphaPoint, i, alphaContactX, alphaContactY);
 				if (!found)
 				{
-					alphaContactX = alphaPoint->getConnectPoint()->x;
-					alphaPoint = shadowCast(alphaContactX, alphaContactY, alphaPoint);
+					alphaContactX = shadePoints.x[shadePoints.connect[alphaPoint]];
+					alphaPoint = shadowCast(chunk, alphaContactX, alphaContactY, alphaPoint);
 				}
 				else
 				{
 					if (alphaContactY > alphaConnectY)
 					{
 						float cY;
-						AboveShadePoint* contactPoint = shadowCast(alphaPoint->x, cY, alphaPoint);
-						if (cY < alphaPoint->y)
+						uint32_t contactPoint = shadowCast(chunk, shadePoints.x[alphaPoint], cY, alphaPoint);
+						if (cY < shadePoints.y[alphaPoint])
 						{
 							alphaPoint = contactPoint;
 							alphaContactY = cY;
@@ -180,25 +211,52 @@ namespace lighting
 					}
 				}
 			}
-			else if (CheckPointFront(alphaPoint, shadePoints.at(i)))
+			else if (checkPointFront(alphaPoint, i))
 			{
 				float alphaCX;
 				float alphaCY;
-				alphaPoint->checkIntersect(shadePoints.at(i)->x, -(LINE_CHECK_OFF + BOUND_OFF), shadePoints.at(i)->x, owner->drawToHeight + LINE_CHECK_OFF + BOUND_OFF, alphaCX, alphaCY);
-				addDrawPoints(alphaContactX, alphaContactY, alphaCX, alphaCY);
-				getAlphaLineAtX(alphaPoint, i, alphaContactX, alphaContactY);
+				shadePoints.checkIntersect(alphaPoint, shadePoints.x[i], -(LINE_CHECK_OFF + BOUND_OFF), shadePoints.x[i], owner->drawToHeight + LINE_CHECK_OFF + BOUND_OFF, alphaCX, alphaCY);
+				addDrawPoints(chunk, alphaContactX, alphaContactY, alphaCX, alphaCY);
+				getAlphaLineAtX(chunk, alphaPoint, i, alphaContactX, alphaContactY);
 			}
 			else
 			{
-				updateCastPoints(shadePoints.at(i));
+				updateCastPoints(chunk, i);
 			}
 		}
-		handleLastShadePoints(alphaPoint, alphaContactX, alphaContactY);
+		if (chunkI == sweepChunks.size() - 1)
+		{
+			handleLastShadePoints(chunk, alphaPoint, alphaContactX, alphaContactY);
+		}
+		else
+		{
+			//End the strip on the alpha line, the next strip's shadowCast at the same x starts from there
+			float endCX = chunk.endX;
+			float endCY = alphaContactY;
+			shadePoints.checkIntersect(alphaPoint, chunk.endX, -(LINE_CHECK_OFF + BOUND_OFF), chunk.endX, owner->drawToHeight + LINE_CHECK_OFF + BOUND_OFF, endCX, endCY);
+			addDrawPoints(chunk, alphaContactX, alphaContactY, endCX, endCY);
+		}
+	}
+
+	void AboveLightSource::stitchSweepChunks()
+	{
+		std::vector <float>& drawPoints = frameSlots.at(computeSlot).drawPoints;
+		if (sweepChunks.size() == 1)
+		{
+			drawPoints.swap(sweepChunks.at(0).drawPoints);
+			return;
+		}
+		drawPoints.clear();
+		for (size_t i = 0; i < sweepChunks.size(); i++)
+		{
+			drawPoints.insert(drawPoints.end(), sweepChunks.at(i).drawPoints.begin(), sweepChunks.at(i).drawPoints.end());
+		}
 	}
 
 	void AboveLightSource::drawToLightMap()
 	{
 		al_set_separate_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ONE, ALLEGRO_ADD, ALLEGRO_ALPHA, ALLEGRO_INVERSE_ALPHA);
+		const std::vector <float>& drawPoints = frameSlots.at(drawSlot).drawPoints;
 		for (int i = 0; i < drawPoints.size(); i += 4)
 		{
 			if (drawPoints.at(i + 1) == drawPoints.at(i + 3))
@@ -215,51 +273,42 @@ namespace lighting
 
 	void AboveLightSource::createBoundShadePoints()
 	{
-		AboveShadePoint* p1 = new AboveShadePoint(getMinX(), owner->drawToHeight + BOUND_OFF, getMinX(), getMaxX());
-		AboveShadePoint* p2 = new AboveShadePoint(getMaxX(), owner->drawToHeight + BOUND_OFF, getMinX(), getMaxX());
-		p1->setConnectPoint(p2);
-		p2->setConnectPoint(p1);
-		shadePoints.push_back(p1);
-		shadePoints.push_back(p2);
-		castPoints.emplace(p1);
+		float boundY = owner->drawToHeight + BOUND_OFF;
+		shadePoints.addLine(getMinX(), boundY, GetRadixVal(getMinX(), getMinX(), getMaxX()), getMaxX(), boundY, GetRadixVal(getMaxX(), getMinX(), getMaxX()));
 	}
 
 	void AboveLightSource::resetPoints()
 	{
-		drawPoints.clear();
-		for (int i = 0; i < shadePoints.size(); i++)
-		{
-			delete shadePoints.at(i);
-		}
+		const LayerFrame& layerFrame = owner->frames.at(computeSlot);
 		shadePoints.clear();
-		shadePoints.reserve((owner->lightBlockers.size() + owner->aboveLightBlockers.size()) * 2 + BOUND_POINTS_SIZE);
+		shadePoints.reserve((layerFrame.blockers->blockerLines.size() + layerFrame.aboveBlockerLines.size()) * 2 + BOUND_POINTS_SIZE);
 		createBoundShadePoints();
 	}
 
-	void AboveLightSource::updateCastPoints(AboveShadePoint * updatePoint)
+	void AboveLightSource::updateCastPoints(AboveSweepChunk& chunk, uint32_t updatePoint)
 	{
-		if (updatePoint->x >= updatePoint->getConnectPoint()->x)
+		if (shadePoints.x[updatePoint] >= shadePoints.x[shadePoints.connect[updatePoint]])
 		{
-			castPoints.erase(updatePoint->getConnectPoint());
+			chunk.castPoints.erase(shadePoints.connect[updatePoint]);
 		}
 		else
 		{
-			castPoints.emplace(updatePoint);
+			chunk.castPoints.insert(updatePoint);
 		}
 	}
 
-	bool AboveLightSource::getAlphaLineAtX(AboveShadePoint *& alphaPoint, int & i, float & alphaContactX, float & alphaContactY)
+	bool AboveLightSource::getAlphaLineAtX(AboveSweepChunk& chunk, uint32_t& alphaPoint, int & i, float & alphaContactX, float & alphaContactY)
 	{
 		int maxI = -1;
 		float minY = FLT_MAX;
 		float minYFar = FLT_MAX;
-		float x = shadePoints.at(i)->x;
-		while (i < shadePoints.size() && shadePoints.at(i)->x == x)
+		float x = shadePoints.x[i];
+		while (i < shadePoints.size() && shadePoints.x[i] == x)
 		{
-			updateCastPoints(shadePoints.at(i));
-			if (shadePoints.at(i)->getConnectPoint()->x > shadePoints.at(i)->x)
+			updateCastPoints(chunk, i);
+			if (shadePoints.x[shadePoints.connect[i]] > shadePoints.x[i])
 			{
-				float pointY = shadePoints.at(i)->y;
+				float pointY = shadePoints.y[i];
 				if (pointY < minY)
 				{
 					minY = pointY;
@@ -267,9 +316,9 @@ namespace lighting
 				}
 				if (pointY == minY)
 				{
-					if (shadePoints.at(i)->getConnectPoint()->y < minYFar)
+					if (shadePoints.y[shadePoints.connect[i]] < minYFar)
 					{
-						minYFar = shadePoints.at(i)->getConnectPoint()->y;
+						minYFar = shadePoints.y[shadePoints.connect[i]];
 						maxI = i;
 					}
 				}
@@ -278,23 +327,23 @@ namespace lighting
 		}
 		if (maxI != -1)
 		{
-			alphaPoint = shadePoints.at(maxI);
-			alphaContactX = alphaPoint->x;
-			alphaContactY = alphaPoint->y;
+			alphaPoint = maxI;
+			alphaContactX = shadePoints.x[alphaPoint];
+			alphaContactY = shadePoints.y[alphaPoint];
 		}
 		i--;
 		return (maxI != -1);
 	}
 	
-	void AboveLightSource::handleFirstShadePoints(AboveShadePoint *& alphaPoint, float & firstX, float & firstY, int & i)
+	void AboveLightSource::handleFirstShadePoints(AboveSweepChunk& chunk, uint32_t& alphaPoint, float & firstX, float & firstY, int & i)
 	{
 		//The first point has to be minX()
-		if (getAlphaLineAtX(alphaPoint, i, firstX, firstY))
+		if (getAlphaLineAtX(chunk, alphaPoint, i, firstX, firstY))
 		{
 			float pointDis = sqrt(pow(firstX, 2) + pow(firstY, 2));
 			float cX = getMinX();
 			float cY;
-			AboveShadePoint* contactPoint = shadowCast(cX, cY, alphaPoint);
+			uint32_t contactPoint = shadowCast(chunk, cX, cY, alphaPoint);
 			float contactDis = sqrt(pow(cX, 2) + pow(cY, 2));
 			if (contactDis < pointDis)
 			{
@@ -305,7 +354,7 @@ namespace lighting
 		}
 	}
 
-	void AboveLightSource::handleLastShadePoints(AboveShadePoint * alphaPoint, float alphaContactX, float alphaContactY)
+	void AboveLightSource::handleLastShadePoints(AboveSweepChunk&, uint32_t, float, float)
 	{
 
 	}
@@ -315,29 +364,22 @@ namespace lighting
 		return BOUND_OFF + owner->drawToWidth;
 	}
 
-	void AboveLightSource::addDrawPoints(float x1, float y1, float x2, float y2)
+	void AboveLightSource::addDrawPoints(AboveSweepChunk& chunk, float x1, float y1, float x2, float y2)
 	{
-		drawPoints.push_back(x1 * owner->getLightBmpScale());
-		drawPoints.push_back((y1 + yOff) * owner->getLightBmpScale());
-		drawPoints.push_back(x2 * owner->getLightBmpScale());
-		drawPoints.push_back((y2 + yOff) * owner->getLightBmpScale());
+		chunk.drawPoints.push_back(x1 * owner->getLightBmpScale());
+		chunk.drawPoints.push_back((y1 + yOff) * owner->getLightBmpScale());
+		chunk.drawPoints.push_back(x2 * owner->getLightBmpScale());
+		chunk.drawPoints.push_back((y2 + yOff) * owner->getLightBmpScale());
 	}
 
-	AboveShadePoint * AboveLightSource::shadowCast(float x, float & cY, AboveShadePoint * exceptionPoint)
+	uint32_t AboveLightSource::shadowCast(AboveSweepChunk& chunk, float x, float & cY, uint32_t exceptionPoint)
 	{
 		cY = owner->drawToHeight + BOUND_OFF + LINE_CHECK_OFF;
-		AboveShadePoint* shadowPoint = nullptr;
-		for (auto it = castPoints.begin(); it != castPoints.end(); it++)
+		float cX;
+		if (exceptionPoint == ShadePointBuffer::NO_POINT)
 		{
-			AboveShadePoint* shadePoint = (*it);
-			if (exceptionPoint == nullptr || shadePoint->x != exceptionPoint->x && shadePoint->getConnectPoint()->x != exceptionPoint->x)
-			{
-				if (shadePoint->checkIntersect(x, -(BOUND_OFF + LINE_CHECK_OFF), x, cY, x, cY))
-				{
-					shadowPoint = shadePoint;
-				}
-			}
+			return chunk.castPoints.castRay(x, -(BOUND_OFF + LINE_CHECK_OFF), x, cY, cX, cY);
 		}
-		return shadowPoint;
+		return chunk.castPoints.castRayExceptX(x, -(BOUND_OFF + LINE_CHECK_OFF), x, cY, shadePoints.x[exceptionPoint], cX, cY);
 	}
 }
@@ -0,0 +1,90 @@
+#include "BlockerGrid.h"
+#include <cmath>
+
+namespace lighting
+{
+	const float BlockerGrid::DEFAULT_CELL_SIZE = 128;
+
+	BlockerGrid::BlockerGrid()
+		:originX(0), originY(0), cellSize(DEFAULT_CELL_SIZE), columns(1), rows(1)
+	{
+	}
+
+	void BlockerGrid::build(const std::vector<BlockerLine>& blockerLines, float cellSize)
+	{
+		lineCells.clear();
+		cellLines.clear();
+		if (blockerLines.empty())
+		{
+			cellStarts.assign(2, 0);
+			return;
+		}
+		float minX = blockerLines.front().x1;
+		float minY = blockerLines.front().y1;
+		float maxX = minX;
+		float maxY = minY;
+		for (auto it = blockerLines.begin(); it != blockerLines.end(); it++)
+		{
+			minX = std::min(minX, std::min(it->x1, it->x2));
+			minY = std::min(minY, std::min(it->y1, it->y2));
+			maxX = std::max(maxX, std::max(it->x1, it->x2));
+			maxY = std::max(maxY, std::max(it->y1, it->y2));
+		}
+		//Sparse lines spread over a large area would leave most cells empty
+		double maxCells = blockerLines.size() * 4.0 + 64;
+		double cells = (std::floor((maxX - minX) / cellSize) + 1) * (std::floor((maxY - minY) / cellSize) + 1);
+		if (cells > maxCells)
+		{
+			cellSize *= (float)std::sqrt(cells / maxCells);
+		}
+		originX = minX;
+		originY = minY;
+		this->cellSize = cellSize;
+		columns = (int)((maxX - minX) / cellSize) + 1;
+		rows = (int)((maxY - minY) / cellSize) + 1;
+		cellStarts.assign(getNumCells() + 1, 0);
+		lineCells.resize(blockerLines.size());
+		//Count the lines of each cell, offset by one so the prefix sum gives the starts
+		for (size_t i = 0; i < blockerLines.size(); i++)
+		{
+			const BlockerLine& line = blockerLines[i];
+			int minColumn = getColumn(std::min(line.x1, line.x2));
+			int minRow = getRow(std::min(line.y1, line.y2));
+			int maxColumn = getColumn(std::max(line.x1, line.x2));
+			int maxRow = getRow(std::max(line.y1, line.y2));
+			lineCells[i].column = minColumn;
+			lineCells[i].row = minRow;
+			for (int row = minRow; row <= maxRow; row++)
+			{
+				for (int column = minColumn; column <= maxColumn; column++)
+				{
+					cellStarts[(size_t)row * columns + column + 1]++;
+				}
+			}
+		}
+		for (size_t i = 1; i < cellStarts.size(); i++)
+		{
+			cellStarts[i] += cellStarts[i - 1];
+		}
+		cellLines.resize(cellStarts.back());
+		//Use the start of each cell as its cursor, which leaves every start at the start of the next cell
+		for (size_t i = 0; i < blockerLines.size(); i++)
+		{
+			const BlockerLine& line = blockerLines[i];
+			int maxColumn = getColumn(std::max(line.x1, line.x2));
+			int maxRow = getRow(std::max(line.y1, line.y2));
+			for (int row = lineCells[i].row; row <= maxRow; row++)
+			{
+				for (int column = lineCells[i].column; column <= maxColumn; column++)
+				{
+					cellLines[cellStarts[(size_t)row * columns + column]++] = (uint32_t)i;
+				}
+			}
+		}
+		for (size_t i = cellStarts.size() - 1; i > 0; i--)
+		{
+			cellStarts[i] = cellStarts[i - 1];
+		}
+		cellStarts[0] = 0;
+	}
+}
@@ -0,0 +1,228 @@
+#include "BlockerSimplifier.h"
+#include <algorithm>
+#include <math.h>
+
+namespace lighting
+{
+	const float BlockerSimplifier::MERGE_TOLERANCE = 0.01f;
+	const float BlockerSimplifier::ANGLE_STEP = 0.0001f;
+	const float BlockerSimplifier::OFFSET_STEP = 0.01f;
+
+	BlockerSimplifier::BlockerSimplifier()
+		:numMergedLines(0)
+	{
+	}
+
+	void BlockerSimplifier::reset(const BlockerSlotMap& blockers)
+	{
+		clear();
+		const std::vector<BlockerLine>& lines = blockers.getLines();
+		const std::vector<uint8_t>& oneSided = blockers.getOneSided();
+		for (size_t i = 0; i < lines.size(); i++)
+		{
+			addLine(lines[i], oneSided[i] != 0);
+		}
+		mergeDirtyGroups(blockers.getEpoch());
+	}
+
+	void BlockerSimplifier::update(BlockerSlotMap& blockers)
+	{
+		blockers.takeChanges(removedLines, removedOneSided, addedLines, addedOneSided);
+		for (size_t i = 0; i < removedLines.size(); i++)
+		{
+			removeLine(removedLines[i], removedOneSided[i] != 0);
+		}
+		for (size_t i = 0; i < addedLines.size(); i++)
+		{
+			addLine(addedLines[i], addedOneSided[i] != 0);
+		}
+		mergeDirtyGroups(blockers.getEpoch());
+	}
+
+	void BlockerSimplifier::copyTo(std::vector<BlockerLine>& lines, std::vector<uint64_t>& versions, std::vector<uint8_t>& oneSided) const
+	{
+		lines.clear();
+		versions.clear();
+		oneSided.clear();
+		lines.reserve(numMergedLines);
+		versions.reserve(numMergedLines);
+		oneSided.reserve(numMergedLines);
+		for (auto it = groups.begin(); it != groups.end(); it++)
+		{
+			const BlockerGroup& group = it->second;
+			lines.insert(lines.end(), group.mergedLines.begin(), group.mergedLines.end());
+			versions.insert(versions.end(), group.mergedLines.size(), group.version);
+			oneSided.insert(oneSided.end(), group.mergedLines.size(), it->first.side != 0);
+		}
+	}
+
+	void BlockerSimplifier::clear()
+	{
+		groups.clear();
+		dirtyGroups.clear();
+		numMergedLines = 0;
+	}
+
+	BlockerSimplifier::GroupKey BlockerSimplifier::GetGroupKey(const BlockerLine& line, bool oneSided)
+	{
+		float dx = line.x2 - line.x1;
+		float dy = line.y2 - line.y1;
+		//Both directions of a line share a group, so the direction is flipped to point right or straight down
+		bool forward = dx > 0 || (dx == 0 && dy > 0);
+		if (!forward)
+		{
+			dx = -dx;
+			dy = -dy;
+		}
+		if (dx == 0 && dy == 0)
+		{
+			dx = 1;
+		}
+		float length = sqrtf(dx * dx + dy * dy);
+		float ux = dx / length;
+		float uy = dy / length;
+		GroupKey key;
+		key.angle = llroundf(atan2f(uy, ux) / ANGLE_STEP);
+		key.offset = llroundf((ux * line.y1 - uy * line.x1) / OFFSET_STEP);
+		key.side = oneSided ? (forward ? 1 : 2) : 0;
+		return key;
+	}
+
+	void BlockerSimplifier::addLine(const BlockerLine& line, bool oneSided)
+	{
+		GroupKey key = GetGroupKey(line, oneSided);
+		auto it = groups.find(key);
+		if (it == groups.end())
+		{
+			BlockerGroup group;
+			group.version = 0;
+			group.dirty = false;
+			it = groups.insert(std::make_pair(key, group)).first;
+		}
+		it->second.lines.push_back(line);
+		markDirty(key, it->second);
+	}
+
+	void BlockerSimplifier::removeLine(const BlockerLine& line, bool oneSided)
+	{
+		GroupKey key = GetGroupKey(line, oneSided);
+		auto it = groups.find(key);
+		if (it == groups.end())
+		{
+			return;
+		}
+		std::vector<BlockerLine>& lines = it->second.lines;
+		for (size_t i = 0; i < lines.size(); i++)
+		{
+			if (lines[i].x1 == line.x1 && lines[i].y1 == line.y1 && lines[i].x2 == line.x2 && lines[i].y2 == line.y2)
+			{
+				lines[i] = lines.back();
+				lines.pop_back();
+				markDirty(key, it->second);
+				return;
+			}
+		}
+	}
+
+	void BlockerSimplifier::markDirty(const GroupKey& key, BlockerGroup& group)
+	{
+		if (!group.dirty)
+		{
+			group.dirty = true;
+			dirtyGroups.push_back(key);
+		}
+	}
+
+	void BlockerSimplifier::mergeDirtyGroups(uint64_t epoch)
+	{
+		for (auto keyIt = dirtyGroups.begin(); keyIt != dirtyGroups.end(); keyIt++)
+		{
+			auto it = groups.find(*keyIt);
+			BlockerGroup& group = it->second;
+			numMergedLines -= group.mergedLines.size();
+			if (group.lines.empty())
+			{
+				groups.erase(it);
+				continue;
+			}
+			MergeGroup(it->first, group);
+			numMergedLines += group.mergedLines.size();
+			group.version = epoch;
+			group.dirty = false;
+		}
+		dirtyGroups.clear();
+	}
+
+	namespace
+	{
+		/// <summary>
+		/// A line of a group measured along the direction of the group.
+		/// </summary>
+		struct GroupSpan
+		{
+			float tMin, tMax;
+			float xMin, yMin, xMax, yMax;
+
+			bool operator<(const GroupSpan& other) const
+			{
+				return tMin < other.tMin;
+			}
+		};
+	}
+
+	void BlockerSimplifier::MergeGroup(const GroupKey& key, BlockerGroup& group)
+	{
+		float angle = key.angle * ANGLE_STEP;
+		float ux = cosf(angle);
+		float uy = sinf(angle);
+		std::vector<GroupSpan> spans(group.lines.size());
+		for (size_t i = 0; i < group.lines.size(); i++)
+		{
+			const BlockerLine& line = group.lines[i];
+			float t1 = ux * line.x1 + uy * line.y1;
+			float t2 = ux * line.x2 + uy * line.y2;
+			GroupSpan& span = spans[i];
+			if (t1 <= t2)
+			{
+				span = { t1, t2, line.x1, line.y1, line.x2, line.y2 };
+			}
+			else
+			{
+				span = { t2, t1, line.x2, line.y2, line.x1, line.y1 };
+			}
+		}
+		std::sort(spans.begin(), spans.end());
+		group.mergedLines.clear();
+		GroupSpan merged = spans.front();
+		//One past the end closes the last merged line
+		for (size_t i = 1; i <= spans.size(); i++)
+		{
+			if (i < spans.size() && spans[i].tMin <= merged.tMax + MERGE_TOLERANCE)
+			{
+				//Lines inside of the merged line, like duplicates, change nothing
+				if (spans[i].tMax > merged.tMax)
+				{
+					merged.tMax = spans[i].tMax;
+					merged.xMax = spans[i].xMax;
+					merged.yMax = spans[i].yMax;
+				}
+				continue;
+			}
+			//One sided lines pointing against the direction of the group keep their facing
+			BlockerLine line;
+			if (key.side == 2)
+			{
+				line = { merged.xMax, merged.yMax, merged.xMin, merged.yMin };
+			}
+			else
+			{
+				line = { merged.xMin, merged.yMin, merged.xMax, merged.yMax };
+			}
+			group.mergedLines.push_back(line);
+			if (i < spans.size())
+			{
+				merged = spans[i];
+			}
+		}
+	}
+}
@@ -0,0 +1,161 @@
+#include "BlockerSlotMap.h"
+#include <algorithm>
+
+namespace lighting
+{
+	const uint32_t BlockerSlotMap::NO_SLOT;
+
+	BlockerSlotMap::BlockerSlotMap()
+		:freeSlot(NO_SLOT), changeLogging(false), epoch(0)
+	{
+	}
+
+	void BlockerSlotMap::add(const BlockerLine * localLines, size_t numLines, float x, float y, BlockerHandle * handles, bool oneSided)
+	{
+		size_t newSize = lines.size() + numLines;
+		//Grow geometrically so adding batch after batch stays linear
+		if (newSize > lines.capacity())
+		{
+			size_t capacity = std::max(newSize, lines.capacity() * 2);
+			lines.reserve(capacity);
+			versions.reserve(capacity);
+			this->oneSided.reserve(capacity);
+			changeLogged.reserve(capacity);
+			offsets.reserve(capacity);
+			denseSlots.reserve(capacity);
+		}
+		if (newSize > slots.capacity())
+		{
+			slots.reserve(std::max(newSize, slots.capacity() * 2));
+		}
+		epoch++;
+		for (size_t i = 0; i < numLines; i++)
+		{
+			const BlockerLine& localLine = localLines[i];
+			uint32_t slotI = takeSlot();
+			slots[slotI].denseIndex = (uint32_t)lines.size();
+			BlockerLine line;
+			line.x1 = x + localLine.x1;
+			line.y1 = y + localLine.y1;
+			line.x2 = x + localLine.x2;
+			line.y2 = y + localLine.y2;
+			lines.push_back(line);
+			versions.push_back(epoch);
+			this->oneSided.push_back(oneSided);
+			BlockerOffsets blockerOffsets;
+			blockerOffsets.epX1 = localLine.x1;
+			blockerOffsets.epY1 = localLine.y1;
+			blockerOffsets.epX2 = localLine.x2;
+			blockerOffsets.epY2 = localLine.y2;
+			blockerOffsets.rotateXOff1 = 0;
+			blockerOffsets.rotateYOff1 = 0;
+			blockerOffsets.rotateXOff2 = 0;
+			blockerOffsets.rotateYOff2 = 0;
+			offsets.push_back(blockerOffsets);
+			denseSlots.push_back(slotI);
+			changeLogged.push_back(0);
+			handles[i].index = slotI;
+			handles[i].generation = slots[slotI].generation;
+			logChange((uint32_t)lines.size() - 1, handles[i], false);
+		}
+	}
+
+	bool BlockerSlotMap::remove(BlockerHandle handle)
+	{
+		if (!contains(handle))
+		{
+			return false;
+		}
+		epoch++;
+		Slot& slot = slots[handle.index];
+		uint32_t denseI = slot.denseIndex;
+		uint32_t lastI = (uint32_t)lines.size() - 1;
+		//The current endpoints of a line changed since the last takeChanges() were never reported, and any old ones are already logged
+		if (changeLogging && !changeLogged[denseI])
+		{
+			removedLines.push_back(lines[denseI]);
+			removedOneSided.push_back(oneSided[denseI]);
+		}
+		//Fill the hole with the last blocker so the arrays stay dense
+		if (denseI != lastI)
+		{
+			lines[denseI] = lines[lastI];
+			versions[denseI] = versions[lastI];
+			oneSided[denseI] = oneSided[lastI];
+			changeLogged[denseI] = changeLogged[lastI];
+			offsets[denseI] = offsets[lastI];
+			denseSlots[denseI] = denseSlots[lastI];
+			slots[denseSlots[denseI]].denseIndex = denseI;
+		}
+		lines.pop_back();
+		versions.pop_back();
+		oneSided.pop_back();
+		changeLogged.pop_back();
+		offsets.pop_back();
+		denseSlots.pop_back();
+		slot.generation++;
+		slot.denseIndex = freeSlot;
+		freeSlot = handle.index;
+		return true;
+	}
+
+	uint32_t BlockerSlotMap::takeSlot()
+	{
+		uint32_t slotI = freeSlot;
+		if (slotI != NO_SLOT)
+		{
+			freeSlot = slots[slotI].denseIndex;
+			return slotI;
+		}
+		Slot slot;
+		slot.generation = 0;
+		slots.push_back(slot);
+		return (uint32_t)slots.size() - 1;
+	}
+
+	void BlockerSlotMap::setChangeLogging(bool changeLogging)
+	{
+		this->changeLogging = changeLogging;
+		changeLogged.assign(lines.size(), 0);
+		changedHandles.clear();
+		removedLines.clear();
+		removedOneSided.clear();
+	}
+
+	void BlockerSlotMap::takeChanges(std::vector<BlockerLine>& removedLines, std::vector<uint8_t>& removedOneSided, std::vector<BlockerLine>& addedLines, std::vector<uint8_t>& addedOneSided)
+	{
+		removedLines.clear();
+		removedLines.swap(this->removedLines);
+		removedOneSided.clear();
+		removedOneSided.swap(this->removedOneSided);
+		addedLines.clear();
+		addedOneSided.clear();
+		for (auto it = changedHandles.begin(); it != changedHandles.end(); it++)
+		{
+			//Lines removed after they changed are already gone
+			if (contains(*it))
+			{
+				uint32_t denseI = slots[it->index].denseIndex;
+				addedLines.push_back(lines[denseI]);
+				addedOneSided.push_back(oneSided[denseI]);
+				changeLogged[denseI] = 0;
+			}
+		}
+		changedHandles.clear();
+	}
+
+	void BlockerSlotMap::logChange(uint32_t denseI, BlockerHandle handle, bool logOldLine)
+	{
+		if (!changeLogging || changeLogged[denseI])
+		{
+			return;
+		}
+		if (logOldLine)
+		{
+			removedLines.push_back(lines[denseI]);
+			removedOneSided.push_back(oneSided[denseI]);
+		}
+		changeLogged[denseI] = 1;
+		changedHandles.push_back(handle);
+	}
+}
@@ -0,0 +1,351 @@
+#include "CastSegmentSet.h"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CAST_SEGMENT_SET_SSE2
+#endif
+
+namespace lighting
+{
+	namespace
+	{
+#ifdef CAST_SEGMENT_SET_SSE2
+		/// <summary>
+		/// Picks <paramref name="a"/> where <paramref name="mask"/> is set and <paramref name="b"/> elsewhere.
+		/// </summary>
+		inline __m128 Select4(__m128 mask, __m128 a, __m128 b)
+		{
+			return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+		}
+
+		/// <summary>
+		/// Where both positions of four lanes are equal.
+		/// </summary>
+		inline __m128 Equal4(__m128 x1, __m128 y1, __m128 x2, __m128 y2)
+		{
+			return _mm_and_ps(_mm_cmpeq_ps(x1, x2), _mm_cmpeq_ps(y1, y2));
+		}
+#endif
+
+		/// <summary>
+		/// Skips no lines.
+		/// </summary>
+		struct NoException
+		{
+			bool skip(size_t) const
+			{
+				return false;
+			}
+
+#ifdef CAST_SEGMENT_SET_SSE2
+			__m128 skip4(size_t) const
+			{
+				return _mm_setzero_ps();
+			}
+#endif
+		};
+
+		/// <summary>
+		/// Skips lines with an endpoint at (<see cref="x1"/>, <see cref="y1"/>) or (<see cref="x2"/>, <see cref="y2"/>).
+		/// </summary>
+		struct TouchException
+		{
+			const float* startX;
+			const float* startY;
+			const float* endX;
+			const float* endY;
+			float x1, y1, x2, y2;
+
+			bool skip(size_t i) const
+			{
+				return (startX[i] == x1 && startY[i] == y1) || (endX[i] == x1 && endY[i] == y1) ||
+					(startX[i] == x2 && startY[i] == y2) || (endX[i] == x2 && endY[i] == y2);
+			}
+
+#ifdef CAST_SEGMENT_SET_SSE2
+			__m128 skip4(size_t i) const
+			{
+				__m128 sX = _mm_loadu_ps(startX + i);
+				__m128 sY = _mm_loadu_ps(startY + i);
+				__m128 eX = _mm_loadu_ps(endX + i);
+				__m128 eY = _mm_loadu_ps(endY + i);
+				__m128 pX1 = _mm_set1_ps(x1);
+				__m128 pY1 = _mm_set1_ps(y1);
+				__m128 pX2 = _mm_set1_ps(x2);
+				__m128 pY2 = _mm_set1_ps(y2);
+				return _mm_or_ps(_mm_or_ps(Equal4(sX, sY, pX1, pY1), Equal4(eX, eY, pX1, pY1)),
+					_mm_or_ps(Equal4(sX, sY, pX2, pY2), Equal4(eX, eY, pX2, pY2)));
+			}
+#endif
+		};
+
+		/// <summary>
+		/// Skips lines with an endpoint at the horizontal position <see cref="x"/>.
+		/// </summary>
+		struct XException
+		{
+			const float* startX;
+			const float* endX;
+			float x;
+
+			bool skip(size_t i) const
+			{
+				return startX[i] == x || endX[i] == x;
+			}
+
+#ifdef CAST_SEGMENT_SET_SSE2
+			__m128 skip4(size_t i) const
+			{
+				__m128 pX = _mm_set1_ps(x);
+				return _mm_or_ps(_mm_cmpeq_ps(_mm_loadu_ps(startX + i), pX), _mm_cmpeq_ps(_mm_loadu_ps(endX + i), pX));
+			}
+#endif
+		};
+
+		/// <summary>
+		/// Finds the line closest along a ray that <paramref name="exception"/> doesn't skip.  When two hits are as close, the later line is kept, as if the ray were
+		/// shortened to each hit in turn.
+		/// </summary>
+		/// <param name="members">The points of the lines.</param>
+		/// <param name="startX">The horizontal position of the first endpoint of each line.</param>
+		/// <param name="startY">The vertical position of the first endpoint of each line.</param>
+		/// <param name="dirX">How far the second endpoint of each line is from the first horizontally.</param>
+		/// <param name="dirY">How far the second endpoint of each line is from the first vertically.</param>
+		/// <param name="x1">The horizontal position the ray starts at.</param>
+		/// <param name="y1">The vertical position the ray starts at.</param>
+		/// <param name="x2">The horizontal position the ray ends at.</param>
+		/// <param name="y2">The vertical position the ray ends at.</param>
+		/// <param name="exception">Which lines to skip.</param>
+		/// <param name="cX">Output parameter of the horizontal position of the hit.  Unmodified if nothing is hit.</param>
+		/// <param name="cY">Output parameter of the vertical position of the hit.  Unmodified if nothing is hit.</param>
+		/// <returns>The point of the line hit, <see cref="ShadePointBuffer::NO_POINT"/> if none is.</returns>
+		template <typename Exception>
+		uint32_t CastRay(const std::vector <uint32_t>& members, const float* startX, const float* startY, const float* dirX, const float* dirY,
+			float x1, float y1, float x2, float y2, const Exception& exception, float& cX, float& cY)
+		{
+			size_t numLines = members.size();
+			float rayDirX = x2 - x1;
+			float rayDirY = y2 - y1;
+			//The closest hit so far is bestAlong / bestAlongDen along the ray, starting at the end of the ray
+			float bestAlong = 1;
+			float bestAlongDen = 1;
+			int bestI = -1;
+			size_t i = 0;
+#ifdef CAST_SEGMENT_SET_SSE2
+			if (numLines >= 4)
+			{
+				__m128 x4 = _mm_set1_ps(x1);
+				__m128 y4 = _mm_set1_ps(y1);
+				__m128 rayDirX4 = _mm_set1_ps(rayDirX);
+				__m128 rayDirY4 = _mm_set1_ps(rayDirY);
+				__m128 zero = _mm_setzero_ps();
+				__m128 signMask = _mm_set1_ps(-0.0f);
+				__m128 bestAlong4 = _mm_set1_ps(1);
+				__m128 bestAlongDen4 = _mm_set1_ps(1);
+				__m128 bestI4 = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				__m128i laneI4 = _mm_setr_epi32(0, 1, 2, 3);
+				__m128i four = _mm_set1_epi32(4);
+				for (; i + 4 <= numLines; i += 4)
+				{
+					__m128 offX = _mm_sub_ps(x4, _mm_loadu_ps(startX + i));
+					__m128 offY = _mm_sub_ps(y4, _mm_loadu_ps(startY + i));
+					__m128 lineDirX = _mm_loadu_ps(dirX + i);
+					__m128 lineDirY = _mm_loadu_ps(dirY + i);
+					__m128 den = _mm_sub_ps(_mm_mul_ps(rayDirX4, lineDirY), _mm_mul_ps(lineDirX, rayDirY4));
+					__m128 lineAlong = _mm_sub_ps(_mm_mul_ps(rayDirX4, offY), _mm_mul_ps(rayDirY4, offX));
+					__m128 along = _mm_sub_ps(_mm_mul_ps(lineDirX, offY), _mm_mul_ps(lineDirY, offX));
+					__m128 sign = _mm_and_ps(den, signMask);
+					den = _mm_xor_ps(den, sign);
+					lineAlong = _mm_xor_ps(lineAlong, sign);
+					along = _mm_xor_ps(along, sign);
+					__m128 hit = _mm_and_ps(_mm_cmpgt_ps(den, zero), _mm_andnot_ps(exception.skip4(i), _mm_cmpge_ps(lineAlong, zero)));
+					hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmple_ps(lineAlong, den), _mm_and_ps(_mm_cmpge_ps(along, zero), _mm_cmple_ps(along, den))));
+					__m128 better = _mm_and_ps(hit, _mm_cmple_ps(_mm_mul_ps(along, bestAlongDen4), _mm_mul_ps(bestAlong4, den)));
+					bestAlong4 = Select4(better, along, bestAlong4);
+					bestAlongDen4 = Select4(better, den, bestAlongDen4);
+					bestI4 = Select4(better, _mm_castsi128_ps(laneI4), bestI4);
+					laneI4 = _mm_add_epi32(laneI4, four);
+				}
+				float laneAlong[4];
+				float laneAlongDen[4];
+				int laneI[4];
+				_mm_storeu_ps(laneAlong, bestAlong4);
+				_mm_storeu_ps(laneAlongDen, bestAlongDen4);
+				_mm_storeu_si128((__m128i*)laneI, _mm_castps_si128(bestI4));
+				for (int lane = 0; lane < 4; lane++)
+				{
+					if (laneI[lane] < 0)
+					{
+						continue;
+					}
+					float lhs = laneAlong[lane] * bestAlongDen;
+					float rhs = bestAlong * laneAlongDen[lane];
+					if (lhs < rhs || (lhs == rhs && laneI[lane] > bestI))
+					{
+						bestAlong = laneAlong[lane];
+						bestAlongDen = laneAlongDen[lane];
+						bestI = laneI[lane];
+					}
+				}
+			}
+#endif
+			for (; i < numLines; i++)
+			{
+				float along;
+				float alongDen;
+				if (!exception.skip(i) && CastSegmentSet::CrossRay(x1, y1, rayDirX, rayDirY, startX[i], startY[i], dirX[i], dirY[i], along, alongDen) &&
+					along * bestAlongDen <= bestAlong * alongDen)
+				{
+					bestAlong = along;
+					bestAlongDen = alongDen;
+					bestI = (int)i;
+				}
+			}
+			if (bestI < 0)
+			{
+				return ShadePointBuffer::NO_POINT;
+			}
+			float t = bestAlong / bestAlongDen;
+			cX = x1 + t * rayDirX;
+			cY = y1 + t * rayDirY;
+			return members[bestI];
+		}
+	}
+
+	CastSegmentSet::CastSegmentSet()
+		:points(nullptr), numFilled(0)
+	{
+	}
+
+	void CastSegmentSet::reset(const ShadePointBuffer & points)
+	{
+		this->points = &points;
+		members.clear();
+		numFilled = 0;
+		slots.assign(points.size(), ShadePointBuffer::NO_POINT);
+		//No more lines than points can be added, so the segment arrays are only grown here
+		startX.resize(points.size());
+		startY.resize(points.size());
+		endX.resize(points.size());
+		endY.resize(points.size());
+		dirX.resize(points.size());
+		dirY.resize(points.size());
+	}
+
+	void CastSegmentSet::clear()
+	{
+		for (size_t i = 0; i < members.size(); i++)
+		{
+			slots[members[i]] = ShadePointBuffer::NO_POINT;
+		}
+		members.clear();
+		numFilled = 0;
+	}
+
+	void CastSegmentSet::insert(uint32_t point)
+	{
+		if (slots[point] == ShadePointBuffer::NO_POINT)
+		{
+			slots[point] = (uint32_t)members.size();
+			members.push_back(point);
+		}
+	}
+
+	void CastSegmentSet::erase(uint32_t point)
+	{
+		uint32_t slot = slots[point];
+		if (slot == ShadePointBuffer::NO_POINT)
+		{
+			return;
+		}
+		size_t last = members.size() - 1;
+		uint32_t lastPoint = members[last];
+		members[slot] = lastPoint;
+		slots[lastPoint] = slot;
+		if (slot < numFilled)
+		{
+			if (last < numFilled)
+			{
+				startX[slot] = startX[last];
+				startY[slot] = startY[last];
+				endX[slot] = endX[last];
+				endY[slot] = endY[last];
+				dirX[slot] = dirX[last];
+				dirY[slot] = dirY[last];
+			}
+			else
+			{
+				fill(slot);
+			}
+		}
+		members.pop_back();
+		slots[point] = ShadePointBuffer::NO_POINT;
+		if (numFilled > members.size())
+		{
+			numFilled = members.size();
+		}
+	}
+
+	uint32_t CastSegmentSet::castRay(float x1, float y1, float x2, float y2, float & cX, float & cY)
+	{
+		fillAll();
+		return CastRay(members, startX.data(), startY.data(), dirX.data(), dirY.data(), x1, y1, x2, y2, NoException(), cX, cY);
+	}
+
+	uint32_t CastSegmentSet::castRayExceptTouching(float x1, float y1, float x2, float y2, uint32_t exceptionPoint, float & cX, float & cY)
+	{
+		fillAll();
+		uint32_t exceptionConnect = points->connect[exceptionPoint];
+		TouchException exception = { startX.data(), startY.data(), endX.data(), endY.data(),
+			points->x[exceptionPoint], points->y[exceptionPoint], points->x[exceptionConnect], points->y[exceptionConnect] };
+		return CastRay(members, startX.data(), startY.data(), dirX.data(), dirY.data(), x1, y1, x2, y2, exception, cX, cY);
+	}
+
+	uint32_t CastSegmentSet::castRayExceptX(float x1, float y1, float x2, float y2, float exceptionX, float & cX, float & cY)
+	{
+		fillAll();
+		XException exception = { startX.data(), endX.data(), exceptionX };
+		return CastRay(members, startX.data(), startY.data(), dirX.data(), dirY.data(), x1, y1, x2, y2, exception, cX, cY);
+	}
+
+	void CastSegmentSet::fill(size_t slot)
+	{
+		uint32_t point = members[slot];
+		uint32_t connectPoint = points->connect[point];
+		float x1 = points->x[point];
+		float y1 = points->y[point];
+		float x2 = points->x[connectPoint];
+		float y2 = points->y[connectPoint];
+		startX[slot] = x1;
+		startY[slot] = y1;
+		endX[slot] = x2;
+		endY[slot] = y2;
+		dirX[slot] = x2 - x1;
+		dirY[slot] = y2 - y1;
+	}
+
+	void CastSegmentSet::fillAll()
+	{
+		for (size_t slot = numFilled; slot < members.size(); slot++)
+		{
+			fill(slot);
+		}
+		numFilled = members.size();
+	}
+
+	bool CastSegmentSet::CrossRay(float x, float y, float dirX, float dirY, float lineX, float lineY, float lineDirX, float lineDirY, float & along, float & alongDen)
+	{
+		float offX = x - lineX;
+		float offY = y - lineY;
+		float den = dirX * lineDirY - lineDirX * dirY;
+		float lineAlong = dirX * offY - dirY * offX;
+		along = lineDirX * offY - lineDirY * offX;
+		//With the denominator made positive, both fractions are in [0, 1] when their numerators are between 0 and it.  The sign is flipped by multiplying and
+		//the checks are combined without short circuits, as which way a line faces is too random to branch on.
+		float sign = den < 0 ? -1.0f : 1.0f;
+		den *= sign;
+		lineAlong *= sign;
+		along *= sign;
+		alongDen = den;
+		return (den > 0) & (lineAlong >= 0) & (lineAlong <= den) & (along >= 0) & (along <= den);
+	}
+}
@@ -1,187 +1,439 @@
 #include "CircleLightSource.h"
 #include <allegro5/allegro.h>
 #include <allegro5/allegro_primitives.h>
+#include <algorithm>
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include "LightLayer.h"
+#include "LineClipper.h"
 
 namespace lighting
 {
-	uint64_t CircleLightSource::ShadePointsProcessed = 0;
-	uint64_t CircleLightSource::ShadowCalled = 0;
-	uint64_t CircleLightSource::CastPointsProcessed = 0;
-	uint64_t CircleLightSource::TotalCycles = 0;
+	std::atomic<uint64_t> CircleLightSource::ShadePointsProcessed(0);
+	std::atomic<uint64_t> CircleLightSource::ShadowCalled(0);
+	std::atomic<uint64_t> CircleLightSource::CastPointsProcessed(0);
+	std::atomic<uint64_t> CircleLightSource::TotalCycles(0);
 
-	bool RadialShadePointCompare(CircleShadePoint* sp1, CircleShadePoint* sp2)
+	const float CircleLightSource::RADIX_MAX_ARC = 0.0625f;
+
+	const float CircleLightSource::CIRCLE_BOUND_GAP = 1;
+
+	const float CircleLightSource::MAX_NEG_FLOAT = -std::numeric_limits<float>::max();
+
+	const float CastPointOrder::TOLERANCE = 0.00001f;
+
+	bool CastPointOrder::operator()(uint32_t castPoint1, uint32_t castPoint2) const
 	{
-		return sp1->rads < sp2->rads;
+		if (castPoint1 == castPoint2)
+		{
+			return false;
+		}
+		float distance1 = GetRayDistance(*points, castPoint1, chunk->castRayX, chunk->castRayY);
+		float distance2 = GetRayDistance(*points, castPoint2, chunk->castRayX, chunk->castRayY);
+		//Fails for lines parallel to the ray too, which give infinite or NaN distances
+		if (fabsf(distance1 - distance2) > TOLERANCE * std::max(fabsf(distance1), fabsf(distance2)))
+		{
+			return distance1 < distance2;
+		}
+		bool front1 = InFront(*points, castPoint1, castPoint2);
+		if (front1 != InFront(*points, castPoint2, castPoint1))
+		{
+			return front1;
+		}
+		//Lines on the same line or only meeting at an endpoint are the same distance wherever they are both hit
+		return castPoint1 < castPoint2;
 	}
 
-	/// <summary>
-	/// The radix maximum number.
-	/// </summary>
-	unsigned int CircleLightSource::RADIX_MAX_NUM = pow(2, RADIX_MAX_BITS) - 1;
+	float CastPointOrder::GetRayDistance(const CircleShadePointBuffer & points, uint32_t linePoint, float rayX, float rayY)
+	{
+		uint32_t connectPoint = points.connect[linePoint];
+		float lineX = points.x[connectPoint] - points.x[linePoint];
+		float lineY = points.y[connectPoint] - points.y[linePoint];
+		return (points.x[linePoint] * lineY - points.y[linePoint] * lineX) / (rayX * lineY - rayY * lineX);
+	}
 
-	const float CircleLightSource::MAX_NEG_FLOAT = -std::numeric_limits<float>::max();
+	bool CastPointOrder::InFront(const CircleShadePointBuffer & points, uint32_t frontPoint, uint32_t backPoint)
+	{
+		uint32_t frontConnectPoint = points.connect[frontPoint];
+		uint32_t backConnectPoint = points.connect[backPoint];
+		int lightSide = GetSide(points, frontPoint, 0, 0);
+		if (lightSide != 0 && GetSide(points, frontPoint, points.x[backPoint], points.y[backPoint]) != lightSide && GetSide(points, frontPoint, points.x[backConnectPoint], points.y[backConnectPoint]) != lightSide)
+		{
+			return true;
+		}
+		lightSide = GetSide(points, backPoint, 0, 0);
+		return lightSide != 0 && GetSide(points, backPoint, points.x[frontPoint], points.y[frontPoint]) != -lightSide && GetSide(points, backPoint, points.x[frontConnectPoint], points.y[frontConnectPoint]) != -lightSide;
+	}
+
+	bool CastPointOrder::Cross(const CircleShadePointBuffer & points, uint32_t linePoint1, uint32_t linePoint2)
+	{
+		uint32_t connectPoint1 = points.connect[linePoint1];
+		uint32_t connectPoint2 = points.connect[linePoint2];
+		float x1 = points.x[linePoint1], y1 = points.y[linePoint1], connectX1 = points.x[connectPoint1], connectY1 = points.y[connectPoint1];
+		float x2 = points.x[linePoint2], y2 = points.y[linePoint2], connectX2 = points.x[connectPoint2], connectY2 = points.y[connectPoint2];
+		//Most neighbors are far apart, their bounds not overlapping is cheaper to check
+		if (std::max(x1, connectX1) < std::min(x2, connectX2) || std::max(x2, connectX2) < std::min(x1, connectX1) ||
+			std::max(y1, connectY1) < std::min(y2, connectY2) || std::max(y2, connectY2) < std::min(y1, connectY1))
+		{
+			return false;
+		}
+		return GetSide(points, linePoint1, x2, y2) * GetSide(points, linePoint1, connectX2, connectY2) < 0 &&
+			GetSide(points, linePoint2, x1, y1) * GetSide(points, linePoint2, connectX1, connectY1) < 0;
+	}
+
+	int CastPointOrder::GetSide(const CircleShadePointBuffer & points, uint32_t linePoint, float x, float y)
+	{
+		uint32_t connectPoint = points.connect[linePoint];
+		float lineX = points.x[connectPoint] - points.x[linePoint];
+		float lineY = points.y[connectPoint] - points.y[linePoint];
+		float offX = x - points.x[linePoint];
+		float offY = y - points.y[linePoint];
+		float cross = lineX * offY - lineY * offX;
+		float tolerance = TOLERANCE * (fabsf(lineX) + fabsf(lineY)) * (fabsf(offX) + fabsf(offY));
+		if (cross > tolerance)
+		{
+			return 1;
+		}
+		return (cross < -tolerance) ? -1 : 0;
+	}
 
 	CircleLightSource::CircleLightSource(LightLayer * ownerLightLayer, float radius, uint8_t r, uint8_t g, uint8_t b)
-		:LightSource(ownerLightLayer), radius(radius)
+		:LightSource(ownerLightLayer), nearbyLinesVersion(0), nearbyLinesFrame(NO_FRAME), computedX(0), computedY(0), computedLines(0), computedEpoch(0), computedCircleBoundSides(SQUARE_BOUNDS), shadeMapFrame(NO_FRAME), shadeMapDirty(true), radius(radius), heldCircleBoundSides(SQUARE_BOUNDS)
 	{
 		setLightColor(r, g, b);
 		al_set_new_bitmap_flags(SHADE_MAP_FLAGS);
 		shadeMap = al_create_bitmap((radius * 2) * owner->getLightBmpScale(), (radius * 2) * owner->getLightBmpScale());
+		shadePoints.setRadixMaxBits(GetRadixMaxBits(radius, owner->getLightBmpScale()));
+	}
+
+	int CircleLightSource::GetRadixMaxBits(float radius, float lightBmpScale)
+	{
+		//The corners of the bounds are the farthest points from the light
+		double maxTurnSteps = 8 * M_SQRT2 * radius * lightBmpScale / RADIX_MAX_ARC;
+		int radixMaxBits = 1;
+		while (radixMaxBits < 32 && ((uint64_t)1 << radixMaxBits) < maxTurnSteps)
+		{
+			radixMaxBits++;
+		}
+		return radixMaxBits;
 	}
 
 	void lighting::CircleLightSource::setLightColor(uint8_t r, uint8_t g, uint8_t b)
 	{
 		lightColor = al_map_rgba(r, g, b, 0);
+		shadeMapDirty = true;
 	}
 	
 	CircleLightSource::~CircleLightSource()
 	{
+		//Frames still in flight call the methods of this class, so they must finish before its members go
+		removeFromOwner();
 		delete shadeMap;
 		shadeMap = nullptr;
 	}
 
-	void CircleLightSource::radixSortShadePoints()
+	bool CircleLightSource::crossesZero(uint32_t testPoint) const
 	{
-		for (int bI = 0; bI < RADIX_MAX_BITS; bI += RADIX_BASE_BITS)
+		unsigned int ep1RadixVal = shadePoints.radixVal[testPoint];
+		unsigned int ep2RadixVal = shadePoints.radixVal[shadePoints.connect[testPoint]];
+		unsigned int halfTurn = shadePoints.getRadixMaxNum() / 2;
+		if (ep1RadixVal < ep2RadixVal)
 		{
-			countingSortShadePoints(bI);
+			return (ep2RadixVal - ep1RadixVal > halfTurn);
 		}
+		return (ep1RadixVal - ep2RadixVal > halfTurn);
 	}
 
-	void CircleLightSource::countingSortShadePoints(int bI)
+	float CircleLightSource::getAngleDif(uint32_t ep1, uint32_t ep2, float oriAngle) const
 	{
-		std::vector <unsigned int> counts(RADIX_BASE_NUM);
-		for (int i = 0; i < shadePoints.size(); i++)
+		float lineAngle = (float)CircleShadePointBuffer::GetPseudoAngle(shadePoints.x[ep2] - shadePoints.x[ep1], shadePoints.y[ep2] - shadePoints.y[ep1]);	//angle between first and second endpoint
+		if (oriAngle > CircleShadePointBuffer::HALF_TURN)
 		{
-			int countIdx = (shadePoints[i]->radixVal >> bI) & 0xff;
-			counts.at(countIdx)++;
+			if (lineAngle < CircleShadePointBuffer::HALF_TURN)
+			{
+				lineAngle += CircleShadePointBuffer::FULL_TURN;
+			}
 		}
+		return lineAngle - oriAngle;
+	}
 
-		for (int i = 1; i < RADIX_BASE_NUM; i++)
+	bool CircleLightSource::checkPointFront(uint32_t alphaPoint, uint32_t checkPoint) const
+	{
+		return !shadePoints.checkCross(alphaPoint, 0, 0, shadePoints.x[checkPoint], shadePoints.y[checkPoint]);
+	}
+
+	void CircleLightSource::transferHeldVars(size_t slot)
+	{
+		frameSlots.at(slot).x = heldX;
+		frameSlots.at(slot).y = heldY;
+		frameSlots.at(slot).circleBoundSides = heldCircleBoundSides;
+	}
+
+	void CircleLightSource::setPipelineSlots(size_t slots)
+	{
+		LightSource::setPipelineSlots(slots);
+		frameSlots.clear();
+		frameSlots.resize(slots);
+		for (size_t i = 0; i < frameSlots.size(); i++)
 		{
-			counts.at(i) += counts.at(i - 1);
+			frameSlots.at(i).shadowsFrame = NO_FRAME;
+			frameSlots.at(i).circleBoundSides = heldCircleBoundSides;
 		}
-		
-		std::vector<CircleShadePoint*> output(shadePoints.size());
-		for (int i = shadePoints.size() - 1; i >= 0; i--)
+		shadeMapFrame = NO_FRAME;
+	}
+
+	void CircleLightSource::reuseResults(size_t previousSlot)
+	{
+		if (previousSlot != computeSlot)
 		{
-			int countIdx = (shadePoints[i]->radixVal >> bI) & 0xff;
-			output[counts[countIdx] - 1] = shadePoints[i];
-			counts[countIdx]--;
+			frameSlots.at(computeSlot).drawPoints = frameSlots.at(previousSlot).drawPoints;
+			frameSlots.at(computeSlot).shadowsFrame = frameSlots.at(previousSlot).shadowsFrame;
 		}
-		for (int i = 0; i < shadePoints.size(); i++)
+	}
+
+	bool CircleLightSource::hasUnchangedInputs()
+	{
+		const CircleFrameSlot& frameSlot = frameSlots.at(computeSlot);
+		//A moved light needs new shadows whatever the lines are, so skip the query and leave it to createShadePoints
+		if (frameSlot.x != computedX || frameSlot.y != computedY || frameSlot.circleBoundSides != computedCircleBoundSides)
 		{
-			shadePoints[i] = output[i];
+			return false;
 		}
+		queryNearbyLines(*owner->frames.at(computeSlot).blockers, frameSlot.x, frameSlot.y, frameSlot.circleBoundSides);
+		nearbyLinesFrame = owner->processingFrame;
+		//Lines unchanged since computedEpoch were near then too, so with the same count they are the same lines
+		return nearbyLines.size() == computedLines && nearbyLinesVersion <= computedEpoch;
 	}
 
-	bool CircleLightSource::CrossesZero(CircleShadePoint * testPoint)
+	void CircleLightSource::queryNearbyLines(const BlockerSnapshot& blockers, float x, float y, size_t circleBoundSides)
 	{
-		float ep1Rad = testPoint->rads;
-		float ep2Rad = testPoint->getConnectPoint()->rads;
-		if (ep1Rad < ep2Rad)
+		float minX = x - radius;
+		float minY = y - radius;
+		float maxX = x + radius;
+		float maxY = y + radius;
+		nearbyLines.clear();
+		nearbyLinesVersion = 0;
+		blockers.blockerGrid.query(minX, minY, maxX, maxY, [&](uint32_t lineI)
 		{
-			return (ep2Rad - M_PI > ep1Rad);
+			const BlockerLine& blockerLine = blockers.blockerLines[lineI];
+			float lineMinX = std::min(blockerLine.x1, blockerLine.x2);
+			float lineMinY = std::min(blockerLine.y1, blockerLine.y2);
+			float lineMaxX = std::max(blockerLine.x1, blockerLine.x2);
+			float lineMaxY = std::max(blockerLine.y1, blockerLine.y2);
+			//The grid cells are coarser than the bounds, lines entirely outside of them can't cast shadows
+			if (lineMaxX < minX || lineMinX > maxX || lineMaxY < minY || lineMinY > maxY)
+			{
+				return;
+			}
+			if (circleBoundSides != SQUARE_BOUNDS)
+			{
+				//Lines whose bounding box is only in the corners of the square are past the falloff of the light.  The rest that miss the circle are dropped by the clip.
+				float closeX = std::min(std::max(x, lineMinX), lineMaxX) - x;
+				float closeY = std::min(std::max(y, lineMinY), lineMaxY) - y;
+				if (closeX * closeX + closeY * closeY >= radius * radius)
+				{
+					return;
+				}
+			}
+			nearbyLines.push_back(lineI);
+			nearbyLinesVersion = std::max(nearbyLinesVersion, blockers.blockerVersions[lineI]);
+		});
+	}
+
+	bool CircleLightSource::beginShadeMapRedraw()
+	{
+		uint64_t shadowsFrame = frameSlots.at(drawSlot).shadowsFrame;
+		if (!shadeMapDirty && shadowsFrame == shadeMapFrame)
+		{
+			return false;
 		}
-		return (ep1Rad - M_PI > ep2Rad);
+		shadeMapDirty = false;
+		shadeMapFrame = shadowsFrame;
+		return true;
 	}
 
-	float CircleLightSource::GetRadDif(CircleShadePoint * ep1, CircleShadePoint * ep2, float oriRads)
+	void CircleLightSource::createShadePoints()
 	{
-		float lineRad = atan2(ep2->y - ep1->y, ep2->x - ep1->x);	//angle between first and second endpoint
-		if (lineRad < 0)
+		float x = frameSlots.at(computeSlot).x;
+		float y = frameSlots.at(computeSlot).y;
+		size_t circleBoundSides = frameSlots.at(computeSlot).circleBoundSides;
+		//The frame's copy of the blockers can't change while it is processed
+		const BlockerSnapshot& blockers = *owner->frames.at(computeSlot).blockers;
+		//hasUnchangedInputs already queried this frame if the light didn't move
+		if (nearbyLinesFrame != resultFrame)
 		{
-			lineRad += 2 * M_PI;	//normalize the radians
+			queryNearbyLines(blockers, x, y, circleBoundSides);
+			nearbyLinesFrame = resultFrame;
 		}
-		if (oriRads > M_PI)
+		computedX = x;
+		computedY = y;
+		computedCircleBoundSides = circleBoundSides;
+		computedLines = nearbyLines.size();
+		computedEpoch = blockers.epoch;
+		frameSlots.at(computeSlot).shadowsFrame = resultFrame;
+		resetPoints(nearbyLines.size());
+		clipX1.resize(nearbyLines.size());
+		clipY1.resize(nearbyLines.size());
+		clipX2.resize(nearbyLines.size());
+		clipY2.resize(nearbyLines.size());
+		size_t facingLines = 0;
+		for (auto it = nearbyLines.begin(); it != nearbyLines.end(); it++)
 		{
-			if (lineRad < M_PI)
+			const BlockerLine& blockerLine = blockers.blockerLines[*it];
+			float x1 = blockerLine.x1 - x;
+			float y1 = blockerLine.y1 - y;
+			float x2 = blockerLine.x2 - x;
+			float y2 = blockerLine.y2 - y;
+			//The back of a closed shape is hidden behind its front, so edges facing away from the light add shade points that never cast a shadow
+			if (blockers.blockerOneSided[*it] && x1 * y2 - y1 * x2 <= 0)
 			{
-				lineRad += 2 * M_PI;
+				continue;
 			}
+			clipX1[facingLines] = x1;
+			clipY1[facingLines] = y1;
+			clipX2[facingLines] = x2;
+			clipY2[facingLines] = y2;
+			facingLines++;
 		}
-		return lineRad - oriRads;
+		if (circleBoundSides != SQUARE_BOUNDS)
+		{
+			//The sides of the polygon are outside the circle, so nothing clipped to it can be on them
+			size_t numLines = LineClipper::ClipLinesToCircle(clipX1.data(), clipY1.data(), clipX2.data(), clipY2.data(), facingLines, radius);
+			for (size_t i = 0; i < numLines; i++)
+			{
+				shadePoints.addLine(clipX1[i], clipY1[i], clipX2[i], clipY2[i]);
+			}
+		}
+		else
+		{
+			size_t numLines = LineClipper::ClipLines(clipX1.data(), clipY1.data(), clipX2.data(), clipY2.data(), facingLines, radius);
+			for (size_t i = 0; i < numLines; i++)
+			{
+				float x1 = clipX1[i];
+				float y1 = clipY1[i];
+				float x2 = clipX2[i];
+				float y2 = clipY2[i];
+				bringEqualBoundToInBound(x1);
+				bringEqualBoundToInBound(y1);
+				bringEqualBoundToInBound(x2);
+				bringEqualBoundToInBound(y2);
+				shadePoints.addLine(x1, y1, x2, y2);
+			}
+		}
+		shadePoints.sort();
 	}
 
-	bool CircleLightSource::CheckPointFront(CircleShadePoint * alphaPoint, CircleShadePoint * checkPoint)
+	void CircleLightSource::mapShadePoints()
 	{
-		float cX;	//Useless variables
-		float cY;
-		return !alphaPoint->checkIntersect(0, 0, checkPoint->x, checkPoint->y, cX, cY);
+		createSweepChunks(1);
+		mapSweepChunk(0);
+		stitchSweepChunks();
 	}
 
-	void CircleLightSource::transferHeldVars()
+	size_t CircleLightSource::createSweepChunks(size_t maxChunks)
 	{
-		this->x = heldX;
-		this->y = heldY;
+		size_t numChunks = std::min(maxChunks, shadePoints.size() / MIN_SWEEP_CHUNK_SHADE_POINTS);
+		if (numChunks < 1)
+		{
+			numChunks = 1;
+		}
+		sweepChunks.resize(numChunks);
+		size_t chunkI = 0;
+		sweepChunks.at(0).beginI = 0;
+		sweepChunks.at(0).beginAngle = 0;
+		for (size_t splitI = 1; splitI < numChunks; splitI++)
+		{
+			size_t i = (shadePoints.size() * splitI) / numChunks;
+			//A sector can't start between two points at the same radian
+			while (i < shadePoints.size() && shadePoints.radixVal[i] == shadePoints.radixVal[i - 1])
+			{
+				i++;
+			}
+			if (i >= shadePoints.size() || i <= sweepChunks.at(chunkI).beginI)
+			{
+				continue;
+			}
+			float splitAngle = (shadePoints.getAngle(i - 1) + shadePoints.getAngle(i)) / 2;
+			sweepChunks.at(chunkI).endI = i;
+			sweepChunks.at(chunkI).endAngle = splitAngle;
+			chunkI++;
+			sweepChunks.at(chunkI).beginI = i;
+			sweepChunks.at(chunkI).beginAngle = splitAngle;
+		}
+		sweepChunks.at(chunkI).endI = shadePoints.size();
+		sweepChunks.at(chunkI).endAngle = CircleShadePointBuffer::FULL_TURN;
+		sweepChunks.resize(chunkI + 1);
+		return sweepChunks.size();
 	}
 
-	void CircleLightSource::createShadePoints()
+	void CircleLightSource::seedCastPoints(CircleSweepChunk & chunk)
 	{
-		std::list <LightBlocker*> lightBlockers = owner->lightBlockers;
-		resetPoints(lightBlockers.size());
-		for (auto it = lightBlockers.begin(); it != lightBlockers.end(); it++)
+		float angle = chunk.beginAngle;
+		CircleShadePointBuffer::GetDirection(angle, chunk.castRayX, chunk.castRayY);
+		for (uint32_t startPoint = 0; startPoint < shadePoints.size(); startPoint++)
 		{
-			float x1 = (*it)->x1 - x;
-			float y1 = (*it)->y1 - y;
-			float x2 = (*it)->x2 - x;
-			float y2 = (*it)->y2 - y;
-			if (handleBoundCollisions(x1, y1, x2, y2))
+			uint32_t endPoint = shadePoints.connect[startPoint];
+			float startAngle = shadePoints.getAngle(startPoint);
+			float endAngle = shadePoints.getAngle(endPoint);
+			//Only the endpoint a line starts at is kept in castPoints, for lines crossing angle=0 that is the one with the greater angle
+			if (crossesZero(startPoint))
 			{
-				CircleShadePoint* updatePoint1 = new CircleShadePoint(x1, y1);
-				CircleShadePoint* updatePoint2 = new CircleShadePoint(x2, y2);
-				updatePoint1->setConnectPoint(updatePoint2);
-				updatePoint2->setConnectPoint(updatePoint1);
-				if (CrossesZero(updatePoint1))
+				if (startAngle > endAngle && (angle < endAngle || angle > startAngle))
 				{
-					if (updatePoint1->rads != 0 && updatePoint2->rads != 0)
-					{
-						if (updatePoint1->rads > M_PI)
-						{
-							castPoints.insert(updatePoint1);
-						}
-						else
-						{
-							castPoints.insert(updatePoint2);
-						}
-					}
+					addCastPoint(chunk, startPoint);
 				}
-				shadePoints.push_back(updatePoint1);
-				shadePoints.push_back(updatePoint2);
+			}
+			else if (startAngle < angle && angle < endAngle)
+			{
+				addCastPoint(chunk, startPoint);
 			}
 		}
-		radixSortShadePoints();
 	}
 
-	void CircleLightSource::mapShadePoints()
+	void CircleLightSource::mapSweepChunk(size_t chunkI)
 	{
-		TotalCycles++;  //TEMP
-		ShadePointsProcessed += shadePoints.size();
+		CircleSweepChunk& chunk = sweepChunks.at(chunkI);
+		bool lastChunk = (chunkI == sweepChunks.size() - 1);
+		//The comparator points at the chunk, which may have moved since the last sweep
+		chunk.castPoints = std::set <uint32_t, CastPointOrder>(CastPointOrder(&chunk, &shadePoints));
+		chunk.unorderedCastPoints.reset(shadePoints);
+		chunk.castPointsOrdered = false;
+		chunk.castPointsCrossed = false;
+		chunk.castPointUpdates = 0;
+		chunk.castPointScans = 0;
+		chunk.shadowCasts = 0;
+		chunk.castPointsChecked = 0;
+		chunk.drawPoints.clear();
+		seedCastPoints(chunk);
 		float firstAlphaContactX = 0;	//The position of the contact of the first line at angle=0
 		float firstAlphaContactY = 0;
-		CircleShadePoint* alphaPoint = nullptr;	//Represents an endpoint from the "alpha line".  This is the line closest to the origin of the light as you rotate.  This allows us to skip over ray casting in many cases.
-		int i = 0;
+		uint32_t alphaPoint = ShadePointBuffer::NO_POINT;	//Represents an endpoint from the "alpha line".  This is the line closest to the origin of the light as you rotate.  This allows us to skip over ray casting in many cases.
 		bool radAtZero = false;
-		handleFirstShadePoint(alphaPoint, firstAlphaContactX, firstAlphaContactY, i, radAtZero);
+		if (chunkI == 0)
+		{
+			int i = 0;
+			handleFirstShadePoint(chunk, alphaPoint, firstAlphaContactX, firstAlphaContactY, i, radAtZero);
+		}
+		else
+		{
+			alphaPoint = shadowCast(chunk, chunk.beginAngle, firstAlphaContactX, firstAlphaContactY);
+		}
 		float alphaContactX = firstAlphaContactX;	//This was the last position a new alphapoint was assigned, used for keeping track of drawing
 		float alphaContactY = firstAlphaContactY;
-		for (int i = 0; i < shadePoints.size(); i++)
+		for (int i = chunk.beginI; i < chunk.endI; i++)
 		{
 			//The current point is at the end of the alphaLine (now you have to decide who is the successor to the alphaPoint)
-			if (shadePoints.at(i)->rads == alphaPoint->getConnectPoint()->rads)
+			if (shadePoints.radixVal[i] == shadePoints.radixVal[shadePoints.connect[alphaPoint]])
 			{
-				addDrawPoints(alphaContactX, alphaContactY, alphaPoint->getConnectPoint()->x, alphaPoint->getConnectPoint()->y);
+				addDrawPoints(chunk, alphaContactX, alphaContactY, shadePoints.x[shadePoints.connect[alphaPoint]], shadePoints.y[shadePoints.connect[alphaPoint]]);
 				//save the distance of the endpoint of the current alphaLine so we can check if the new alphapoint returned is past that distance
-				CircleShadePoint* disPoint = alphaPoint->getConnectPoint();
-				float alphaDis = sqrt(pow(disPoint->x, 2) + pow(disPoint->y, 2));
-				CircleShadePoint* radAlphaPoint = nullptr;
-				bool found = getAlphaLineAtRad(radAlphaPoint, i, alphaContactX, alphaContactY);
+				uint32_t disPoint = shadePoints.connect[alphaPoint];
+				float alphaDis = sqrt(pow(shadePoints.x[disPoint], 2) + pow(shadePoints.y[disPoint], 2));
+				uint32_t radAlphaPoint = ShadePointBuffer::NO_POINT;
+				bool found = getAlphaLineAtRad(chunk, radAlphaPoint, i, alphaContactX, alphaContactY);
 				if (!found)
 				{
-					alphaPoint = shadowCast(shadePoints.at(i)->rads, alphaContactX, alphaContactY, alphaPoint);
+					alphaPoint = shadowCast(chunk, shadePoints.getAngle(i), alphaContactX, alphaContactY, alphaPoint);
 				}
 				else
 				{
@@ -192,7 +444,7 @@ namespace lighting
 					{
 						float cX;
 						float cY;
-						CircleShadePoint* contactPoint = shadowCast(shadePoints.at(i)->rads, cX, cY, alphaPoint);
+						uint32_t contactPoint = shadowCast(chunk, shadePoints.getAngle(i), cX, cY, alphaPoint);
 						float contactDis = sqrt(pow(cX, 2) + pow(cY, 2));
 						//Is the line closer or the point found earlier?
 						if (contactDis < pointDis)
@@ -212,30 +464,86 @@ namespace lighting
 					}
 				}
 			}
-			else if (CheckPointFront(alphaPoint, shadePoints.at(i)))	//Is the point in front of the alpha line?
+			else if (checkPointFront(alphaPoint, i))	//Is the point in front of the alpha line?
 			{
 				float alphaCX;
 				float alphaCY;
-				alphaPoint->checkIntersect(0, 0, cos(shadePoints.at(i)->rads) * radius * 2, sin(shadePoints.at(i)->rads) * radius * 2, alphaCX, alphaCY);
-				addDrawPoints(alphaContactX, alphaContactY, alphaCX, alphaCY);
+				float dirX;
+				float dirY;
+				CircleShadePointBuffer::GetDirection(shadePoints.getAngle(i), dirX, dirY);
+				shadePoints.checkIntersect(alphaPoint, 0, 0, dirX * radius * 2, dirY * radius * 2, alphaCX, alphaCY);
+				addDrawPoints(chunk, alphaContactX, alphaContactY, alphaCX, alphaCY);
 				//We know this will return a valid alphaPoint because, the only way this would be in front of the alphaLine is if it wasn't already in front
 				//so it must be going up in radians (the direction we want)
-				getAlphaLineAtRad(alphaPoint, i, alphaContactX, alphaContactY);
+				getAlphaLineAtRad(chunk, alphaPoint, i, alphaContactX, alphaContactY);
 			}
 			else
 			{
 				//Even if this point isn't significant right now, it can still be used in shadowCast.  Maintaining this map will shorten the time it takes to shadowCast.
-				updateCastPoints(shadePoints.at(i));
+				updateCastPoints(chunk, i);
 			}
 		}
-		handleLastShadePoint(alphaPoint, radAtZero, alphaContactX, alphaContactY, firstAlphaContactX, firstAlphaContactY);
+		if (!lastChunk)
+		{
+			//End the sector on the alpha line, the next sector's shadowCast at the same radian starts from there
+			float endCX = 0;
+			float endCY = 0;
+			float dirX;
+			float dirY;
+			CircleShadePointBuffer::GetDirection(chunk.endAngle, dirX, dirY);
+			shadePoints.checkIntersect(alphaPoint, 0, 0, dirX * radius * 2, dirY * radius * 2, endCX, endCY);
+			addDrawPoints(chunk, alphaContactX, alphaContactY, endCX, endCY);
+		}
+		else if (chunkI == 0)
+		{
+			handleLastShadePoint(chunk, alphaPoint, radAtZero, alphaContactX, alphaContactY, firstAlphaContactX, firstAlphaContactY);
+		}
+		else
+		{
+			//The contact at angle=0 belongs to the first sector, so close on the alpha line itself
+			handleLastShadePoint(chunk, alphaPoint, true, alphaContactX, alphaContactY, 0, 0);
+		}
+	}
+
+	void CircleLightSource::stitchSweepChunks()
+	{
+		//The chunks count on their own while they run at the same time, the shared counters are only added to once per light
+		uint64_t shadePointsSwept = 0;
+		uint64_t shadowCasts = 0;
+		uint64_t castPointsChecked = 0;
+		for (size_t i = 0; i < sweepChunks.size(); i++)
+		{
+			shadePointsSwept += sweepChunks.at(i).endI - sweepChunks.at(i).beginI;
+			shadowCasts += sweepChunks.at(i).shadowCasts;
+			castPointsChecked += sweepChunks.at(i).castPointsChecked;
+		}
+		TotalCycles++;
+		ShadePointsProcessed += shadePointsSwept;
+		ShadowCalled += shadowCasts;
+		CastPointsProcessed += castPointsChecked;
+		std::vector <float>& drawPoints = frameSlots.at(computeSlot).drawPoints;
+		if (sweepChunks.size() == 1)
+		{
+			drawPoints.swap(sweepChunks.at(0).drawPoints);
+			return;
+		}
+		drawPoints.clear();
+		for (size_t i = 0; i < sweepChunks.size(); i++)
+		{
+			drawPoints.insert(drawPoints.end(), sweepChunks.at(i).drawPoints.begin(), sweepChunks.at(i).drawPoints.end());
+		}
 	}
 
 	void CircleLightSource::drawLocal()
 	{
+		if (!beginShadeMapRedraw())
+		{
+			return;
+		}
 		al_set_target_bitmap(shadeMap);
 		al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
 		al_clear_to_color(al_map_rgba(0, 0, 0, 255));	//clear the bitmap to all black (0, 0, 0, 255)
+		const std::vector <float>& drawPoints = frameSlots.at(drawSlot).drawPoints;
 		//Draw triangles where the light is, so the black shadow now becomes transparent because we are drawing color code (r, g, b, 0) direclty to the map
 		for (int i = 0; i < drawPoints.size(); i += 4)
 		{
@@ -249,148 +557,69 @@ namespace lighting
 
 	void CircleLightSource::drawToLightMap()
 	{
+		float x = frameSlots.at(drawSlot).x;
+		float y = frameSlots.at(drawSlot).y;
 		al_draw_scaled_bitmap(shadeMap, 0, 0, (radius * 2) * owner->getLightBmpScale(), (radius * 2) * owner->getLightBmpScale(), (x - radius) * owner->getLightBmpScale(), (y - radius) * owner->getLightBmpScale(), (radius * 2) * owner->getLightBmpScale(), (radius * 2) * owner->getLightBmpScale(), NULL);
 	}
 
 	void CircleLightSource::resetPoints(size_t lightBlockersSize)
 	{
-		for (int i = BOUND_POINTS_SIZE; i < shadePoints.size(); i++)
-		{
-			delete shadePoints.at(i);
-		}
-		drawPoints.clear();
-		castPoints.clear();
 		shadePoints.clear();
-		shadePoints.reserve(lightBlockersSize * 2 + BOUND_POINTS_SIZE);
+		shadePoints.reserve(lightBlockersSize * 2 + (computedCircleBoundSides == SQUARE_BOUNDS ? BOUND_POINTS_SIZE : computedCircleBoundSides * 2));
 		createBoundShadePoints();
 	}
 
 	void CircleLightSource::createBoundShadePoints()
 	{
-		CircleShadePoint* nRnR1 = new CircleShadePoint(-radius, -radius);
-		CircleShadePoint* nRpR1 = new CircleShadePoint(-radius, radius);
-		nRnR1->setConnectPoint(nRpR1);
-		nRpR1->setConnectPoint(nRnR1);
-		shadePoints.push_back(nRpR1);
-		shadePoints.push_back(nRnR1);
-		CircleShadePoint* nRnR2 = new CircleShadePoint(-radius, -radius);
-		CircleShadePoint* pRnR1 = new CircleShadePoint(radius, -radius);
-		nRnR2->setConnectPoint(pRnR1);
-		pRnR1->setConnectPoint(nRnR2);
-		shadePoints.push_back(nRnR2);
-		shadePoints.push_back(pRnR1);
-		CircleShadePoint* pRnR2 = new CircleShadePoint(radius, -radius);
-		CircleShadePoint* pRpR1 = new CircleShadePoint(radius, radius);
-		pRnR2->setConnectPoint(pRpR1);
-		pRpR1->setConnectPoint(pRnR2);
-		castPoints.emplace(pRnR2);	//Because this line passes angle=0, add it to cast points
-		shadePoints.push_back(pRnR2);
-		shadePoints.push_back(pRpR1);
-		CircleShadePoint* pRpR2 = new CircleShadePoint(radius, radius);
-		CircleShadePoint* nRpR2 = new CircleShadePoint(-radius, radius);
-		pRpR2->setConnectPoint(nRpR2);
-		nRpR2->setConnectPoint(pRpR2);
-		shadePoints.push_back(pRpR2);
-		shadePoints.push_back(nRpR2);
-	}
-
-
-	bool CircleLightSource::handleBoundCollisions(float & x1, float & y1, float & x2, float & y2)
-	{
-		bool p1In = x1 > -radius && x1 < radius && y1 > -radius && y1 < radius;  //if x1 and y1 are in the bounds
-		bool p2In = x2 > -radius && x2 < radius && y2 > -radius && y2 < radius;  //if x2 and y2 are in the bounds
-		if (!p1In && !p2In)
-		{
-			bool p1Set = false;
-			float cX1 = x1;
-			float cY1 = y1;
-			float cX2 = x2;
-			float cY2 = y2;
-			for (int i = 0; i < BOUND_POINTS_SIZE; i += 2)
-			{
-				float cX;
-				float cY;
-				//checks if line made by (x1, y1) and (x2, y2) intersects with bounds
-				if (shadePoints.at(i)->checkIntersect(x1, y1, x2, y2, cX, cY))
-				{
-					if (!p1Set)
-					{
-						cX1 = cX;
-						cY1 = cY;
-						p1Set = true;
-					}
-					else
-					{
-						cX2 = cX;
-						cY2 = cY;
-					}
-				}
-			}
-			x1 = cX1;
-			y1 = cY1;
-			x2 = cX2;
-			y2 = cY2;
-			//Means that the line is not anywhere near the light and does not need to be considered
-			if (!p1Set)
-			{
-				return false;
-			}
-		}
-		else if (!p1In)
-		{
-			for (int i = 0; i < BOUND_POINTS_SIZE; i += 2)
-			{
-				float cX;
-				float cY;
-				if (shadePoints.at(i)->checkIntersect(x1, y1, x2, y2, cX, cY))
-				{
-					x1 = cX;
-					y1 = cY;
-					break;
-				}
-			}
-		}
-		else if (!p2In)
+		if (computedCircleBoundSides != SQUARE_BOUNDS)
 		{
-			for (int i = 0; i < BOUND_POINTS_SIZE; i += 2)
+			//The polygon's sides touch the circle they are CIRCLE_BOUND_GAP outside of at their middles, so its corners are farther out
+			double sideAngle = 2 * M_PI / computedCircleBoundSides;
+			double cornerDis = (radius + CIRCLE_BOUND_GAP) / cos(sideAngle / 2);
+			float firstX = (float)(cornerDis * cos(sideAngle / 2));
+			float firstY = (float)(cornerDis * sin(sideAngle / 2));
+			float prevX = firstX;
+			float prevY = firstY;
+			for (size_t i = 1; i < computedCircleBoundSides; i++)
 			{
-				float cX;
-				float cY;
-				if (shadePoints.at(i)->checkIntersect(x1, y1, x2, y2, cX, cY))
-				{
-					x2 = cX;
-					y2 = cY;
-					break;
-				}
+				double cornerAngle = sideAngle * (i + 0.5);
+				float cornerX = (float)(cornerDis * cos(cornerAngle));
+				float cornerY = (float)(cornerDis * sin(cornerAngle));
+				shadePoints.addLine(prevX, prevY, cornerX, cornerY);
+				prevX = cornerX;
+				prevY = cornerY;
 			}
+			//The last side ends exactly on the first corner so the polygon has no gap
+			shadePoints.addLine(prevX, prevY, firstX, firstY);
+			return;
 		}
-		bringEqualBoundToInBound(x1);
-		bringEqualBoundToInBound(y1);
-		bringEqualBoundToInBound(x2);
-		bringEqualBoundToInBound(y2);
-		return true;
+		shadePoints.addLine(-radius, radius, -radius, -radius);
+		shadePoints.addLine(-radius, -radius, radius, -radius);
+		shadePoints.addLine(radius, -radius, radius, radius);
+		shadePoints.addLine(radius, radius, -radius, radius);
 	}
 
-	void CircleLightSource::addDrawPoints(float x1, float y1, float x2, float y2)
+
+	void CircleLightSource::addDrawPoints(CircleSweepChunk& chunk, float x1, float y1, float x2, float y2)
 	{
-		drawPoints.push_back((x1 + radius) * owner->getLightBmpScale());
-		drawPoints.push_back((y1 + radius) * owner->getLightBmpScale());
-		drawPoints.push_back((x2 + radius) * owner->getLightBmpScale());
-		drawPoints.push_back((y2 + radius) * owner->getLightBmpScale());
+		chunk.drawPoints.push_back((x1 + radius) * owner->getLightBmpScale());
+		chunk.drawPoints.push_back((y1 + radius) * owner->getLightBmpScale());
+		chunk.drawPoints.push_back((x2 + radius) * owner->getLightBmpScale());
+		chunk.drawPoints.push_back((y2 + radius) * owner->getLightBmpScale());
 	}
 
-	void CircleLightSource::handleFirstShadePoint(CircleShadePoint *& alphaPoint, float & firstX, float & firstY, int & i, bool & radAtZero)
+	void CircleLightSource::handleFirstShadePoint(CircleSweepChunk& chunk, uint32_t& alphaPoint, float & firstX, float & firstY, int & i, bool & radAtZero)
 	{
-		//Since points are in order, shadePoints.at(0) would have a radian of 0 if it existed
-		if (shadePoints.at(0)->rads == 0)
+		//Since points are in order, the point at index 0 would have an angle of 0 if it existed
+		if (shadePoints.radixVal[0] == 0)
 		{
-			if (getAlphaLineAtRad(alphaPoint, i, firstX, firstY))
+			if (getAlphaLineAtRad(chunk, alphaPoint, i, firstX, firstY))
 			{
 				//Checks if shadowCast point is in front of the point at angle = 0
 				float pointDis = sqrt(pow(firstX, 2) + pow(firstY, 2));
 				float cX;
 				float cY;
-				CircleShadePoint* contactPoint = shadowCast(shadePoints.at(i)->rads, cX, cY, alphaPoint);
+				uint32_t contactPoint = shadowCast(chunk, shadePoints.getAngle(i), cX, cY, alphaPoint);
 				float contactDis = sqrt(pow(cX, 2) + pow(cY, 2));
 				if (contactDis < pointDis)
 				{
@@ -404,112 +633,228 @@ namespace lighting
 				}
 			}
 		}
-		if (alphaPoint == nullptr)
+		if (alphaPoint == ShadePointBuffer::NO_POINT)
 		{
-			alphaPoint = shadowCast(0, firstX, firstY);
+			alphaPoint = shadowCast(chunk, 0, firstX, firstY);
 		}
 	}
 
-	void CircleLightSource::handleLastShadePoint(CircleShadePoint * alphaPoint, bool radAtZero, float prevX, float prevY, float firstX, float firstY)
+	void CircleLightSource::handleLastShadePoint(CircleSweepChunk& chunk, uint32_t alphaPoint, bool radAtZero, float prevX, float prevY, float firstX, float firstY)
 	{
-		if (alphaPoint->getConnectPoint()->rads != 0 && radAtZero)
+		if (shadePoints.radixVal[shadePoints.connect[alphaPoint]] != 0 && radAtZero)
 		{
 			float cX = 0;
 			float cY = 0;
-			alphaPoint->checkIntersect(0, 0, radius * 2, 0, cX, cY);
-			addDrawPoints(prevX, prevY, cX, cY);
+			shadePoints.checkIntersect(alphaPoint, 0, 0, radius * 2, 0, cX, cY);
+			addDrawPoints(chunk, prevX, prevY, cX, cY);
 		}
-		else if (alphaPoint->getConnectPoint()->rads != 0)
+		else if (shadePoints.radixVal[shadePoints.connect[alphaPoint]] != 0)
 		{
-			addDrawPoints(prevX, prevY, firstX, firstY);
+			addDrawPoints(chunk, prevX, prevY, firstX, firstY);
 		}
 		else
 		{
-			addDrawPoints(prevX, prevY, alphaPoint->getConnectPoint()->x, alphaPoint->getConnectPoint()->y);
+			addDrawPoints(chunk, prevX, prevY, shadePoints.x[shadePoints.connect[alphaPoint]], shadePoints.y[shadePoints.connect[alphaPoint]]);
 		}
 	}
 
-	void CircleLightSource::updateCastPoints(CircleShadePoint * updatePoint)
+	void CircleLightSource::updateCastPoints(CircleSweepChunk& chunk, uint32_t updatePoint)
 	{
-		if (CrossesZero(updatePoint))
+		chunk.castRayX = shadePoints.x[updatePoint];
+		chunk.castRayY = shadePoints.y[updatePoint];
+		if (crossesZero(updatePoint))
 		{
-			if (updatePoint->rads <= updatePoint->getConnectPoint()->rads)
+			if (shadePoints.radixVal[updatePoint] <= shadePoints.radixVal[shadePoints.connect[updatePoint]])
 			{
-				castPoints.erase(updatePoint->getConnectPoint());
+				removeCastPoint(chunk, shadePoints.connect[updatePoint]);
 			}
 			else
 			{
-				castPoints.insert(updatePoint);
+				addCastPoint(chunk, updatePoint);
 			}
 		}
 		else
 		{
-			if (updatePoint->rads >= updatePoint->getConnectPoint()->rads)
+			if (shadePoints.radixVal[updatePoint] >= shadePoints.radixVal[shadePoints.connect[updatePoint]])
 			{
-				castPoints.erase(updatePoint->getConnectPoint());
+				removeCastPoint(chunk, shadePoints.connect[updatePoint]);
 			}
 			else
 			{
-				castPoints.insert(updatePoint);
+				addCastPoint(chunk, updatePoint);
+			}
+		}
+	}
+
+	void CircleLightSource::addCastPoint(CircleSweepChunk & chunk, uint32_t castPoint)
+	{
+		if (!chunk.castPointsOrdered)
+		{
+			chunk.unorderedCastPoints.insert(castPoint);
+			chunk.castPointUpdates++;
+			return;
+		}
+		auto it = chunk.castPoints.insert(castPoint).first;
+		//Lines that are about to swap order must be neighbors first, so checking each new pair of neighbors catches every crossing
+		auto nextIt = std::next(it);
+		if (nextIt != chunk.castPoints.end())
+		{
+			checkCastPointsCross(chunk, castPoint, *nextIt);
+		}
+		if (chunk.castPointsOrdered && it != chunk.castPoints.begin())
+		{
+			checkCastPointsCross(chunk, *std::prev(it), castPoint);
+		}
+	}
+
+	void CircleLightSource::removeCastPoint(CircleSweepChunk & chunk, uint32_t castPoint)
+	{
+		if (!chunk.castPointsOrdered)
+		{
+			chunk.unorderedCastPoints.erase(castPoint);
+			chunk.castPointUpdates++;
+			return;
+		}
+		//Lines pointing straight at the origin are never added
+		if (shadePoints.radixVal[castPoint] == shadePoints.radixVal[shadePoints.connect[castPoint]])
+		{
+			return;
+		}
+		//Lines are removed on the ray through their end, where the order is the one they were added with
+		auto it = chunk.castPoints.find(castPoint);
+		if (it == chunk.castPoints.end())
+		{
+			it = std::find(chunk.castPoints.begin(), chunk.castPoints.end(), castPoint);
+			if (it == chunk.castPoints.end())
+			{
+				return;
 			}
 		}
+		auto nextIt = chunk.castPoints.erase(it);
+		if (nextIt != chunk.castPoints.begin() && nextIt != chunk.castPoints.end())
+		{
+			checkCastPointsCross(chunk, *std::prev(nextIt), *nextIt);
+		}
 	}
 
-	CircleShadePoint * CircleLightSource::shadowCast(float rads, float & cX, float & cY, CircleShadePoint * exceptionPoint)
+	void CircleLightSource::orderCastPoints(CircleSweepChunk & chunk)
 	{
-		ShadowCalled++;
-		CastPointsProcessed += castPoints.size();
-		cX = cos(rads) * radius * 2;	//coordinates for endpoint to check for intersects on.  Other endpoint is at orign.
-		cY = sin(rads) * radius * 2;
-		ShadePoint* shadowPoint = nullptr;
-		for (auto it = castPoints.begin(); it != castPoints.end(); it++)
+		chunk.castPoints.insert(chunk.unorderedCastPoints.begin(), chunk.unorderedCastPoints.end());
+		chunk.unorderedCastPoints.clear();
+		chunk.castPointsOrdered = true;
+		for (auto it = chunk.castPoints.begin(); chunk.castPointsOrdered && std::next(it) != chunk.castPoints.end(); it++)
 		{
-			CircleShadePoint* updatePoint = *it;
-			//check if either of the lines of the endpoint have the same coordinates as the exceptionPoint
-			if (exceptionPoint == nullptr || !(updatePoint->x == exceptionPoint->x && updatePoint->y == exceptionPoint->y || 
-				updatePoint->getConnectPoint()->x == exceptionPoint->x && updatePoint->getConnectPoint()->y == exceptionPoint->y || 
-				updatePoint->x == exceptionPoint->getConnectPoint()->x && updatePoint->y == exceptionPoint->getConnectPoint()->y || 
-				updatePoint->getConnectPoint()->x == exceptionPoint->getConnectPoint()->x && updatePoint->getConnectPoint()->y == exceptionPoint->getConnectPoint()->y))
+			checkCastPointsCross(chunk, *it, *std::next(it));
+		}
+	}
+
+	void CircleLightSource::checkCastPointsCross(CircleSweepChunk & chunk, uint32_t castPoint1, uint32_t castPoint2)
+	{
+		if (CastPointOrder::Cross(shadePoints, castPoint1, castPoint2))
+		{
+			for (auto it = chunk.castPoints.begin(); it != chunk.castPoints.end(); it++)
 			{
-				//if an intersect occured cX and cY would be set to the intersect position, meaning that other points will now have be closer to the origin than cX and cY because the length of the line has decreased
-				if (updatePoint->checkIntersect(0, 0, cX, cY, cX, cY))
-				{
-					shadowPoint = updatePoint;
-				}
+				chunk.unorderedCastPoints.insert(*it);
+			}
+			chunk.castPoints.clear();
+			chunk.castPointsOrdered = false;
+			chunk.castPointsCrossed = true;
+		}
+	}
+
+	bool CircleLightSource::castToLine(uint32_t castPoint, uint32_t exceptionPoint, float & cX, float & cY) const
+	{
+		if (exceptionPoint == ShadePointBuffer::NO_POINT)
+		{
+			return shadePoints.checkIntersect(castPoint, 0, 0, cX, cY, cX, cY);
+		}
+		const std::vector <float>& x = shadePoints.x;
+		const std::vector <float>& y = shadePoints.y;
+		uint32_t castConnect = shadePoints.connect[castPoint];
+		uint32_t exceptionConnect = shadePoints.connect[exceptionPoint];
+		//check if either of the lines of the endpoint have the same coordinates as the exceptionPoint
+		if (!((x[castPoint] == x[exceptionPoint] && y[castPoint] == y[exceptionPoint]) || 
+			(x[castConnect] == x[exceptionPoint] && y[castConnect] == y[exceptionPoint]) || 
+			(x[castPoint] == x[exceptionConnect] && y[castPoint] == y[exceptionConnect]) || 
+			(x[castConnect] == x[exceptionConnect] && y[castConnect] == y[exceptionConnect])))
+		{
+			//if an intersect occured cX and cY would be set to the intersect position, meaning that other points will now have be closer to the origin than cX and cY because the length of the line has decreased
+			return shadePoints.checkIntersect(castPoint, 0, 0, cX, cY, cX, cY);
+		}
+		return false;
+	}
+
+	uint32_t CircleLightSource::shadowCast(CircleSweepChunk& chunk, float angle, float & cX, float & cY, uint32_t exceptionPoint)
+	{
+		chunk.shadowCasts++;
+		float dirX;
+		float dirY;
+		CircleShadePointBuffer::GetDirection(angle, dirX, dirY);
+		cX = dirX * radius * 2;	//coordinates for endpoint to check for intersects on.  Other endpoint is at orign.
+		cY = dirY * radius * 2;
+		uint32_t shadowPoint = ShadePointBuffer::NO_POINT;
+		if (!chunk.castPointsOrdered)
+		{
+			chunk.castPointsChecked += chunk.unorderedCastPoints.size();
+			chunk.castPointScans += chunk.unorderedCastPoints.size();
+			if (exceptionPoint == ShadePointBuffer::NO_POINT)
+			{
+				shadowPoint = chunk.unorderedCastPoints.castRay(0, 0, cX, cY, cX, cY);
+			}
+			else
+			{
+				shadowPoint = chunk.unorderedCastPoints.castRayExceptTouching(0, 0, cX, cY, exceptionPoint, cX, cY);
+			}
+			if (!chunk.castPointsCrossed && chunk.castPointScans > chunk.castPointUpdates * ORDER_CAST_POINTS_SCANS)
+			{
+				chunk.castRayX = dirX;
+				chunk.castRayY = dirY;
+				orderCastPoints(chunk);
+			}
+			return shadowPoint;	//SHOULD NEVER BE NO_POINT
+		}
+		//The lines are in order, so the first one hit is the closest
+		for (auto it = chunk.castPoints.begin(); it != chunk.castPoints.end(); it++)
+		{
+			chunk.castPointsChecked++;
+			if (castToLine(*it, exceptionPoint, cX, cY))
+			{
+				return *it;
 			}
 		}
-		return (CircleShadePoint*)shadowPoint;	//SHOULD NEVER BE NULLPTR
+		return shadowPoint;
 	}
 
-	bool CircleLightSource::getAlphaLineAtRad(CircleShadePoint *& alphaPoint, int & i, float & alphaContactX, float & alphaContactY)
+	bool CircleLightSource::getAlphaLineAtRad(CircleSweepChunk& chunk, uint32_t& alphaPoint, int & i, float & alphaContactX, float & alphaContactY)
 	{
-		float maxRads = -FLT_MAX;	//Keeps track of the highest radian, the higher the radian the further in front the line is.  
+		float maxAngleDif = -FLT_MAX;	//Keeps track of the highest angle, the higher the angle the further in front the line is.  
 		int maxI = -1;	//Set to the index of the closest and highly angled point
 		float minDis = FLT_MAX;	//Keeps track of the lowest distance, the lower the distance the further in front the line is.
-		float rads = shadePoints.at(i)->rads;	//The radian value the point from the origin
-		while (i < shadePoints.size() && shadePoints.at(i)->rads == rads)
+		unsigned int radixVal = shadePoints.radixVal[i];	//The angle of the point from the origin
+		float angle = shadePoints.getAngle(i);
+		while (i < shadePoints.size() && shadePoints.radixVal[i] == radixVal)
 		{
-			updateCastPoints(shadePoints.at(i));
-			float radDif = GetRadDif(shadePoints.at(i), shadePoints.at(i)->getConnectPoint(), rads);
-			bool zeroRadIntersected = CrossesZero(shadePoints.at(i));
-			if (rads == 0 && zeroRadIntersected)
+			updateCastPoints(chunk, i);
+			float angleDif = getAngleDif(i, shadePoints.connect[i], angle);
+			bool zeroRadIntersected = crossesZero(i);
+			if (radixVal == 0 && zeroRadIntersected)
 			{
 				zeroRadIntersected = false;
 			}
-			if (radDif > 0 && radDif < M_PI)
+			if (angleDif > 0 && angleDif < CircleShadePointBuffer::HALF_TURN)
 			{
-				if (!zeroRadIntersected && shadePoints.at(i)->getConnectPoint()->rads > rads || zeroRadIntersected && zeroRadIntersected && shadePoints.at(i)->getConnectPoint()->rads < rads)
+				if ((!zeroRadIntersected && shadePoints.radixVal[shadePoints.connect[i]] > radixVal) || (zeroRadIntersected && shadePoints.radixVal[shadePoints.connect[i]] < radixVal))
 				{
-					float dis = sqrt(pow(shadePoints.at(i)->x, 2) + pow(shadePoints.at(i)->y, 2));
+					float dis = sqrt(pow(shadePoints.x[i], 2) + pow(shadePoints.y[i], 2));
 					if (dis < minDis)
 					{
 						minDis = dis;
-						maxRads = FLT_MIN;
+						maxAngleDif = FLT_MIN;
 					}
-					if (dis == minDis && radDif > maxRads)
+					if (dis == minDis && angleDif > maxAngleDif)
 					{
 						maxI = i;
-						maxRads = radDif;
+						maxAngleDif = angleDif;
 					}
 				}
 			}
@@ -517,9 +862,9 @@ namespace lighting
 		}
 		if (maxI != -1)
 		{
-			alphaPoint = shadePoints.at(maxI);
-			alphaContactX = shadePoints.at(maxI)->x;
-			alphaContactY = shadePoints.at(maxI)->y;
+			alphaPoint = maxI;
+			alphaContactX = shadePoints.x[maxI];
+			alphaContactY = shadePoints.y[maxI];
 		}
 		i--;
 		return (maxI != -1);
@@ -0,0 +1,109 @@
+#include "CircleShadePointBuffer.h"
+#include <math.h>
+
+namespace lighting
+{
+	const float CircleShadePointBuffer::FULL_TURN = 4;
+
+	const float CircleShadePointBuffer::HALF_TURN = 2;
+
+	const int CircleShadePointBuffer::SMALL_RADIX_BITS;
+
+	const int CircleShadePointBuffer::MEDIUM_RADIX_BITS;
+
+	const int CircleShadePointBuffer::LARGE_RADIX_BITS;
+
+	CircleShadePointBuffer::CircleShadePointBuffer()
+	{
+		setRadixMaxBits(LARGE_RADIX_BITS);
+	}
+
+	void CircleShadePointBuffer::setRadixMaxBits(int maxBits)
+	{
+		int radixMaxBits;
+		if (maxBits <= SMALL_RADIX_BITS)
+		{
+			radixMaxBits = SMALL_RADIX_BITS;
+			sortPoints = &ShadePointBuffer::sortByRadixVal<SMALL_RADIX_BITS, SMALL_RADIX_BITS>;
+		}
+		else if (maxBits <= MEDIUM_RADIX_BITS)
+		{
+			radixMaxBits = MEDIUM_RADIX_BITS;
+			sortPoints = &ShadePointBuffer::sortByRadixVal<MEDIUM_RADIX_BITS, 8>;
+		}
+		else
+		{
+			radixMaxBits = LARGE_RADIX_BITS;
+			sortPoints = &ShadePointBuffer::sortByRadixVal<LARGE_RADIX_BITS, 8>;
+		}
+		radixMaxNum = ((unsigned int)1 << radixMaxBits) - 1;
+		radixScale = (double)radixMaxNum / FULL_TURN;
+	}
+
+	uint32_t CircleShadePointBuffer::addLine(float x1, float y1, float x2, float y2)
+	{
+		return ShadePointBuffer::addLine(x1, y1, getRadixVal(x1, y1), x2, y2, getRadixVal(x2, y2));
+	}
+
+	void CircleShadePointBuffer::sort()
+	{
+		(this->*sortPoints)();
+	}
+
+	float CircleShadePointBuffer::getAngle(uint32_t pointI) const
+	{
+		return (radixVal[pointI] * FULL_TURN) / (float)radixMaxNum;
+	}
+
+	double CircleShadePointBuffer::GetPseudoAngle(double x, double y)
+	{
+		//Each quadrant is one unit, walked by how far the point is along the side of the diamond.  Float positions add exactly as doubles unless
+		//their sizes are very far apart, so the only rounding is the divide, which keeps the points in the order of their real angle.
+		if (y >= 0)
+		{
+			if (x >= 0)
+			{
+				return (x + y > 0) ? y / (x + y) : 0;
+			}
+			return 1 - x / (y - x);
+		}
+		if (x < 0)
+		{
+			return 2 - y / (-x - y);
+		}
+		return 3 + x / (x - y);
+	}
+
+	void CircleShadePointBuffer::GetDirection(float angle, float & dirX, float & dirY)
+	{
+		int quadrant = (int)angle;
+		float along = angle - quadrant;
+		switch (quadrant & 3)
+		{
+		case 0:
+			dirX = 1 - along;
+			dirY = along;
+			break;
+		case 1:
+			dirX = -along;
+			dirY = 1 - along;
+			break;
+		case 2:
+			dirX = along - 1;
+			dirY = -along;
+			break;
+		default:
+			dirX = along;
+			dirY = along - 1;
+			break;
+		}
+		float length = sqrt(dirX * dirX + dirY * dirY);
+		dirX /= length;
+		dirY /= length;
+	}
+
+	unsigned int CircleShadePointBuffer::getRadixVal(float x, float y) const
+	{
+		return (unsigned int)(GetPseudoAngle(x, y) * radixScale);
+	}
+}
@@ -36,9 +36,14 @@ namespace lighting
 
 	void DirectionalLightSource::drawLocal()
 	{
+		if (!beginShadeMapRedraw())
+		{
+			return;
+		}
 		al_set_target_bitmap(shadeMap);
 		al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
 		al_clear_to_color(al_map_rgba(0, 0, 0, 255));
+		const std::vector <float>& drawPoints = frameSlots.at(drawSlot).drawPoints;
 		for (int i = 0; i < drawPoints.size() - 2; i += 4)
 		{
 			al_draw_filled_triangle(drawPoints.at(i), drawPoints.at(i + 1), drawPoints.at(i + 2), drawPoints.at(i + 3), radius * owner->getLightBmpScale(), radius * owner->getLightBmpScale(), lightColor);
@@ -55,11 +60,15 @@ namespace lighting
 
 	void DirectionalLightSource::drawToLightMap()
 	{
+		float x = frameSlots.at(drawSlot).x;
+		float y = frameSlots.at(drawSlot).y;
 		al_draw_rotated_bitmap(directionalLSourceMap, 0, (directionalLSourceH / 2), x * owner->getLightBmpScale(), y * owner->getLightBmpScale(), rads, NULL);
 	}
 
 	DirectionalLightSource::~DirectionalLightSource()
 	{
+		//Runs before ~CircleLightSource, so the frames still in flight must finish here, before its bitmaps go
+		removeFromOwner();
 		al_destroy_bitmap(directionalLSourceMapSave);
 		directionalLSourceMapSave = nullptr;
 		al_destroy_bitmap(directionalLSourceMap);
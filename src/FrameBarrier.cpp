@@ -0,0 +1,54 @@
+#include "FrameBarrier.h"
+
+namespace lighting
+{
+	FrameBarrier::FrameBarrier()
+		:lightSources(0), processedCount(0), processedFrames(0), lastFrameNanos(0)
+	{
+	}
+
+	void FrameBarrier::beginFrame(size_t lightSources)
+	{
+		std::lock_guard<std::mutex> lock(barrierMutex);
+		this->lightSources = lightSources;
+		processedCount = 0;
+		frameBeginTime = Clock::now();
+	}
+
+	bool FrameBarrier::arriveProcessed()
+	{
+		std::lock_guard<std::mutex> lock(barrierMutex);
+		if (++processedCount < lightSources)
+		{
+			return false;
+		}
+		lastFrameNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - frameBeginTime).count();
+		return true;
+	}
+
+	void FrameBarrier::endFrame()
+	{
+		std::lock_guard<std::mutex> lock(barrierMutex);
+		processedFrames++;
+		//Notified under the lock, a woken thread may destroy the barrier as soon as it is released
+		processedCondition.notify_all();
+	}
+
+	void FrameBarrier::waitProcessed(uint64_t frame)
+	{
+		std::unique_lock<std::mutex> lock(barrierMutex);
+		processedCondition.wait(lock, [&] { return processedFrames > frame; });
+	}
+
+	bool FrameBarrier::isProcessed(uint64_t frame)
+	{
+		std::lock_guard<std::mutex> lock(barrierMutex);
+		return processedFrames > frame;
+	}
+
+	uint64_t FrameBarrier::getLastFrameNanos()
+	{
+		std::lock_guard<std::mutex> lock(barrierMutex);
+		return lastFrameNanos;
+	}
+}
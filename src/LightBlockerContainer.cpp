@@ -12,48 +12,87 @@ namespace lighting
 
 	void LightBlockerContainer::setXY(float x, float y)
 	{
-		for (auto it = lightBlockers.begin(); it != lightBlockers.end(); it++)
-		{
-			(*it)->setGlobalXY(x, y);
-		}
+		owner->setLightBlockersXY(blockerHandles.data(), blockerHandles.size(), x, y);
 	}
 
 	void LightBlockerContainer::addLine(float x1, float y1, float x2, float y2)
 	{
-		LightBlocker* lightBlocker = new LightBlocker(x, y, x1, y1, x2, y2);
-		lightBlockers.push_back(lightBlocker);
-		owner->addLightBlocker(lightBlocker);
+		BlockerLine line;
+		line.x1 = x1;
+		line.y1 = y1;
+		line.x2 = x2;
+		line.y2 = y2;
+		addLines(&line, 1);
+	}
+
+	void LightBlockerContainer::addLines(const BlockerLine * lines, size_t numLines, bool oneSided)
+	{
+		size_t firstI = blockerHandles.size();
+		blockerHandles.resize(firstI + numLines);
+		owner->addLightBlockers(lines, numLines, blockerHandles.data() + firstI, x, y, oneSided);
 	}
 
 	void LightBlockerContainer::initSquare(float w, float h)
 	{
-		addLine(w, 0, 0, 0);
-		addLine(0, 0, 0, h);
-		addLine(0, h, w, h);
-		addLine(w, 0, w, h);
+		BlockerLine lines[4] = { { w, 0, 0, 0 }, { 0, 0, 0, h }, { 0, h, w, h }, { w, 0, w, h } };
+		addLines(lines, 4);
+	}
+
+	void LightBlockerContainer::initPolygon(const std::vector<float>& vertices)
+	{
+		size_t numVertices = vertices.size() / 2;
+		//Twice the signed area, positive when the inside is on the right of the edges with y pointing down
+		float area = 0;
+		for (size_t i = 0; i < numVertices; i++)
+		{
+			size_t nextI = (i + 1) % numVertices;
+			area += vertices.at(i * 2) * vertices.at(nextI * 2 + 1) - vertices.at(nextI * 2) * vertices.at(i * 2 + 1);
+		}
+		//Wound so the outside of the polygon is on the right of each edge
+		std::vector <float> corners;
+		corners.reserve(numVertices * 2);
+		for (size_t i = 0; i < numVertices; i++)
+		{
+			size_t vertexI = (area > 0) ? numVertices - 1 - i : i;
+			corners.push_back(vertices.at(vertexI * 2));
+			corners.push_back(vertices.at(vertexI * 2 + 1));
+		}
+		std::vector <BlockerLine> edges(numVertices);
+		for (size_t i = 0; i < numVertices; i++)
+		{
+			size_t nextI = (i + 1) % numVertices;
+			edges.at(i).x1 = corners.at(i * 2);
+			edges.at(i).y1 = corners.at(i * 2 + 1);
+			edges.at(i).x2 = corners.at(nextI * 2);
+			edges.at(i).y2 = corners.at(nextI * 2 + 1);
+		}
+		addLines(edges.data(), edges.size(), true);
 	}
 
 	void LightBlockerContainer::setCXYToCenter()
 	{
 		float avgX = 0;
 		float avgY = 0;
-		for (auto it = lightBlockers.begin(); it != lightBlockers.end(); it++)
+		for (auto it = blockerHandles.begin(); it != blockerHandles.end(); it++)
 		{
-			avgX += (*it)->epX1 + (*it)->epX2;
-			avgY += (*it)->epY1 + (*it)->epY2;
+			const BlockerOffsets& offsets = owner->lightBlockers.getOffsets(*it);
+			avgX += offsets.epX1 + offsets.epX2;
+			avgY += offsets.epY1 + offsets.epY2;
 		}
-		avgX /= (lightBlockers.size() * 2);
-		avgY /= (lightBlockers.size() * 2);
+		avgX /= (blockerHandles.size() * 2);
+		avgY /= (blockerHandles.size() * 2);
 		cX = avgX;
 		cY = avgY;
 	}
 
+	void LightBlockerContainer::setLightBlockerRads()
+	{
+		owner->setLightBlockersRads(blockerHandles.data(), blockerHandles.size(), cX, cY, rads);
+	}
+
 	LightBlockerContainer::~LightBlockerContainer()
 	{
-		for (auto it = lightBlockers.begin(); it != lightBlockers.end(); it++)
-		{
-			owner->removeLightBlocker(*it);
-		}
-		lightBlockers.clear();
+		owner->removeLightBlockers(blockerHandles.data(), blockerHandles.size());
+		blockerHandles.clear();
 	}
 }
@@ -0,0 +1,82 @@
+#include "LightCommandQueue.h"
+
+namespace lighting
+{
+	LightCommandQueue::LightCommandQueue()
+		:head(&stub), tail(&stub)
+	{
+		stub.next.store(nullptr, std::memory_order_relaxed);
+	}
+
+	void LightCommandQueue::push(std::function<void()> command)
+	{
+		LightCommandNode* node = new LightCommandNode();
+		node->command = std::move(command);
+		pushNode(node);
+	}
+
+	size_t LightCommandQueue::applyAll()
+	{
+		size_t applied = 0;
+		std::function<void()> command;
+		while (pop(command))
+		{
+			command();
+			applied++;
+		}
+		return applied;
+	}
+
+	LightCommandQueue::~LightCommandQueue()
+	{
+		std::function<void()> command;
+		while (pop(command))
+		{
+		}
+	}
+
+	bool LightCommandQueue::pop(std::function<void()>& command)
+	{
+		LightCommandNode* node = tail;
+		LightCommandNode* next = node->next.load(std::memory_order_acquire);
+		if (node == &stub)
+		{
+			if (next == nullptr)
+			{
+				return false;
+			}
+			tail = next;
+			node = next;
+			next = next->next.load(std::memory_order_acquire);
+		}
+		if (next != nullptr)
+		{
+			tail = next;
+			command = std::move(node->command);
+			delete node;
+			return true;
+		}
+		//node is the last one linked, a producer may be between its exchange and linking
+		if (node != head.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		pushNode(&stub);
+		next = node->next.load(std::memory_order_acquire);
+		if (next != nullptr)
+		{
+			tail = next;
+			command = std::move(node->command);
+			delete node;
+			return true;
+		}
+		return false;
+	}
+
+	void LightCommandQueue::pushNode(LightCommandNode * node)
+	{
+		node->next.store(nullptr, std::memory_order_relaxed);
+		LightCommandNode* prev = head.exchange(node, std::memory_order_acq_rel);
+		prev->next.store(node, std::memory_order_release);
+	}
+}
@@ -1,22 +1,25 @@
 #include "LightLayer.h"
-#include <iostream>
 #include <allegro5/allegro.h>
-#include "LightRunnable.h"
+#include "LightThreadPool.h"
 #include "LightSource.h"
 #include "GaussianBlurrer.h"
+#include <algorithm>
+#include <math.h>
 
 namespace lighting
 {
 	LightLayer::LightLayer(int drawToBmpW, int drawToBmpH, double lightBmpScale, size_t maxThreads)
-		:drawToWidth(drawToBmpW), drawToHeight(drawToBmpH), lightBmpScale(lightBmpScale), threadsProcessing(false)
+		:drawToWidth(drawToBmpW), drawToHeight(drawToBmpH), lightBmpScale(lightBmpScale), frames(1), pipelineDepth(0), detachedFrames(0), frameProcessing(false), processingFrame(0), frameBudgetNanos(NO_FRAME_BUDGET), blockerGridCellSize(BlockerGrid::DEFAULT_CELL_SIZE), simplifyBlockers(false), nextFrameLightSource(0), processingDeferredLights(0), lastFrameDeferredLights(0), processingSkippedLights(0), lastFrameSkippedLights(0)
 	{
 		if (maxThreads != MAX_THREAD_TO_CORES)
 		{
-			this->maxThreads = maxThreads;
+			executor = new LightThreadPool(maxThreads);
+			ownsExecutor = true;
 		}
 		else
 		{
-			setMaxThreadsToNumCores();
+			executor = LightThreadPool::GetShared();
+			ownsExecutor = false;
 		}
 		al_set_new_bitmap_flags(LIGHT_MAP_FLAGS);
 		lightMap = al_create_bitmap((int)(drawToBmpW * lightBmpScale), (int)(drawToBmpH * lightBmpScale));
@@ -25,74 +28,84 @@ namespace lighting
 		LightSource::InitLSourceMap();
 	}
 
+	LightLayer::LightLayer(int drawToBmpW, int drawToBmpH, double lightBmpScale, LightExecutor& executor)
+		:drawToWidth(drawToBmpW), drawToHeight(drawToBmpH), lightBmpScale(lightBmpScale), frames(1), pipelineDepth(0), detachedFrames(0), frameProcessing(false), processingFrame(0), frameBudgetNanos(NO_FRAME_BUDGET), blockerGridCellSize(BlockerGrid::DEFAULT_CELL_SIZE), simplifyBlockers(false), nextFrameLightSource(0), processingDeferredLights(0), lastFrameDeferredLights(0), processingSkippedLights(0), lastFrameSkippedLights(0), executor(&executor), ownsExecutor(false)
+	{
+		al_set_new_bitmap_flags(LIGHT_MAP_FLAGS);
+		lightMap = al_create_bitmap((int)(drawToBmpW * lightBmpScale), (int)(drawToBmpH * lightBmpScale));
+		al_set_new_bitmap_flags(LIGHT_MAP_FLAGS);
+		blurMap = al_create_bitmap((int)(drawToBmpW * lightBmpScale), (int)(drawToBmpH * lightBmpScale));
+		LightSource::InitLSourceMap();
+	}
+
 	void LightLayer::detach()
 	{
-		transferHeldVars();
-		for (auto it = lightRunnables.begin(); it != lightRunnables.end(); it++)
+		detachFrame(nullptr, nullptr);
+	}
+
+	std::shared_future<void> LightLayer::detachAsync(std::function<void()> onShadowsProcessed)
+	{
+		std::unique_ptr<std::promise<void>> processedPromise(new std::promise<void>());
+		std::shared_future<void> processedFuture = processedPromise->get_future().share();
+		detachFrame(std::move(processedPromise), std::move(onShadowsProcessed));
+		return processedFuture;
+	}
+
+	void LightLayer::detachFrame(std::unique_ptr<std::promise<void>> processedPromise, std::function<void()> processedCallback)
+	{
+		commandQueue.applyAll();
+		uint64_t frame = detachedFrames++;
+		//The slot of the frame is reused every frames.size() frames, so the frame that last used it must be finished
+		if (frame >= frames.size())
 		{
-			(*it)->shadowsProcessed = false;
-			(*it)->lightBlockersCopied = false;
-			(*it)->shadowsProcessedMutex.unlock();
+			waitProcessed(frame - frames.size());
 		}
-		std::list <LightRunnable*> copyLightRunnables;
-		while (copyLightRunnables.size() > 0)
+		transferHeldVars(frame);
+		LayerFrame& layerFrame = frames.at(getFrameSlot(frame));
+		layerFrame.processedPromise = std::move(processedPromise);
+		layerFrame.processedCallback = std::move(processedCallback);
 		{
-			for (auto it = copyLightRunnables.begin(); it != copyLightRunnables.end();)
+			std::lock_guard<std::mutex> lock(queueMutex);
+			if (frameProcessing)
 			{
-				bool erased = false;
-				LightRunnable* lightRunnable = (*it);
-				if (lightRunnable->lightBlockersCopiedMutex.try_lock())
-				{
-					if (lightRunnable->lightBlockersCopied)
-					{
-						erased = true;
-						it = copyLightRunnables.erase(it);
-					}
-					lightRunnable->lightBlockersCopiedMutex.unlock();
-		 		}
-				if (!erased)
-				{
-	 				it++;
-				}
+				queuedFrames.push_back(frame);
+				return;
 			}
+			frameProcessing = true;
 		}
+		startFrame(frame);
 	}
 
 	void LightLayer::draw()
 	{
 		ALLEGRO_BITMAP* prevBitmap = al_get_target_bitmap();
-		std::list <LightRunnable*> unfinishedLRs = lightRunnables;
-		while (unfinishedLRs.size() > 0)
+		if (detachedFrames > pipelineDepth)
 		{
-			for (auto it = unfinishedLRs.begin(); it != unfinishedLRs.end();)
+			uint64_t drawFrame = detachedFrames - 1 - pipelineDepth;
+			size_t drawSlot = getFrameSlot(drawFrame);
+			waitProcessed(drawFrame);
+			for (auto it = lightSources.begin(); it != lightSources.end(); it++)
 			{
-				bool erased = false;;
-				LightRunnable* lr = (*it);
-				if (lr->shadowsProcessedMutex.try_lock())
+				LightSource* lightSource = *it;
+				//Lights added after drawFrame was detached have no results for it
+				if (lightSource->slotFrames.size() == frames.size() && lightSource->slotFrames.at(drawSlot) == drawFrame)
 				{
-					if (lr->shadowsProcessed)
-					{
-						erased = true;
-						lr->drawLocal();
-						it = unfinishedLRs.erase(it);
-					}
-					else
-					{
-						lr->shadowsProcessedMutex.unlock();
-					}
+					lightSource->drawSlot = drawSlot;
+					lightSource->drawLocal();
 				}
-				if (!erased)
+			}
+			al_set_target_bitmap(lightMap);
+			al_set_separate_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ONE, ALLEGRO_ADD, ALLEGRO_ALPHA, ALLEGRO_INVERSE_ALPHA);
+			for (auto it = lightSources.begin(); it != lightSources.end(); it++)
+			{
+				LightSource* lightSource = *it;
+				if (lightSource->slotFrames.size() == frames.size() && lightSource->slotFrames.at(drawSlot) == drawFrame)
 				{
-					it++;
+					lightSource->drawToLightMap();
 				}
 			}
 		}
 		al_set_target_bitmap(lightMap);
-		al_set_separate_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ONE, ALLEGRO_ADD, ALLEGRO_ALPHA, ALLEGRO_INVERSE_ALPHA);
-		for (auto it = lightRunnables.begin(); it != lightRunnables.end(); it++)
-		{
-			(*it)->drawToLightMap();
-		}
 		al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
 		for (auto it = blurrers.begin(); it != blurrers.end(); it++)
 		{
@@ -111,121 +124,356 @@ namespace lighting
 		al_set_target_bitmap(prevBitmap);
 	}
 
-	void LightLayer::addLightSource(LightSource * lightSource)
+	void LightLayer::setPipelineDepth(size_t pipelineDepth)
 	{
-		if (threadsProcessing)
+		if (pipelineDepth == this->pipelineDepth)
 		{
-			heldAddLightSources.push(lightSource);
+			return;
 		}
-		else
+		waitDetachedProcessed();
+		this->pipelineDepth = pipelineDepth;
+		frames.clear();
+		frames.resize(pipelineDepth + 1);
+	}
+
+	void LightLayer::startFrame(uint64_t frame)
+	{
+		size_t slot = getFrameSlot(frame);
+		LayerFrame& layerFrame = frames.at(slot);
+		processingFrame = frame;
+		processingStartTime = std::chrono::steady_clock::now();
+		nextFrameLightSource = 0;
+		processingDeferredLights = 0;
+		processingSkippedLights = 0;
+		//The submitted tasks can finish the frame before the loop ends, after which the slot may be reused, so its size is read once
+		size_t numLightSources = layerFrame.lightSources.size();
+		frameBarrier.beginFrame(numLightSources);
+		if (numLightSources == 0)
+		{
+			if (frameBarrier.arriveProcessed())
+			{
+				finishFrame();
+			}
+			return;
+		}
+		//Tasks take the lights in priority order when they start, whichever order the executor runs them in
+		for (size_t i = 0; i < numLightSources; i++)
 		{
-			addLightSourceUnsafe(lightSource);
+			executor->submit([this, slot]
+			{
+				processNextLightSource(slot);
+			});
 		}
 	}
 
-	void LightLayer::removeLightSource(LightSource * lightSource)
+	void LightLayer::processNextLightSource(size_t slot)
 	{
-		if (threadsProcessing)
+		LayerFrame& layerFrame = frames.at(slot);
+		const FrameLightSource& frameLightSource = layerFrame.lightSources.at(nextFrameLightSource++);
+		LightSource* lightSource = frameLightSource.lightSource;
+		lightSource->computeSlot = slot;
+		//Nothing the shadows depend on changed, so the last ones are exact
+		if (lightSource->resultFrame != LightSource::NO_FRAME && lightSource->hasUnchangedInputs())
 		{
-			heldRemoveLightSources.push(lightSource);
+			lightSource->reuseResults(getFrameSlot(lightSource->resultFrame));
+			lightSource->resultFrame = processingFrame;
+			processingSkippedLights++;
+			if (frameBarrier.arriveProcessed())
+			{
+				finishFrame();
+			}
+			return;
 		}
-		else
+		if (layerFrame.frameBudgetNanos != NO_FRAME_BUDGET && lightSource->resultFrame != LightSource::NO_FRAME &&
+			(uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - processingStartTime).count() > layerFrame.frameBudgetNanos)
+		{
+			lightSource->reuseResults(getFrameSlot(lightSource->resultFrame));
+			lightSource->resultFrame = processingFrame;
+			processingDeferredLights++;
+			if (frameBarrier.arriveProcessed())
+			{
+				finishFrame();
+			}
+			return;
+		}
+		lightSource->resultFrame = processingFrame;
+		lightSource->createShadePoints();
+		mapLightSource(lightSource, frameLightSource.maxSweepChunks);
+	}
+
+	void LightLayer::finishFrame()
+	{
+		//The slot can't be reused before frameBarrier.endFrame(), so it is safe to read until then
+		LayerFrame& layerFrame = frames.at(getFrameSlot(processingFrame));
+		lastFrameDeferredLights = processingDeferredLights.load();
+		lastFrameSkippedLights = processingSkippedLights.load();
+		if (layerFrame.processedCallback)
+		{
+			layerFrame.processedCallback();
+			layerFrame.processedCallback = nullptr;
+		}
+		if (layerFrame.processedPromise)
+		{
+			layerFrame.processedPromise->set_value();
+			layerFrame.processedPromise.reset();
+		}
+		bool startNext = false;
+		uint64_t nextFrame = 0;
+		{
+			//Ended under the lock that clears frameProcessing, or detach could start the next frame and have it end before this one
+			std::lock_guard<std::mutex> lock(queueMutex);
+			frameBarrier.endFrame();
+			if (queuedFrames.empty())
+			{
+				frameProcessing = false;
+			}
+			else
+			{
+				startNext = true;
+				nextFrame = queuedFrames.front();
+				queuedFrames.pop_front();
+			}
+		}
+		//Once queueMutex is released the layer may be destroyed, unless another frame was queued
+		if (startNext)
+		{
+			startFrame(nextFrame);
+		}
+	}
+
+	void LightLayer::waitProcessed(uint64_t frame)
+	{
+		while (!frameBarrier.isProcessed(frame) && executor->runPendingTask())
+		{
+		}
+		frameBarrier.waitProcessed(frame);
+	}
+
+	void LightLayer::waitDetachedProcessed()
+	{
+		if (detachedFrames > 0)
+		{
+			waitProcessed(detachedFrames - 1);
+			//The task that ended the frame may still hold queueMutex, it must let go before the layer can be destroyed
+			std::lock_guard<std::mutex> lock(queueMutex);
+		}
+	}
+
+	void LightLayer::mapLightSource(LightSource * lightSource, size_t maxSweepChunks)
+	{
+		size_t numChunks = 1;
+		if (maxSweepChunks > 1)
 		{
-			removeLightSourceUnsafe(lightSource);
+			numChunks = lightSource->createSweepChunks(maxSweepChunks);
+		}
+		if (numChunks <= 1)
+		{
+			lightSource->mapShadePoints();
+			if (frameBarrier.arriveProcessed())
+			{
+				finishFrame();
+			}
+			return;
+		}
+		lightSource->sweepChunksLeft = numChunks;
+		for (size_t chunkI = 1; chunkI < numChunks; chunkI++)
+		{
+			executor->submit([this, lightSource, chunkI]
+			{
+				mapSweepChunk(lightSource, chunkI);
+			});
 		}
+		mapSweepChunk(lightSource, 0);
 	}
 
-	void LightLayer::addLightBlocker(LightBlocker * lightBlocker)
+	void LightLayer::mapSweepChunk(LightSource * lightSource, size_t chunkI)
 	{
-		lightBlockers.push_back(lightBlocker);
-		lightBlockerTrackerMap.emplace(std::make_pair(lightBlocker, --lightBlockers.end()));
+		lightSource->mapSweepChunk(chunkI);
+		//The last chunk to finish stitches, so no task ever waits on another
+		if (--lightSource->sweepChunksLeft == 0)
+		{
+			lightSource->stitchSweepChunks();
+			if (frameBarrier.arriveProcessed())
+			{
+				finishFrame();
+			}
+		}
 	}
 
-	void LightLayer::removeLightBlocker(LightBlocker * lightBlocker)
+	void LightLayer::addLightSource(LightSource * lightSource)
 	{
-		auto trackMapIter = lightBlockerTrackerMap.find(lightBlocker);
-		lightBlockers.erase(trackMapIter->second);
-		lightBlockerTrackerMap.erase(trackMapIter);
+		lightSources.push_back(lightSource);
+		lightSourceTrackerMap.emplace(std::make_pair(lightSource, --lightSources.end()));
+	}
+
+	void LightLayer::removeLightSource(LightSource * lightSource)
+	{
+		waitDetachedProcessed();
+		auto trackIter = lightSourceTrackerMap.find(lightSource);
+		if (trackIter == lightSourceTrackerMap.end())
+		{
+			return;
+		}
+		lightSources.erase(trackIter->second);
+		lightSourceTrackerMap.erase(trackIter);
 	}
 
 	LightLayer::~LightLayer()
 	{
+		waitDetachedProcessed();
+		if (ownsExecutor)
+		{
+			delete executor;
+		}
+		executor = nullptr;
 		al_destroy_bitmap(lightMap);
 		al_destroy_bitmap(blurMap);
 	}
 
-	void LightLayer::addAboveLightBlocker(AboveLightBlocker * aboveLightBlocker)
+	void LightLayer::addLightBlockers(const BlockerLine * lines, size_t numLines, BlockerHandle * handles, float x, float y, bool oneSided)
 	{
-		aboveLightBlockers.emplace(aboveLightBlocker);
+		lightBlockers.add(lines, numLines, x, y, handles, oneSided);
 	}
 
-	void LightLayer::removeAboveLightBlocker(AboveLightBlocker * aboveLightBlocker)
+	void LightLayer::removeLightBlockers(const BlockerHandle * handles, size_t numHandles)
 	{
-		aboveLightBlockers.erase(aboveLightBlocker);
+		for (size_t i = 0; i < numHandles; i++)
+		{
+			lightBlockers.remove(handles[i]);
+		}
 	}
 
-	void LightLayer::transferHeldVars()
+	void LightLayer::setLightBlockersXY(const BlockerHandle * handles, size_t numHandles, float x, float y)
 	{
-		while (!heldAddLightSources.empty())
+		for (size_t i = 0; i < numHandles; i++)
 		{
-			addLightSourceUnsafe(heldAddLightSources.front());
-			heldAddLightSources.pop();
+			BlockerLine& line = lightBlockers.editLine(handles[i]);
+			const BlockerOffsets& offsets = lightBlockers.getOffsets(handles[i]);
+			line.x1 = x + offsets.epX1 + offsets.rotateXOff1;
+			line.y1 = y + offsets.epY1 + offsets.rotateYOff1;
+			line.x2 = x + offsets.epX2 + offsets.rotateXOff2;
+			line.y2 = y + offsets.epY2 + offsets.rotateYOff2;
 		}
-		while (!heldRemoveLightSources.empty())
-		{
-			removeLightSourceUnsafe(heldRemoveLightSources.front());
-			heldRemoveLightSources.pop();
-		}
-		for (auto it = lightRunnables.begin(); it != lightRunnables.end(); it++)
+	}
+
+	void LightLayer::setLightBlockersRads(const BlockerHandle * handles, size_t numHandles, float cX, float cY, float rads)
+	{
+		for (size_t i = 0; i < numHandles; i++)
 		{
-			(*it)->transferHeldVars();
+			const BlockerLine& line = lightBlockers.getLine(handles[i]);
+			BlockerOffsets& offsets = lightBlockers.getOffsets(handles[i]);
+			float x = line.x1 - offsets.epX1;
+			float y = line.y1 - offsets.epY1;
+			float angle1 = atan2(offsets.epY1 - cY, offsets.epX1 - cX);
+			float dis1 = sqrt((offsets.epY1 - cY)*(offsets.epY1 - cY) + (offsets.epX1 - cX)*(offsets.epX1 - cX));
+			offsets.rotateXOff1 = (cX + cos(angle1 + rads) * dis1) - offsets.epX1;
+			offsets.rotateYOff1 = (cY + sin(angle1 + rads) * dis1) - offsets.epY1;
+			float angle2 = atan2(offsets.epY2 - cY, offsets.epX2 - cX);
+			float dis2 = sqrt((offsets.epY2 - cY)*(offsets.epY2 - cY) + (offsets.epX2 - cX)*(offsets.epX2 - cX));
+			offsets.rotateXOff2 = cX + cos(angle2 + rads) * dis2 - offsets.epX2;
+			offsets.rotateYOff2 = cY + sin(angle2 + rads) * dis2 - offsets.epY2;
+			setLightBlockersXY(&handles[i], 1, x, y);
 		}
 	}
 
-	void LightLayer::addLightSourceUnsafe(LightSource * lightSource)
+	void LightLayer::setSimplifyBlockers(bool simplifyBlockers)
 	{
-		LightRunnable* lrAdd = nullptr;	//light runnable that lightSource was added to
-		std::list <LightSource*>::iterator lsAddIter; //iterator to the list the lightSource was added to
-		if (lightRunnables.size() < maxThreads)
+		if (simplifyBlockers == this->simplifyBlockers)
+		{
+			return;
+		}
+		this->simplifyBlockers = simplifyBlockers;
+		lightBlockers.setChangeLogging(simplifyBlockers);
+		if (simplifyBlockers)
 		{
-			LightRunnable* lightRunnable = new LightRunnable();
-			lrAdd = lightRunnable;
-			lsAddIter = lightRunnable->addLightSource(lightSource);
-			lightRunnables.push_back(lightRunnable);
+			blockerSimplifier.reset(lightBlockers);
 		}
 		else
 		{
-			LightRunnable* minTimeRunnable = lightRunnables.front();
-			int estimateSourceTime = 0;
-			for (auto it = lightRunnables.begin(); it != lightRunnables.end(); it++)
-			{
-				if ((*it)->getRunTime() < minTimeRunnable->getRunTime())
-				{
-					minTimeRunnable = *it;
-				}
-				estimateSourceTime += (*it)->getRunTime() / (*it)->getLightSourceSize();
-			}
-			lrAdd = minTimeRunnable;
-			lsAddIter = minTimeRunnable->addLightSource(lightSource);
-			minTimeRunnable->incrRunTime(estimateSourceTime);
+			blockerSimplifier.clear();
 		}
-		lightSourceTrackerMap.emplace(std::make_pair(lightSource, std::make_pair(lrAdd, lsAddIter)));
+		//Forces the next detached frame to build a snapshot from the other source
+		blockerSnapshot.reset();
+	}
+
+	void LightLayer::addAboveLightBlocker(AboveLightBlocker * aboveLightBlocker)
+	{
+		aboveLightBlockers.emplace(aboveLightBlocker);
 	}
 
-	void LightLayer::removeLightSourceUnsafe(LightSource * lightSource)
+	void LightLayer::removeAboveLightBlocker(AboveLightBlocker * aboveLightBlocker)
 	{
-		auto trackIter = lightSourceTrackerMap.find(lightSource);
-		trackIter->second.first->removeLightSource(trackIter->second.second);
-		lightSourceTrackerMap.erase(lightSource);
+		aboveLightBlockers.erase(aboveLightBlocker);
 	}
 
-	void LightLayer::setMaxThreadsToNumCores()
+	void LightLayer::transferHeldVars(uint64_t frame)
 	{
-		maxThreads = std::thread::hardware_concurrency();
-		if (maxThreads == 0)
+		size_t slot = getFrameSlot(frame);
+		LayerFrame& layerFrame = frames.at(slot);
+		layerFrame.lightSources.clear();
+		for (auto it = lightSources.begin(); it != lightSources.end(); it++)
+		{
+			LightSource* lightSource = *it;
+			//Only lights that are in no detached frame can have a mismatch, so resizing their slots is safe
+			if (lightSource->slotFrames.size() != frames.size())
+			{
+				lightSource->setPipelineSlots(frames.size());
+			}
+			lightSource->transferHeldVars(slot);
+			lightSource->slotFrames.at(slot) = frame;
+			FrameLightSource frameLightSource;
+			frameLightSource.lightSource = lightSource;
+			frameLightSource.maxSweepChunks = lightSource->maxSweepChunks;
+			if (frameLightSource.maxSweepChunks == LightSource::SWEEP_CHUNKS_TO_CONCURRENCY)
+			{
+				frameLightSource.maxSweepChunks = executor->getConcurrency();
+			}
+			layerFrame.lightSources.push_back(frameLightSource);
+		}
+		std::stable_sort(layerFrame.lightSources.begin(), layerFrame.lightSources.end(), [](const FrameLightSource& a, const FrameLightSource& b)
+		{
+			return a.lightSource->priority > b.lightSource->priority;
+		});
+		layerFrame.frameBudgetNanos = frameBudgetNanos;
+		if (!blockerSnapshot || blockerSnapshot->epoch != lightBlockers.getEpoch() || blockerSnapshot->gridCellSize != blockerGridCellSize)
+		{
+			std::shared_ptr <BlockerSnapshot> snapshot;
+			//The frame that last used this slot is processed, so if no other frame shares its snapshot the memory can be reused
+			if (layerFrame.blockers && layerFrame.blockers.use_count() == 1)
+			{
+				snapshot = std::const_pointer_cast<BlockerSnapshot>(layerFrame.blockers);
+			}
+			else
+			{
+				snapshot = std::make_shared<BlockerSnapshot>();
+			}
+			layerFrame.blockers.reset();
+			snapshot->epoch = lightBlockers.getEpoch();
+			snapshot->gridCellSize = blockerGridCellSize;
+			if (simplifyBlockers)
+			{
+				blockerSimplifier.update(lightBlockers);
+				blockerSimplifier.copyTo(snapshot->blockerLines, snapshot->blockerVersions, snapshot->blockerOneSided);
+			}
+			else
+			{
+				//The endpoints are dense, so this is one copy
+				snapshot->blockerLines.assign(lightBlockers.getLines().begin(), lightBlockers.getLines().end());
+				snapshot->blockerVersions.assign(lightBlockers.getVersions().begin(), lightBlockers.getVersions().end());
+				snapshot->blockerOneSided.assign(lightBlockers.getOneSided().begin(), lightBlockers.getOneSided().end());
+			}
+			snapshot->blockerGrid.build(snapshot->blockerLines, blockerGridCellSize);
+			blockerSnapshot = snapshot;
+		}
+		layerFrame.blockers = blockerSnapshot;
+		layerFrame.aboveBlockerLines.clear();
+		layerFrame.aboveBlockerLines.reserve(aboveLightBlockers.size());
+		for (auto it = aboveLightBlockers.begin(); it != aboveLightBlockers.end(); it++)
 		{
-			maxThreads = 4;
-			std::cerr << "Could not get the number of cores, assumed 4" << std::endl;
+			AboveBlockerLine aboveBlockerLine;
+			aboveBlockerLine.x1 = (*it)->x1;
+			aboveBlockerLine.x2 = (*it)->x2;
+			layerFrame.aboveBlockerLines.push_back(aboveBlockerLine);
 		}
 	}
 }
@@ -2,70 +2,66 @@
 
 namespace lighting
 {
-	LightRunnable::LightRunnable()
-		:runThread(&LightRunnable::run, this), lightBlockersCopied(false), shadowsProcessed(false), runTime(0)
+	LightRunnable::LightRunnable(LightThreadPool* pool, size_t index)
+		:pool(pool), index(index)
 	{
-		shadowsProcessedMutex.lock();
-		runThread.detach();
+	}
+
+	void LightRunnable::start()
+	{
+		runThread = std::thread(&LightRunnable::run, this);
 	}
 
 	void LightRunnable::run()
 	{
-		while (true)
+		PoolTask task;
+		while (pool->waitForTask(this, task))
 		{
-			lightBlockersCopiedMutex.lock();
-			shadowsProcessedMutex.lock();
-			auto startTime = std::chrono::high_resolution_clock::now();
-			transferLightBlockers();
-			lightBlockersCopiedMutex.unlock();
-			processShadows();
-			shadowsProcessedMutex.unlock();
-			auto endTime = std::chrono::high_resolution_clock::now();
-			runTime = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
-			while (true)
-			{
-				shadowsProcessedMutex.lock();
-				if (!shadowsProcessed)
-				{
-					shadowsProcessedMutex.unlock();
-					break;
-				}
-				shadowsProcessedMutex.unlock();
-			}
+			task.run();
+			task.run = nullptr;
 		}
 	}
 
-	std::list<LightSource*>::iterator LightRunnable::addLightSource(LightSource * lightSource)
+	void LightRunnable::join()
 	{
-		lightSources.push_front(lightSource);
-		return lightSources.begin();	//Iterators are safe to store
+		if (runThread.joinable())
+		{
+			runThread.join();
+		}
 	}
 
-	void LightRunnable::removeLightSource(std::list<LightSource*>::iterator removeIter)
+	void LightRunnable::pushTask(PoolTask && task)
 	{
-		lightSources.erase(removeIter);
+		std::lock_guard<std::mutex> lock(tasksMutex);
+		tasks.push_back(std::move(task));
 	}
 
 	LightRunnable::~LightRunnable()
 	{
-		
+		join();
 	}
 
-	void LightRunnable::transferLightBlockers()
+	bool LightRunnable::popTask(PoolTask & task)
 	{
-		for (auto it = lightSources.begin(); it != lightSources.end(); it++)
+		std::lock_guard<std::mutex> lock(tasksMutex);
+		if (tasks.empty())
 		{
-			(*it)->createShadePoints();
+			return false;
 		}
-		lightBlockersCopied = true;
+		task = std::move(tasks.back());
+		tasks.pop_back();
+		return true;
 	}
 
-	void LightRunnable::processShadows()
+	bool LightRunnable::stealFrontTask(PoolTask & task)
 	{
-		for (auto it = lightSources.begin(); it != lightSources.end(); it++)
+		std::lock_guard<std::mutex> lock(tasksMutex);
+		if (tasks.empty())
 		{
-			(*it)->mapShadePoints();
+			return false;
 		}
-		shadowsProcessed = true;
+		task = std::move(tasks.front());
+		tasks.pop_front();
+		return true;
 	}
-} 
\ No newline at end of file
+}
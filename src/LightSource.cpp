@@ -15,6 +15,8 @@ namespace lighting
 
 	int LightSource::LSource_Map_H = 0;
 
+	const uint64_t LightSource::NO_FRAME;
+
 	void LightSource::InitLSourceMap(const std::string& lightDir)
 	{
 		al_set_new_bitmap_flags(LSOURCE_MAP_FLAGS);
@@ -31,12 +33,17 @@ namespace lighting
 	}
 
 	LightSource::LightSource(LightLayer* lightLayerOwner)
-		:owner(lightLayerOwner)
+		:owner(lightLayerOwner), maxSweepChunks(1), sweepChunksLeft(0), computeSlot(0), drawSlot(0), resultFrame(NO_FRAME), priority(0)
 	{
 		owner->addLightSource(this);
 	}
 
 	LightSource::~LightSource()
+	{
+		removeFromOwner();
+	}
+
+	void LightSource::removeFromOwner()
 	{
 		owner->removeLightSource(this);
 	}
@@ -0,0 +1,138 @@
+#include "LightThreadPool.h"
+#include <iostream>
+#include <thread>
+#include "LightRunnable.h"
+
+namespace lighting
+{
+	std::atomic<uint64_t> LightThreadPool::TaskLatencyNanos(0);
+	std::atomic<uint64_t> LightThreadPool::TaskCount(0);
+	std::atomic<uint64_t> LightThreadPool::TasksStolen(0);
+	std::atomic<uint64_t> LightThreadPool::TasksRunByCaller(0);
+
+	/// <summary>
+	/// The worker running on the current thread, <c>nullptr</c> on threads outside of any pool.
+	/// </summary>
+	static thread_local LightRunnable* CurrentRunnable = nullptr;
+
+	LightThreadPool* LightThreadPool::GetShared()
+	{
+		static LightThreadPool* sharedPool = new LightThreadPool();
+		return sharedPool;
+	}
+
+	LightThreadPool::LightThreadPool(size_t numThreads)
+		:nextRunnable(0), pendingTasks(0), stopped(false)
+	{
+		if (numThreads == 0)
+		{
+			numThreads = std::thread::hardware_concurrency();
+			if (numThreads == 0)
+			{
+				numThreads = 4;
+				std::cerr << "Could not get the number of cores, assumed 4" << std::endl;
+			}
+		}
+		for (size_t i = 0; i < numThreads; i++)
+		{
+			runnables.push_back(new LightRunnable(this, i));
+		}
+		for (size_t i = 0; i < runnables.size(); i++)
+		{
+			runnables.at(i)->start();
+		}
+	}
+
+	void LightThreadPool::submit(std::function<void()> task)
+	{
+		PoolTask poolTask;
+		poolTask.run = std::move(task);
+		poolTask.submitTime = std::chrono::steady_clock::now();
+		{
+			//Counted before it is pushed so pendingTasks never drops below the number of tasks in the deques
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			pendingTasks++;
+		}
+		if (CurrentRunnable != nullptr && CurrentRunnable->pool == this)
+		{
+			CurrentRunnable->pushTask(std::move(poolTask));
+		}
+		else
+		{
+			runnables.at(nextRunnable++ % runnables.size())->pushTask(std::move(poolTask));
+		}
+		sleepCondition.notify_one();
+	}
+
+	bool LightThreadPool::runPendingTask()
+	{
+		PoolTask task;
+		for (size_t i = 0; i < runnables.size(); i++)
+		{
+			if (runnables.at(i)->stealFrontTask(task))
+			{
+				pendingTasks--;
+				TaskLatencyNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - task.submitTime).count();
+				TaskCount++;
+				TasksRunByCaller++;
+				task.run();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	LightThreadPool::~LightThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			stopped = true;
+		}
+		sleepCondition.notify_all();
+		//A runnable that hasn't seen stopped yet can still steal from the others, so none is deleted before all have returned
+		for (size_t i = 0; i < runnables.size(); i++)
+		{
+			runnables.at(i)->join();
+		}
+		for (size_t i = 0; i < runnables.size(); i++)
+		{
+			delete runnables.at(i);
+		}
+		runnables.clear();
+	}
+
+	bool LightThreadPool::waitForTask(LightRunnable * runnable, PoolTask & task)
+	{
+		CurrentRunnable = runnable;
+		while (true)
+		{
+			if (runnable->popTask(task) || stealTask(runnable, task))
+			{
+				pendingTasks--;
+				TaskLatencyNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - task.submitTime).count();
+				TaskCount++;
+				return true;
+			}
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			sleepCondition.wait(lock, [&] { return stopped || pendingTasks > 0; });
+			if (stopped)
+			{
+				return false;
+			}
+		}
+	}
+
+	bool LightThreadPool::stealTask(LightRunnable * thief, PoolTask & task)
+	{
+		for (size_t i = 1; i < runnables.size(); i++)
+		{
+			LightRunnable* victim = runnables.at((thief->index + i) % runnables.size());
+			if (victim->stealFrontTask(task))
+			{
+				TasksStolen++;
+				return true;
+			}
+		}
+		return false;
+	}
+}
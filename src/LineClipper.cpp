@@ -0,0 +1,319 @@
+#include "LineClipper.h"
+#include <float.h>
+#include <math.h>
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define LINE_CLIPPER_SSE
+#endif
+
+namespace lighting
+{
+	namespace
+	{
+		/// <summary>
+		/// The smaller value, the second one if neither is, like _mm_min_ps.
+		/// </summary>
+		inline float MinF(float a, float b)
+		{
+			return a < b ? a : b;
+		}
+
+		/// <summary>
+		/// The larger value, the second one if neither is, like _mm_max_ps.
+		/// </summary>
+		inline float MaxF(float a, float b)
+		{
+			return a > b ? a : b;
+		}
+
+		/// <summary>
+		/// Narrows the part of a line in the square to the part between the two sides across one axis.
+		/// </summary>
+		/// <param name="p">The position of the first endpoint on the axis.</param>
+		/// <param name="d">How far the second endpoint is from the first on the axis.</param>
+		/// <param name="bound">Half the width of the square.</param>
+		/// <param name="enter">How far along the line it enters the square.  Used as out parameter.</param>
+		/// <param name="exit">How far along the line it leaves the square.  Used as out parameter.</param>
+		inline void ClipAxis(float p, float d, float bound, float& enter, float& exit)
+		{
+			float axisEnter;
+			float axisExit;
+			if (d == 0)
+			{
+				//Parallel to the sides, so either always between them or never.  A line along a side is not in the square.
+				bool inside = p > -bound && p < bound;
+				axisEnter = inside ? -FLT_MAX : FLT_MAX;
+				axisExit = inside ? FLT_MAX : -FLT_MAX;
+			}
+			else
+			{
+				float tLow = (-bound - p) / d;
+				float tHigh = (bound - p) / d;
+				axisEnter = MinF(tLow, tHigh);
+				axisExit = MaxF(tLow, tHigh);
+			}
+			enter = MaxF(enter, axisEnter);
+			exit = MinF(exit, axisExit);
+		}
+
+#ifdef LINE_CLIPPER_SSE
+		/// <summary>
+		/// <see cref="ClipAxis"/> for four lines.
+		/// </summary>
+		inline void ClipAxis4(__m128 p, __m128 d, __m128 negBound, __m128 bound, __m128& enter, __m128& exit)
+		{
+			__m128 tLow = _mm_div_ps(_mm_sub_ps(negBound, p), d);
+			__m128 tHigh = _mm_div_ps(_mm_sub_ps(bound, p), d);
+			__m128 axisEnter = _mm_min_ps(tLow, tHigh);
+			__m128 axisExit = _mm_max_ps(tLow, tHigh);
+			__m128 parallel = _mm_cmpeq_ps(d, _mm_setzero_ps());
+			__m128 inside = _mm_and_ps(_mm_cmpgt_ps(p, negBound), _mm_cmplt_ps(p, bound));
+			__m128 maxFloat = _mm_set1_ps(FLT_MAX);
+			__m128 minFloat = _mm_set1_ps(-FLT_MAX);
+			__m128 parallelEnter = _mm_or_ps(_mm_and_ps(inside, minFloat), _mm_andnot_ps(inside, maxFloat));
+			__m128 parallelExit = _mm_or_ps(_mm_and_ps(inside, maxFloat), _mm_andnot_ps(inside, minFloat));
+			//The divides of parallel lines may be NaN, they are replaced before they are used
+			axisEnter = _mm_or_ps(_mm_and_ps(parallel, parallelEnter), _mm_andnot_ps(parallel, axisEnter));
+			axisExit = _mm_or_ps(_mm_and_ps(parallel, parallelExit), _mm_andnot_ps(parallel, axisExit));
+			enter = _mm_max_ps(enter, axisEnter);
+			exit = _mm_min_ps(exit, axisExit);
+		}
+
+		/// <summary>
+		/// Picks <paramref name="a"/> where <paramref name="mask"/> is set and <paramref name="b"/> elsewhere.
+		/// </summary>
+		inline __m128 Select4(__m128 mask, __m128 a, __m128 b)
+		{
+			return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+		}
+
+		/// <summary>
+		/// Writes the lanes of four clipped lines set in <paramref name="keepMask"/> from index <paramref name="keptLines"/> on, over lines that were already read.
+		/// </summary>
+		/// <returns>The number of lines kept, including <paramref name="keptLines"/>.</returns>
+		inline size_t StoreKept4(int keepMask, __m128 cX1, __m128 cY1, __m128 cX2, __m128 cY2, float* x1, float* y1, float* x2, float* y2, size_t keptLines)
+		{
+			if (keepMask == 0xF)
+			{
+				_mm_storeu_ps(x1 + keptLines, cX1);
+				_mm_storeu_ps(y1 + keptLines, cY1);
+				_mm_storeu_ps(x2 + keptLines, cX2);
+				_mm_storeu_ps(y2 + keptLines, cY2);
+				return keptLines + 4;
+			}
+			float outX1[4];
+			float outY1[4];
+			float outX2[4];
+			float outY2[4];
+			_mm_storeu_ps(outX1, cX1);
+			_mm_storeu_ps(outY1, cY1);
+			_mm_storeu_ps(outX2, cX2);
+			_mm_storeu_ps(outY2, cY2);
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if (keepMask & (1 << lane))
+				{
+					x1[keptLines] = outX1[lane];
+					y1[keptLines] = outY1[lane];
+					x2[keptLines] = outX2[lane];
+					y2[keptLines] = outY2[lane];
+					keptLines++;
+				}
+			}
+			return keptLines;
+		}
+#endif
+	}
+
+	bool LineClipper::ClipLine(float & x1, float & y1, float & x2, float & y2, float bound)
+	{
+		float dx = x2 - x1;
+		float dy = y2 - y1;
+		float enter = 0;
+		float exit = 1;
+		ClipAxis(x1, dx, bound, enter, exit);
+		ClipAxis(y1, dy, bound, enter, exit);
+		//A line only touching the square at one point has nothing in it to clip
+		if (!(enter < exit))
+		{
+			return false;
+		}
+		float cX1 = enter > 0 ? x1 + enter * dx : x1;
+		float cY1 = enter > 0 ? y1 + enter * dy : y1;
+		float cX2 = exit < 1 ? x1 + exit * dx : x2;
+		float cY2 = exit < 1 ? y1 + exit * dy : y2;
+		//Rounding can leave a moved endpoint just outside
+		x1 = MinF(MaxF(cX1, -bound), bound);
+		y1 = MinF(MaxF(cY1, -bound), bound);
+		x2 = MinF(MaxF(cX2, -bound), bound);
+		y2 = MinF(MaxF(cY2, -bound), bound);
+		return true;
+	}
+
+	size_t LineClipper::ClipLines(float * x1, float * y1, float * x2, float * y2, size_t numLines, float bound)
+	{
+#ifdef LINE_CLIPPER_SSE
+		size_t keptLines = 0;
+		size_t i = 0;
+		__m128 posBound = _mm_set1_ps(bound);
+		__m128 negBound = _mm_set1_ps(-bound);
+		__m128 zero = _mm_setzero_ps();
+		__m128 one = _mm_set1_ps(1);
+		for (; i + 4 <= numLines; i += 4)
+		{
+			__m128 px1 = _mm_loadu_ps(x1 + i);
+			__m128 py1 = _mm_loadu_ps(y1 + i);
+			__m128 px2 = _mm_loadu_ps(x2 + i);
+			__m128 py2 = _mm_loadu_ps(y2 + i);
+			__m128 dx = _mm_sub_ps(px2, px1);
+			__m128 dy = _mm_sub_ps(py2, py1);
+			__m128 enter = zero;
+			__m128 exit = one;
+			ClipAxis4(px1, dx, negBound, posBound, enter, exit);
+			ClipAxis4(py1, dy, negBound, posBound, enter, exit);
+			int keepMask = _mm_movemask_ps(_mm_cmplt_ps(enter, exit));
+			if (keepMask == 0)
+			{
+				continue;
+			}
+			__m128 moveFirst = _mm_cmpgt_ps(enter, zero);
+			__m128 moveSecond = _mm_cmplt_ps(exit, one);
+			__m128 cX1 = _mm_min_ps(_mm_max_ps(Select4(moveFirst, _mm_add_ps(px1, _mm_mul_ps(enter, dx)), px1), negBound), posBound);
+			__m128 cY1 = _mm_min_ps(_mm_max_ps(Select4(moveFirst, _mm_add_ps(py1, _mm_mul_ps(enter, dy)), py1), negBound), posBound);
+			__m128 cX2 = _mm_min_ps(_mm_max_ps(Select4(moveSecond, _mm_add_ps(px1, _mm_mul_ps(exit, dx)), px2), negBound), posBound);
+			__m128 cY2 = _mm_min_ps(_mm_max_ps(Select4(moveSecond, _mm_add_ps(py1, _mm_mul_ps(exit, dy)), py2), negBound), posBound);
+			//The kept lines are written back over the ones already read, so the arrays are compacted in place
+			keptLines = StoreKept4(keepMask, cX1, cY1, cX2, cY2, x1, y1, x2, y2, keptLines);
+		}
+		return ClipRange(x1, y1, x2, y2, i, numLines, keptLines, bound);
+#else
+		return ClipLinesScalar(x1, y1, x2, y2, numLines, bound);
+#endif
+	}
+
+	bool LineClipper::ClipLineToCircle(float & x1, float & y1, float & x2, float & y2, float radius)
+	{
+		float dx = x2 - x1;
+		float dy = y2 - y1;
+		//The line crosses the circle where |(x1, y1) + t * (dx, dy)| = radius, a quadratic in t
+		float a = dx * dx + dy * dy;
+		float b = x1 * dx + y1 * dy;
+		float c = x1 * x1 + y1 * y1 - radius * radius;
+		float disc = b * b - a * c;
+		//A line missing the circle or only touching it has nothing in it to clip
+		if (!(disc > 0))
+		{
+			return false;
+		}
+		float root = sqrtf(disc);
+		float enter = MaxF(0, (-b - root) / a);
+		float exit = MinF(1, (-b + root) / a);
+		if (!(enter < exit))
+		{
+			return false;
+		}
+		float cX1 = enter > 0 ? x1 + enter * dx : x1;
+		float cY1 = enter > 0 ? y1 + enter * dy : y1;
+		float cX2 = exit < 1 ? x1 + exit * dx : x2;
+		float cY2 = exit < 1 ? y1 + exit * dy : y2;
+		x1 = cX1;
+		y1 = cY1;
+		x2 = cX2;
+		y2 = cY2;
+		return true;
+	}
+
+	size_t LineClipper::ClipLinesToCircle(float * x1, float * y1, float * x2, float * y2, size_t numLines, float radius)
+	{
+#ifdef LINE_CLIPPER_SSE
+		size_t keptLines = 0;
+		size_t i = 0;
+		__m128 radiusSq = _mm_set1_ps(radius * radius);
+		__m128 zero = _mm_setzero_ps();
+		__m128 one = _mm_set1_ps(1);
+		for (; i + 4 <= numLines; i += 4)
+		{
+			__m128 px1 = _mm_loadu_ps(x1 + i);
+			__m128 py1 = _mm_loadu_ps(y1 + i);
+			__m128 px2 = _mm_loadu_ps(x2 + i);
+			__m128 py2 = _mm_loadu_ps(y2 + i);
+			__m128 dx = _mm_sub_ps(px2, px1);
+			__m128 dy = _mm_sub_ps(py2, py1);
+			__m128 a = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+			__m128 b = _mm_add_ps(_mm_mul_ps(px1, dx), _mm_mul_ps(py1, dy));
+			__m128 c = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(px1, px1), _mm_mul_ps(py1, py1)), radiusSq);
+			__m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, c));
+			//The roots of lines missing the circle are NaN, they are masked out by the check of disc
+			__m128 root = _mm_sqrt_ps(disc);
+			__m128 negB = _mm_sub_ps(zero, b);
+			__m128 enter = _mm_max_ps(zero, _mm_div_ps(_mm_sub_ps(negB, root), a));
+			__m128 exit = _mm_min_ps(one, _mm_div_ps(_mm_add_ps(negB, root), a));
+			int keepMask = _mm_movemask_ps(_mm_and_ps(_mm_cmpgt_ps(disc, zero), _mm_cmplt_ps(enter, exit)));
+			if (keepMask == 0)
+			{
+				continue;
+			}
+			__m128 moveFirst = _mm_cmpgt_ps(enter, zero);
+			__m128 moveSecond = _mm_cmplt_ps(exit, one);
+			__m128 cX1 = Select4(moveFirst, _mm_add_ps(px1, _mm_mul_ps(enter, dx)), px1);
+			__m128 cY1 = Select4(moveFirst, _mm_add_ps(py1, _mm_mul_ps(enter, dy)), py1);
+			__m128 cX2 = Select4(moveSecond, _mm_add_ps(px1, _mm_mul_ps(exit, dx)), px2);
+			__m128 cY2 = Select4(moveSecond, _mm_add_ps(py1, _mm_mul_ps(exit, dy)), py2);
+			keptLines = StoreKept4(keepMask, cX1, cY1, cX2, cY2, x1, y1, x2, y2, keptLines);
+		}
+		return ClipRangeToCircle(x1, y1, x2, y2, i, numLines, keptLines, radius);
+#else
+		return ClipLinesToCircleScalar(x1, y1, x2, y2, numLines, radius);
+#endif
+	}
+
+	size_t LineClipper::ClipLinesToCircleScalar(float * x1, float * y1, float * x2, float * y2, size_t numLines, float radius)
+	{
+		return ClipRangeToCircle(x1, y1, x2, y2, 0, numLines, 0, radius);
+	}
+
+	size_t LineClipper::ClipLinesScalar(float * x1, float * y1, float * x2, float * y2, size_t numLines, float bound)
+	{
+		return ClipRange(x1, y1, x2, y2, 0, numLines, 0, bound);
+	}
+
+	size_t LineClipper::ClipRange(float * x1, float * y1, float * x2, float * y2, size_t beginI, size_t endI, size_t keptLines, float bound)
+	{
+		for (size_t i = beginI; i < endI; i++)
+		{
+			float cX1 = x1[i];
+			float cY1 = y1[i];
+			float cX2 = x2[i];
+			float cY2 = y2[i];
+			if (ClipLine(cX1, cY1, cX2, cY2, bound))
+			{
+				x1[keptLines] = cX1;
+				y1[keptLines] = cY1;
+				x2[keptLines] = cX2;
+				y2[keptLines] = cY2;
+				keptLines++;
+			}
+		}
+		return keptLines;
+	}
+
+	size_t LineClipper::ClipRangeToCircle(float * x1, float * y1, float * x2, float * y2, size_t beginI, size_t endI, size_t keptLines, float radius)
+	{
+		for (size_t i = beginI; i < endI; i++)
+		{
+			float cX1 = x1[i];
+			float cY1 = y1[i];
+			float cX2 = x2[i];
+			float cY2 = y2[i];
+			if (ClipLineToCircle(cX1, cY1, cX2, cY2, radius))
+			{
+				x1[keptLines] = cX1;
+				y1[keptLines] = cY1;
+				x2[keptLines] = cX2;
+				y2[keptLines] = cY2;
+				keptLines++;
+			}
+		}
+		return keptLines;
+	}
+}
@@ -0,0 +1,163 @@
+#include "RadixSorter.h"
+
+namespace lighting
+{
+	namespace
+	{
+		/// <summary>
+		/// Runs the counting pass of digit <typeparamref name="DIGIT"/> and then the passes after it, up to the last digit that moves anything.
+		/// Each pass is its own instantiation, so the passes are unrolled and their shifts and masks are constants.
+		/// </summary>
+		/// <typeparam name="BASE_BITS">The number of bits sorted by each counting pass.</typeparam>
+		/// <typeparam name="DIGIT">The digit this pass sorts by, from the least significant.</typeparam>
+		/// <typeparam name="NUM_DIGITS">The number of digits of the keys.</typeparam>
+		template <int BASE_BITS, int DIGIT, int NUM_DIGITS>
+		struct RadixPasses
+		{
+			/// <summary>
+			/// Sorts by digit <typeparamref name="DIGIT"/> unless every key has the same value for it, then by the digits after it.
+			/// </summary>
+			/// <param name="firstKey">The first key, whose digit is compared to the histograms to find passes that wouldn't move anything.</param>
+			/// <param name="counts">The histogram of every digit one after the other.</param>
+			/// <param name="pairs">Each key in the high 32 bits and its index in the low 32 bits, in the order of the passes so far.</param>
+			/// <param name="pairsScratch">The destination of a pass, swapped with <paramref name="pairs"/> after it.</param>
+			/// <param name="order">Where the last pass writes the sorted indices.</param>
+			/// <param name="lastDigit">The last digit whose pass moves anything.</param>
+			static void Sort(unsigned int firstKey, unsigned int* counts, std::vector <uint64_t>& pairs, std::vector <uint64_t>& pairsScratch, std::vector <uint32_t>& order, int lastDigit)
+			{
+				const size_t DIGIT_NUM = (size_t)1 << BASE_BITS;
+				const unsigned int DIGIT_MASK = (unsigned int)DIGIT_NUM - 1;
+				const int SHIFT = 32 + DIGIT * BASE_BITS;
+				if (DIGIT > lastDigit)
+				{
+					return;
+				}
+				size_t numKeys = pairs.size();
+				unsigned int* digitCounts = counts + DIGIT * DIGIT_NUM;
+				if (digitCounts[(firstKey >> (DIGIT * BASE_BITS)) & DIGIT_MASK] != numKeys)
+				{
+					unsigned int offset = 0;
+					for (size_t i = 0; i < DIGIT_NUM; i++)
+					{
+						unsigned int count = digitCounts[i];
+						digitCounts[i] = offset;
+						offset += count;
+					}
+					const uint64_t* src = pairs.data();
+					if (DIGIT == lastDigit)
+					{
+						//The last pass only needs to place the indices
+						uint32_t* dst = order.data();
+						for (size_t i = 0; i < numKeys; i++)
+						{
+							uint64_t pair = src[i];
+							dst[digitCounts[(pair >> SHIFT) & DIGIT_MASK]++] = (uint32_t)pair;
+						}
+						return;
+					}
+					uint64_t* dst = pairsScratch.data();
+					for (size_t i = 0; i < numKeys; i++)
+					{
+						uint64_t pair = src[i];
+						dst[digitCounts[(pair >> SHIFT) & DIGIT_MASK]++] = pair;
+					}
+					pairs.swap(pairsScratch);
+				}
+				RadixPasses<BASE_BITS, DIGIT + 1, NUM_DIGITS>::Sort(firstKey, counts, pairs, pairsScratch, order, lastDigit);
+			}
+		};
+
+		/// <summary>
+		/// Ends the passes after the most significant digit.
+		/// </summary>
+		template <int BASE_BITS, int NUM_DIGITS>
+		struct RadixPasses <BASE_BITS, NUM_DIGITS, NUM_DIGITS>
+		{
+			static void Sort(unsigned int, unsigned int*, std::vector <uint64_t>&, std::vector <uint64_t>&, std::vector <uint32_t>&, int)
+			{
+			}
+		};
+	}
+
+	const size_t RadixSorter::INSERTION_SORT_MAX;
+
+	template <int MAX_BITS, int BASE_BITS>
+	const std::vector<uint32_t>& RadixSorter::sort(const std::vector<unsigned int>& keys)
+	{
+		static_assert(MAX_BITS > 0 && MAX_BITS <= 32, "Keys are packed into the high 32 bits of each pair");
+		static_assert(BASE_BITS > 0 && BASE_BITS <= 16, "The histogram of a digit must stay small");
+		const int NUM_DIGITS = (MAX_BITS + BASE_BITS - 1) / BASE_BITS;
+		const size_t DIGIT_NUM = (size_t)1 << BASE_BITS;
+		const unsigned int DIGIT_MASK = (unsigned int)DIGIT_NUM - 1;
+		size_t numKeys = keys.size();
+		pairs.resize(numKeys);
+		order.resize(numKeys);
+		if (numKeys <= INSERTION_SORT_MAX)
+		{
+			for (size_t i = 0; i < numKeys; i++)
+			{
+				pairs[i] = ((uint64_t)keys[i] << 32) | (uint32_t)i;
+			}
+			insertionSort();
+			for (size_t i = 0; i < numKeys; i++)
+			{
+				order[i] = (uint32_t)pairs[i];
+			}
+			return order;
+		}
+		counts.assign(NUM_DIGITS * DIGIT_NUM, 0);
+		const unsigned int* keysData = keys.data();
+		unsigned int* countsData = counts.data();
+		uint64_t* pairsData = pairs.data();
+		//Every histogram is counted before the first pass moves anything
+		for (size_t i = 0; i < numKeys; i++)
+		{
+			unsigned int key = keysData[i];
+			pairsData[i] = ((uint64_t)key << 32) | (uint32_t)i;
+			for (int dI = 0; dI < NUM_DIGITS; dI++)
+			{
+				countsData[dI * DIGIT_NUM + ((key >> (dI * BASE_BITS)) & DIGIT_MASK)]++;
+			}
+		}
+		//A digit that every key has the same value for wouldn't move anything
+		int lastDigit = -1;
+		for (int dI = 0; dI < NUM_DIGITS; dI++)
+		{
+			if (countsData[dI * DIGIT_NUM + ((keysData[0] >> (dI * BASE_BITS)) & DIGIT_MASK)] != numKeys)
+			{
+				lastDigit = dI;
+			}
+		}
+		if (lastDigit < 0)
+		{
+			for (size_t i = 0; i < numKeys; i++)
+			{
+				order[i] = (uint32_t)i;
+			}
+			return order;
+		}
+		pairsScratch.resize(numKeys);
+		RadixPasses<BASE_BITS, 0, NUM_DIGITS>::Sort(keysData[0], countsData, pairs, pairsScratch, order, lastDigit);
+		return order;
+	}
+
+	template const std::vector<uint32_t>& RadixSorter::sort<12, 12>(const std::vector<unsigned int>& keys);
+
+	template const std::vector<uint32_t>& RadixSorter::sort<16, 8>(const std::vector<unsigned int>& keys);
+
+	template const std::vector<uint32_t>& RadixSorter::sort<24, 8>(const std::vector<unsigned int>& keys);
+
+	void RadixSorter::insertionSort()
+	{
+		for (size_t i = 1; i < pairs.size(); i++)
+		{
+			uint64_t pair = pairs[i];
+			size_t j = i;
+			for (; j > 0 && pairs[j - 1] > pair; j--)
+			{
+				pairs[j] = pairs[j - 1];
+			}
+			pairs[j] = pair;
+		}
+	}
+}
@@ -0,0 +1,93 @@
+#include "ShadePointBuffer.h"
+#include "CastSegmentSet.h"
+
+namespace lighting
+{
+	const uint32_t ShadePointBuffer::NO_POINT;
+
+	bool GetIntersectPoint(float p0_x, float p0_y, float p1_x, float p1_y, float p2_x, float p2_y, float p3_x, float p3_y, float * i_x, float * i_y)
+	{
+		float s1_x, s1_y, s2_x, s2_y;
+		s1_x = p1_x - p0_x;     s1_y = p1_y - p0_y;
+		s2_x = p3_x - p2_x;     s2_y = p3_y - p2_y;
+
+		float s, t;
+		s = (-s1_y * (p0_x - p2_x) + s1_x * (p0_y - p2_y)) / (-s2_x * s1_y + s1_x * s2_y);
+		t = (s2_x * (p0_y - p2_y) - s2_y * (p0_x - p2_x)) / (-s2_x * s1_y + s1_x * s2_y);
+
+		if (s >= 0 && s <= 1 && t >= 0 && t <= 1)
+		{
+			if (i_x != NULL)
+				*i_x = p0_x + (t * s1_x);
+			if (i_y != NULL)
+				*i_y = p0_y + (t * s1_y);
+			return true;
+		}
+
+		return false;
+	}
+
+	void ShadePointBuffer::clear()
+	{
+		x.clear();
+		y.clear();
+		radixVal.clear();
+		connect.clear();
+	}
+
+	void ShadePointBuffer::reserve(size_t numPoints)
+	{
+		x.reserve(numPoints);
+		y.reserve(numPoints);
+		radixVal.reserve(numPoints);
+		connect.reserve(numPoints);
+	}
+
+	uint32_t ShadePointBuffer::addLine(float x1, float y1, unsigned int radixVal1, float x2, float y2, unsigned int radixVal2)
+	{
+		uint32_t pointI = (uint32_t)x.size();
+		x.push_back(x1);
+		y.push_back(y1);
+		radixVal.push_back(radixVal1);
+		connect.push_back(pointI + 1);
+		x.push_back(x2);
+		y.push_back(y2);
+		radixVal.push_back(radixVal2);
+		connect.push_back(pointI);
+		return pointI;
+	}
+
+	bool ShadePointBuffer::checkIntersect(uint32_t pointI, float x1, float y1, float x2, float y2, float & cX, float & cY) const
+	{
+		uint32_t connectI = connect[pointI];
+		return GetIntersectPoint(x1, y1, x2, y2, x[pointI], y[pointI], x[connectI], y[connectI], &cX, &cY);
+	}
+
+	bool ShadePointBuffer::checkCross(uint32_t pointI, float x1, float y1, float x2, float y2) const
+	{
+		uint32_t connectI = connect[pointI];
+		float along;
+		float alongDen;
+		return CastSegmentSet::CrossRay(x1, y1, x2 - x1, y2 - y1, x[pointI], y[pointI], x[connectI] - x[pointI], y[connectI] - y[pointI], along, alongDen);
+	}
+
+	void ShadePointBuffer::reorder(const std::vector <uint32_t>& sortedPoints)
+	{
+		size_t numPoints = size();
+		gather(sortedPoints, x, floatScratch);
+		gather(sortedPoints, y, floatScratch);
+		gather(sortedPoints, radixVal, radixValScratch);
+		//pointsScratch becomes the new index of each old index
+		pointsScratch.resize(numPoints);
+		for (size_t i = 0; i < numPoints; i++)
+		{
+			pointsScratch[sortedPoints[i]] = (uint32_t)i;
+		}
+		connectScratch.resize(numPoints);
+		for (size_t i = 0; i < numPoints; i++)
+		{
+			connectScratch[i] = pointsScratch[connect[sortedPoints[i]]];
+		}
+		connect.swap(connectScratch);
+	}
+}
@@ -0,0 +1,143 @@
+#include "TileBlockerMap.h"
+#include "LightLayer.h"
+
+namespace lighting
+{
+	TileBlockerMap::TileBlockerMap(LightLayer * owner, size_t columns, size_t rows, float tileSize, float x, float y)
+		:owner(owner), columns(columns), rows(rows), tileSize(tileSize), x(x), y(y), tiles(columns * rows, 0), boundaryHandles(rows + 1 + columns + 1),
+		dirtyBoundaries(rows + 1 + columns + 1, 0), numDirtyBoundaries(0), numLightBlockers(0)
+	{
+	}
+
+	void TileBlockerMap::setSolid(size_t column, size_t row, bool solid)
+	{
+		uint8_t& tile = tiles.at(row * columns + column);
+		if ((tile != 0) != solid)
+		{
+			tile = solid;
+			markTileDirty(column, row);
+		}
+	}
+
+	void TileBlockerMap::setTiles(const std::vector<uint8_t>& tiles)
+	{
+		for (size_t row = 0; row < rows; row++)
+		{
+			for (size_t column = 0; column < columns; column++)
+			{
+				setSolid(column, row, tiles.at(row * columns + column) != 0);
+			}
+		}
+	}
+
+	void TileBlockerMap::update()
+	{
+		if (numDirtyBoundaries == 0)
+		{
+			return;
+		}
+		//Every dirty boundary is emptied and refilled with a single add to the owner
+		std::vector<BlockerLine> lines;
+		std::vector<size_t> boundaryLineEnds;
+		std::vector<size_t> updatedBoundaries;
+		updatedBoundaries.reserve(numDirtyBoundaries);
+		for (size_t boundaryI = 0; boundaryI < boundaryHandles.size(); boundaryI++)
+		{
+			if (!dirtyBoundaries[boundaryI])
+			{
+				continue;
+			}
+			dirtyBoundaries[boundaryI] = 0;
+			std::vector<BlockerHandle>& handles = boundaryHandles[boundaryI];
+			owner->removeLightBlockers(handles.data(), handles.size());
+			numLightBlockers -= handles.size();
+			handles.clear();
+			appendBoundaryEdges(boundaryI, lines);
+			updatedBoundaries.push_back(boundaryI);
+			boundaryLineEnds.push_back(lines.size());
+		}
+		numDirtyBoundaries = 0;
+		std::vector<BlockerHandle> handles(lines.size());
+		owner->addLightBlockers(lines.data(), lines.size(), handles.data(), x, y, true);
+		size_t lineI = 0;
+		for (size_t i = 0; i < updatedBoundaries.size(); i++)
+		{
+			boundaryHandles[updatedBoundaries[i]].assign(handles.begin() + lineI, handles.begin() + boundaryLineEnds[i]);
+			lineI = boundaryLineEnds[i];
+		}
+		numLightBlockers += lines.size();
+	}
+
+	void TileBlockerMap::markTileDirty(size_t column, size_t row)
+	{
+		size_t boundaries[4] = { row, row + 1, rows + 1 + column, rows + 1 + column + 1 };
+		for (size_t i = 0; i < 4; i++)
+		{
+			if (!dirtyBoundaries[boundaries[i]])
+			{
+				dirtyBoundaries[boundaries[i]] = 1;
+				numDirtyBoundaries++;
+			}
+		}
+	}
+
+	void TileBlockerMap::appendBoundaryEdges(size_t boundaryI, std::vector<BlockerLine>& lines) const
+	{
+		bool rowBoundary = boundaryI <= rows;
+		long long boundary = rowBoundary ? boundaryI : boundaryI - (rows + 1);
+		size_t length = rowBoundary ? columns : rows;
+		EdgeSide runSide = NO_EDGE;
+		size_t runBegin = 0;
+		//One past the end closes the last run
+		for (size_t i = 0; i <= length; i++)
+		{
+			EdgeSide side = NO_EDGE;
+			if (i < length)
+			{
+				bool before = rowBoundary ? isSolidOrOutside(i, boundary - 1) : isSolidOrOutside(boundary - 1, i);
+				bool after = rowBoundary ? isSolidOrOutside(i, boundary) : isSolidOrOutside(boundary, i);
+				if (before != after)
+				{
+					side = before ? SOLID_BEFORE : SOLID_AFTER;
+				}
+			}
+			if (side == runSide)
+			{
+				continue;
+			}
+			if (runSide != NO_EDGE)
+			{
+				//Lines block light from their right looking from the first endpoint to the second, so they run with the solid tiles on their left
+				float begin = runBegin * tileSize;
+				float end = i * tileSize;
+				float across = boundary * tileSize;
+				BlockerLine line;
+				if (rowBoundary)
+				{
+					line.y1 = across;
+					line.y2 = across;
+					line.x1 = (runSide == SOLID_BEFORE) ? begin : end;
+					line.x2 = (runSide == SOLID_BEFORE) ? end : begin;
+				}
+				else
+				{
+					line.x1 = across;
+					line.x2 = across;
+					line.y1 = (runSide == SOLID_BEFORE) ? end : begin;
+					line.y2 = (runSide == SOLID_BEFORE) ? begin : end;
+				}
+				lines.push_back(line);
+			}
+			runSide = side;
+			runBegin = i;
+		}
+	}
+
+	TileBlockerMap::~TileBlockerMap()
+	{
+		for (auto it = boundaryHandles.begin(); it != boundaryHandles.end(); it++)
+		{
+			owner->removeLightBlockers(it->data(), it->size());
+		}
+	}
+}
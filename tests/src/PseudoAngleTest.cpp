@@ -0,0 +1,208 @@
+#include "CircleShadePointBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace lighting;
+
+namespace
+{
+	const double PI = 3.14159265358979323846;
+
+	/// <summary>
+	/// A position and its real angle around the origin, from 0 up to 2 pi.
+	/// </summary>
+	struct TestPoint
+	{
+		float x;
+		float y;
+		double angle;
+	};
+
+	void AddPoint(std::vector <TestPoint>& points, float x, float y)
+	{
+		//atan2 gives the origin an angle of 0, but it has no direction to sort by
+		if (x == 0 && y == 0)
+		{
+			return;
+		}
+		double angle = atan2((double)y, (double)x);
+		if (angle < 0)
+		{
+			angle += 2 * PI;
+		}
+		TestPoint point = { x, y, angle };
+		points.push_back(point);
+	}
+
+	std::vector <TestPoint> CreateRandomPoints()
+	{
+		std::vector <TestPoint> points;
+		std::mt19937 random(7);
+		std::uniform_real_distribution <float> distribution(-500, 500);
+		for (int i = 0; i < 1000000; i++)
+		{
+			float x = distribution(random);
+			float y = distribution(random);
+			AddPoint(points, x, y);
+		}
+		return points;
+	}
+
+	std::vector <TestPoint> CreateGridPoints()
+	{
+		std::vector <TestPoint> points;
+		for (int x = -60; x <= 60; x++)
+		{
+			for (int y = -60; y <= 60; y++)
+			{
+				AddPoint(points, (float)x, (float)y);
+			}
+		}
+		return points;
+	}
+
+	std::vector <TestPoint> CreateAxisPoints()
+	{
+		std::vector <TestPoint> points;
+		std::mt19937 random(11);
+		std::uniform_real_distribution <float> distribution(-500, 500);
+		for (int i = 0; i < 1000; i++)
+		{
+			float a = distribution(random);
+			AddPoint(points, a, 0);
+			AddPoint(points, 0, a);
+			//Just off the axes, where a quadrant ends and the next starts
+			AddPoint(points, a, 1e-30f * a);
+			AddPoint(points, a, -1e-30f * a);
+			AddPoint(points, 1e-30f * a, a);
+			AddPoint(points, -1e-30f * a, a);
+		}
+		return points;
+	}
+
+	std::vector <TestPoint> CreateDiagonalPoints()
+	{
+		std::vector <TestPoint> points;
+		std::mt19937 random(13);
+		std::uniform_real_distribution <float> distribution(-500, 500);
+		for (int i = 0; i < 1000; i++)
+		{
+			float a = distribution(random);
+			AddPoint(points, a, a);
+			AddPoint(points, a, -a);
+			//Just off the diagonals, in the middle of a quadrant
+			AddPoint(points, a, std::nextafter(a, 0.0f));
+			AddPoint(points, std::nextafter(a, 0.0f), a);
+			AddPoint(points, a, -std::nextafter(a, 0.0f));
+			AddPoint(points, std::nextafter(a, 0.0f), -a);
+		}
+		return points;
+	}
+
+	/// <summary>
+	/// Checks that <see cref="CircleShadePointBuffer::GetPseudoAngle"/> never orders two points differently than their real angles do.
+	/// </summary>
+	/// <returns>The number of inversions found.</returns>
+	size_t CheckPseudoAngles(std::vector <TestPoint> points)
+	{
+		std::sort(points.begin(), points.end(), [](const TestPoint& a, const TestPoint& b)
+		{
+			return a.angle < b.angle;
+		});
+		size_t inversions = 0;
+		double previousPseudoAngle = 0;
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			double pseudoAngle = CircleShadePointBuffer::GetPseudoAngle(points[i].x, points[i].y);
+			if (pseudoAngle < 0 || pseudoAngle > CircleShadePointBuffer::FULL_TURN)
+			{
+				std::cout << "  pseudo angle " << pseudoAngle << " of (" << points[i].x << ", " << points[i].y << ") is out of range" << std::endl;
+				inversions++;
+			}
+			//Points with the same real angle may have pseudo angles in either order
+			if (i > 0 && pseudoAngle < previousPseudoAngle && points[i].angle > points[i - 1].angle)
+			{
+				if (inversions < 5)
+				{
+					std::cout << "  pseudo angle inversion at (" << points[i - 1].x << ", " << points[i - 1].y << ") and (" << points[i].x << ", " << points[i].y << ")" << std::endl;
+				}
+				inversions++;
+			}
+			previousPseudoAngle = pseudoAngle;
+		}
+		return inversions;
+	}
+
+	/// <summary>
+	/// Sorts the points with a <see cref="CircleShadePointBuffer"/> whose keys have <paramref name="radixBits"/> bits, and checks that no key is
+	/// in front of a key for a smaller real angle.
+	/// </summary>
+	/// <returns>The number of inversions found.</returns>
+	size_t CheckKeyOrder(const std::vector <TestPoint>& points, int radixBits)
+	{
+		CircleShadePointBuffer shadePoints;
+		shadePoints.setRadixMaxBits(radixBits);
+		for (size_t i = 0; i + 1 < points.size(); i += 2)
+		{
+			shadePoints.addLine(points[i].x, points[i].y, points[i + 1].x, points[i + 1].y);
+		}
+		shadePoints.sort();
+		size_t inversions = 0;
+		//The largest real angle of the keys before the current one, and of the points with the current key
+		double previousKeysMaxAngle = 0;
+		double keyMaxAngle = 0;
+		for (size_t i = 0; i < shadePoints.size(); i++)
+		{
+			if (i > 0 && shadePoints.radixVal[i] < shadePoints.radixVal[i - 1])
+			{
+				std::cout << "  keys not sorted at " << i << std::endl;
+				return inversions + 1;
+			}
+			if (i > 0 && shadePoints.radixVal[i] != shadePoints.radixVal[i - 1])
+			{
+				previousKeysMaxAngle = keyMaxAngle;
+			}
+			double angle = atan2((double)shadePoints.y[i], (double)shadePoints.x[i]);
+			if (angle < 0)
+			{
+				angle += 2 * PI;
+			}
+			if (angle < previousKeysMaxAngle)
+			{
+				if (inversions < 5)
+				{
+					std::cout << "  key inversion at (" << shadePoints.x[i] << ", " << shadePoints.y[i] << ") with key " << shadePoints.radixVal[i] << std::endl;
+				}
+				inversions++;
+			}
+			keyMaxAngle = std::max(keyMaxAngle, angle);
+		}
+		return inversions;
+	}
+
+	bool RunCase(const std::string& name, const std::vector <TestPoint>& points)
+	{
+		size_t inversions = CheckPseudoAngles(points);
+		int radixBits[] = { CircleShadePointBuffer::SMALL_RADIX_BITS, CircleShadePointBuffer::MEDIUM_RADIX_BITS, CircleShadePointBuffer::LARGE_RADIX_BITS };
+		for (int i = 0; i < 3; i++)
+		{
+			inversions += CheckKeyOrder(points, radixBits[i]);
+		}
+		std::cout << name << ": " << points.size() << " points, " << inversions << " inversions" << std::endl;
+		return inversions == 0;
+	}
+}
+
+int main()
+{
+	bool passed = RunCase("random", CreateRandomPoints());
+	passed = RunCase("grid", CreateGridPoints()) && passed;
+	passed = RunCase("axis", CreateAxisPoints()) && passed;
+	passed = RunCase("diagonal", CreateDiagonalPoints()) && passed;
+	std::cout << (passed ? "Passed" : "Failed") << std::endl;
+	return passed ? 0 : 1;
+}